@@ -1,25 +1,49 @@
 #include "app.h"
+#include "app_events.h"
+#include "joystick_input.h"
+#include "auto_repeat.h"
+#include "profiler.h"
+#include "trace.h"
+#include "latency.h"
+#include "diagnostics.h"
+#include "memory_monitor.h"
+#include "benchmark.h"
 #include "em_chip.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
 #include "tetris.h"
 #include "main_menu.h"
 
 #include "game_state.h"
 
+#include "sl_component_catalog.h"
 #include "sl_simple_button_instances.h"
 #include "sl_board_control.h"
 #include "sl_assert.h"
 #include "dmd.h"
 #include "sl_joystick.h"
-#include "sl_sleeptimer.h"
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+#include "sl_power_manager.h"
+#endif
+
+// Presses queued by the button interrupt for the main loop
+#define BUTTON_BTN0_PRESSED (1u << 0)
+#define BUTTON_BTN1_PRESSED (1u << 1)
 
-// Debounce/rate limit for joystick to prevent overly fast inputs
-static uint32_t last_joystick_poll_time = 0;
-#define JOYSTICK_POLL_DELAY_MS 150
+static volatile uint8_t pending_buttons = 0;
+static volatile uint32_t button_press_tick[2]; // source timestamps for the latency measurement
+static game_state_t drawn_state;
 
-static sl_joystick_t sl_joystick_handle = JOYSTICK_HANDLE_DEFAULT;
+// --- Local function prototypes ---
+static bool handle_joystick(void);
+static bool dispatch_joystick(sl_joystick_position_t pos, bool is_repeat);
+static bool handle_buttons(void);
+static void handle_button_press(const sl_button_t *handle);
+static void draw_current_screen(game_state_t current_state);
 
 void app_init(void)
 {
+  memory_monitor_paint_stack();
   CHIP_Init();
   uint32_t status;
 
@@ -31,93 +55,274 @@ void app_init(void)
   status = DMD_init(0);
   EFM_ASSERT(status == DMD_OK);
 
-  // Initialize the Joystick driver
-  sl_joystick_init(&sl_joystick_handle);
-  sl_joystick_start(&sl_joystick_handle);
+  // Initialize the event loop and the timer-sampled joystick
+  trace_init();
+  latency_init();
+  app_events_init();
+  diagnostics_init();
+  joystick_input_init();
 
   // Initialize game modules
   tetris_init();
+  auto_repeat_init();
   main_menu_init();
   slot_menu_init();
+  profiler_init();
+
+  // Warns on SWO (and the main menu) when stack or RAM headroom runs short
+  memory_monitor_check();
+
+#if TETRIS_BENCH
+  // Benchmark builds measure the engine and render kernels once before the menu
+  benchmark_run();
+#endif
+
+  drawn_state = tetris_get_game_state();
+  app_events_post(APP_EVENT_REDRAW);
 }
 
-// This is called on every iteration of the main while loop
+// Called on every iteration of the main while loop, i.e. once per wakeup.
+// Everything here is triggered by an event; with nothing pending the core
+// goes back to EM2 from main().
 void app_process_action(void)
 {
+  uint32_t events = app_events_take();
+  diagnostics_on_loop();
+  bool redraw = (events & (APP_EVENT_REDRAW | APP_EVENT_STORAGE)) != 0;
+
+  if (events & APP_EVENT_GRAVITY) {
+    tetris_update();
+  }
+  if (events & (APP_EVENT_GRAVITY | APP_EVENT_AUTO_REPEAT)) {
+    auto_repeat_process_action();
+  }
+  if (events & APP_EVENT_BUTTON) {
+    redraw |= handle_buttons();
+  }
+  if (events & APP_EVENT_JOYSTICK) {
+    redraw |= handle_joystick();
+  }
+
+  // Flash jobs run after input so work queued by the handlers above is not
+  // left waiting for the next wakeup
   tetris_process_action();
+
   game_state_t current_state = tetris_get_game_state();
+  if (current_state != drawn_state) {
+    // Play goes deeper into the stack than boot does: check headroom again on
+    // the way back to the menu, so the menu and SWO warn about what a game used
+    if (current_state == GAME_STATE_MAIN_MENU
+        && (drawn_state == GAME_STATE_IN_GAME || drawn_state == GAME_STATE_PAUSED
+            || drawn_state == GAME_STATE_GAME_OVER)) {
+      memory_monitor_check();
+    }
+    drawn_state = current_state;
+    redraw = true;
+  } else if (current_state == GAME_STATE_IN_GAME || current_state == GAME_STATE_GAME_OVER) {
+    // The game draws itself on every move; only redraw for display-only changes
+    redraw = (events & APP_EVENT_REDRAW) != 0;
+  }
+  if (redraw) {
+    draw_current_screen(current_state);
+  }
+  latency_end_pass();
+  if (events & APP_EVENT_DIAGNOSTICS) {
+    profiler_report();
+  }
+}
 
-  // --- Handle Input ---
-  sl_joystick_position_t pos = JOYSTICK_NONE;
-  if (sl_sleeptimer_get_tick_count() - last_joystick_poll_time > sl_sleeptimer_ms_to_tick(JOYSTICK_POLL_DELAY_MS)) {
-    last_joystick_poll_time = sl_sleeptimer_get_tick_count();
-    sl_joystick_get_position(&sl_joystick_handle, &pos);
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+// EM2 keeps RAM, so nvm_cache entries wait for their flush timer (nvm_cache.h)
+bool app_is_ok_to_sleep(void)
+{
+  return !app_events_pending();
+}
+
+sl_power_manager_on_isr_exit_t app_sleep_on_isr_exit(void)
+{
+  return app_events_pending() ? SL_POWER_MANAGER_WAKEUP : SL_POWER_MANAGER_IGNORE;
+}
+#endif
+
+// Runs in interrupt context: queue the press and let the main loop handle it.
+void sl_button_on_change(const sl_button_t *handle)
+{
+  if (sl_button_get_state(handle) != SL_SIMPLE_BUTTON_PRESSED) {
+    return;
+  }
+
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (handle == &sl_button_btn0) {
+    pending_buttons |= BUTTON_BTN0_PRESSED;
+    button_press_tick[0] = now;
+  } else if (handle == &sl_button_btn1) {
+    pending_buttons |= BUTTON_BTN1_PRESSED;
+    button_press_tick[1] = now;
+  }
+  CORE_EXIT_ATOMIC();
+  trace_event(TRACE_BUTTON, handle == &sl_button_btn0 ? 0 : 1, 0);
+  app_events_post(APP_EVENT_BUTTON);
+}
+
+// --- Internal Helper Functions ---
+
+// Returns true when the current screen needs to be redrawn
+static bool handle_joystick(void)
+{
+  joystick_input_event_t event;
+  bool redraw = false;
+  bool any = false;
+
+  while (joystick_input_get_event(&event)) {
+    any = true;
+    // In game, left/right/down repeat on the DAS/ARR timing instead of hold events
+    if (tetris_get_game_state() == GAME_STATE_IN_GAME && auto_repeat_handles(event.position)) {
+      if (event.type == JOYSTICK_INPUT_PRESS) {
+        latency_input(LATENCY_INPUT_PRESS, event.tick);
+        auto_repeat_press(event.position, event.tick);
+      } else if (event.type == JOYSTICK_INPUT_RELEASE) {
+        auto_repeat_release(event.position);
+      }
+      continue;
+    }
+    if (event.type == JOYSTICK_INPUT_RELEASE) {
+      redraw |= dispatch_joystick(JOYSTICK_NONE, false);
+    } else {
+      bool is_repeat = event.type == JOYSTICK_INPUT_HOLD;
+      latency_input(is_repeat ? LATENCY_INPUT_REPEAT : LATENCY_INPUT_PRESS, event.tick);
+      redraw |= dispatch_joystick(event.position, is_repeat);
+    }
+  }
+  if (!any) {
+    // Woken without a queued event (e.g. a menu dwell timer): let the menu see an idle sample
+    redraw |= dispatch_joystick(JOYSTICK_NONE, false);
+  }
+  return redraw;
+}
+
+// Press and hold events both act; holding rotate, hard drop or select does not repeat
+static bool dispatch_joystick(sl_joystick_position_t pos, bool is_repeat)
+{
+  game_state_t current_state = tetris_get_game_state();
+  if (is_repeat && (pos == JOYSTICK_C || (pos == JOYSTICK_N && current_state == GAME_STATE_IN_GAME))) {
+    return false;
   }
 
   if (current_state == GAME_STATE_MAIN_MENU) {
     main_menu_handle_input(pos, NULL);
   } else if (current_state == GAME_STATE_IN_GAME) {
     switch (pos) {
-      case JOYSTICK_W: tetris_move_left(); break;
-      case JOYSTICK_E: tetris_move_right(); break;
-      case JOYSTICK_S: tetris_move_down(); break;
       case JOYSTICK_N: tetris_rotate(); break;
       case JOYSTICK_C: tetris_hard_drop(); break;
       default: break;
     }
+    return false;
   } else if (current_state == GAME_STATE_SLOT_SELECTION) {
     slot_menu_handle_input(pos, NULL);
   } else if (current_state == GAME_STATE_SCOREBOARD) {
     scoreboard_handle_input(pos, NULL);
+  } else if (current_state == GAME_STATE_STATS) {
+    stats_screen_handle_input(pos, NULL);
+  } else if (current_state == GAME_STATE_HANDLING) {
+    handling_screen_handle_input(pos, NULL);
+  } else if (current_state == GAME_STATE_DIAGNOSTICS) {
+    diagnostics_screen_handle_input(pos, NULL);
   }
-
-  // --- Handle Drawing ---
-  // Note: Drawing is handled within the state update functions (e.g., tetris_update) for the game
-  // and on demand for the menu.
-  if (current_state == GAME_STATE_MAIN_MENU) {
-    main_menu_draw();
-  } else if (current_state == GAME_STATE_PAUSED) {
-    tetris_draw_board();
-  } else if (current_state == GAME_STATE_SLOT_SELECTION) {
-    slot_menu_draw();
-  } else if (current_state == GAME_STATE_SCOREBOARD) {
-    scoreboard_draw();
-  }
-  // For IN_GAME and GAME_OVER, drawing is handled by tetris_update and its call to tetris_draw_board
+  return pos != JOYSTICK_NONE;
 }
 
-void sl_button_on_change(const sl_button_t *handle)
+static bool handle_buttons(void)
 {
-  if (sl_button_get_state(handle) != SL_SIMPLE_BUTTON_PRESSED) {
-    return;
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  uint8_t presses = pending_buttons;
+  uint32_t ticks[2] = { button_press_tick[0], button_press_tick[1] };
+  pending_buttons = 0;
+  CORE_EXIT_ATOMIC();
+
+  if (presses & BUTTON_BTN0_PRESSED) {
+    latency_input(LATENCY_INPUT_BUTTON, ticks[0]);
+    handle_button_press(&sl_button_btn0);
+  }
+  if (presses & BUTTON_BTN1_PRESSED) {
+    latency_input(LATENCY_INPUT_BUTTON, ticks[1]);
+    handle_button_press(&sl_button_btn1);
   }
+  return presses != 0;
+}
 
+static void handle_button_press(const sl_button_t *handle)
+{
   game_state_t current_state = tetris_get_game_state();
 
   if (current_state == GAME_STATE_MAIN_MENU) {
+    // Hidden chord: holding both buttons opens the diagnostics screen
+    if (sl_button_get_state(&sl_button_btn0) == SL_SIMPLE_BUTTON_PRESSED
+        && sl_button_get_state(&sl_button_btn1) == SL_SIMPLE_BUTTON_PRESSED) {
+      diagnostics_screen_enter();
+      return;
+    }
     // Pass button presses to menu handler
     main_menu_handle_input(JOYSTICK_NONE, handle);
+  } else if (tetris_is_practice()
+             && (current_state == GAME_STATE_IN_GAME || current_state == GAME_STATE_PAUSED
+                 || current_state == GAME_STATE_GAME_OVER)
+             && sl_button_get_state(&sl_button_btn0) == SL_SIMPLE_BUTTON_PRESSED
+             && sl_button_get_state(&sl_button_btn1) == SL_SIMPLE_BUTTON_PRESSED) {
+      // Practice chord: each press while the other button is held takes back a piece
+      tetris_rewind();
   } else if (current_state == GAME_STATE_IN_GAME) {
       if (handle == &sl_button_btn1) {
         tetris_pause_game();
       }
-      if (handle == &sl_button_btn0) { // BTN0 is for saving
+      if (handle == &sl_button_btn0 && !tetris_is_practice()) { // BTN0 is for saving; in practice it starts the chord
         tetris_save_game();
       }
   } else if (current_state == GAME_STATE_PAUSED) {
       if (handle == &sl_button_btn1) {
         tetris_resume_game();
       }
-      if (handle == &sl_button_btn0) { // BTN0 is for saving
+      if (handle == &sl_button_btn0 && !tetris_is_practice()) {
         tetris_save_game();
       }
   } else if (current_state == GAME_STATE_SLOT_SELECTION) {
       slot_menu_handle_input(JOYSTICK_NONE, handle);
   } else if (current_state == GAME_STATE_SCOREBOARD) {
       scoreboard_handle_input(JOYSTICK_NONE, handle);
+  } else if (current_state == GAME_STATE_STATS) {
+      stats_screen_handle_input(JOYSTICK_NONE, handle);
+  } else if (current_state == GAME_STATE_HANDLING) {
+      handling_screen_handle_input(JOYSTICK_NONE, handle);
+  } else if (current_state == GAME_STATE_DIAGNOSTICS) {
+      diagnostics_screen_handle_input(JOYSTICK_NONE, handle);
   } else if (current_state == GAME_STATE_GAME_OVER) {
     if (handle == &sl_button_btn1) { // BTN1 is "Start"
       tetris_set_game_state(GAME_STATE_MAIN_MENU);
     }
   }
 }
+
+static void draw_current_screen(game_state_t current_state)
+{
+  uint32_t frame_start = sl_sleeptimer_get_tick_count();
+  if (current_state == GAME_STATE_MAIN_MENU) {
+    PROFILE_CALL(PROFILE_ZONE_MENU_DRAW, main_menu_draw());
+  } else if (current_state == GAME_STATE_SLOT_SELECTION) {
+    PROFILE_CALL(PROFILE_ZONE_MENU_DRAW, slot_menu_draw());
+  } else if (current_state == GAME_STATE_SCOREBOARD) {
+    PROFILE_CALL(PROFILE_ZONE_MENU_DRAW, scoreboard_draw());
+  } else if (current_state == GAME_STATE_STATS) {
+    PROFILE_CALL(PROFILE_ZONE_MENU_DRAW, stats_screen_draw());
+  } else if (current_state == GAME_STATE_HANDLING) {
+    PROFILE_CALL(PROFILE_ZONE_MENU_DRAW, handling_screen_draw());
+  } else if (current_state == GAME_STATE_DIAGNOSTICS) {
+    PROFILE_CALL(PROFILE_ZONE_MENU_DRAW, diagnostics_screen_draw());
+  } else {
+    // In game, paused and game over share the board screen; it times its own frames
+    tetris_draw_board();
+    return;
+  }
+  diagnostics_on_frame(frame_start);
+}
@@ -0,0 +1,100 @@
+#include "app_events.h"
+#include "sl_component_catalog.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+#include "sl_power_manager.h"
+#endif
+#include <string.h>
+
+static volatile uint32_t pending_events = 0;
+static app_duty_cycle_t duty;
+static uint32_t last_tick = 0;
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+static uint32_t sleep_start_tick = 0;
+static sl_power_manager_em_transition_event_handle_t em_transition_handle;
+static void em_transition_callback(sl_power_manager_em_t from, sl_power_manager_em_t to);
+static const sl_power_manager_em_transition_event_info_t em_transition_info = {
+  .event_mask = SL_POWER_MANAGER_EVENT_TRANSITION_ENTERING_EM2
+                | SL_POWER_MANAGER_EVENT_TRANSITION_LEAVING_EM2,
+  .on_event = em_transition_callback
+};
+#endif
+
+// --- Local function prototypes ---
+static void accumulate_total_ticks(void);
+
+// --- Public functions ---
+
+void app_events_init(void)
+{
+  pending_events = 0;
+  memset(&duty, 0, sizeof(duty));
+  last_tick = sl_sleeptimer_get_tick_count();
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+  duty.sleep_supported = true;
+  sl_power_manager_subscribe_em_transition_event(&em_transition_handle, &em_transition_info);
+#endif
+}
+
+// Safe from any interrupt or timer callback.
+void app_events_post(uint32_t events)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  pending_events |= events;
+  CORE_EXIT_ATOMIC();
+}
+
+uint32_t app_events_take(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  uint32_t events = pending_events;
+  pending_events = 0;
+  accumulate_total_ticks();
+  CORE_EXIT_ATOMIC();
+
+  for (uint32_t bits = events; bits != 0; bits &= bits - 1) {
+    duty.events_handled++;
+  }
+  return events;
+}
+
+bool app_events_pending(void)
+{
+  return pending_events != 0;
+}
+
+void app_events_get_duty_cycle(app_duty_cycle_t *out)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  accumulate_total_ticks();
+  *out = duty;
+  CORE_EXIT_ATOMIC();
+}
+
+// --- Internal Helper Functions ---
+
+// Called at least once per wakeup, well inside the 32-bit tick wrap period.
+static void accumulate_total_ticks(void)
+{
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  duty.total_ticks += (uint32_t)(now - last_tick);
+  last_tick = now;
+}
+
+#if defined(SL_CATALOG_POWER_MANAGER_PRESENT)
+static void em_transition_callback(sl_power_manager_em_t from, sl_power_manager_em_t to)
+{
+  if (to == SL_POWER_MANAGER_EM2) {
+    sleep_start_tick = sl_sleeptimer_get_tick_count();
+  } else if (from == SL_POWER_MANAGER_EM2) {
+    duty.sleep_ticks += (uint32_t)(sl_sleeptimer_get_tick_count() - sleep_start_tick);
+    duty.wakeups++;
+  }
+}
+#endif
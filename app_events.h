@@ -0,0 +1,32 @@
+#ifndef APP_EVENTS_H
+#define APP_EVENTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Pending work for the super loop. Interrupts and timer callbacks post events,
+// app_process_action() takes and handles them, and the core sleeps in EM2
+// whenever nothing is pending.
+#define APP_EVENT_GRAVITY     (1u << 0) // the falling piece is due to drop a row
+#define APP_EVENT_JOYSTICK    (1u << 1) // joystick events are queued
+#define APP_EVENT_BUTTON      (1u << 2) // a button press is queued
+#define APP_EVENT_REDRAW      (1u << 3) // screen content changed outside input handling
+#define APP_EVENT_STORAGE     (1u << 4) // a deferred flash job is due
+#define APP_EVENT_AUTO_REPEAT (1u << 5) // a held direction is due to repeat
+#define APP_EVENT_DIAGNOSTICS (1u << 6) // a periodic debug report is due
+
+typedef struct {
+  uint64_t total_ticks;   // sleeptimer ticks since app_events_init()
+  uint64_t sleep_ticks;   // of which spent in EM2
+  uint32_t wakeups;       // EM2 exits
+  uint32_t events_handled;
+  bool sleep_supported;   // false when the power manager is not in the build
+} app_duty_cycle_t;
+
+void app_events_init(void);
+void app_events_post(uint32_t events);
+uint32_t app_events_take(void);
+bool app_events_pending(void);
+void app_events_get_duty_cycle(app_duty_cycle_t *duty);
+
+#endif // APP_EVENTS_H
@@ -0,0 +1,183 @@
+#include "auto_repeat.h"
+#include "tetris.h"
+#include "nvm_cache.h"
+#include "app_events.h"
+#include "latency.h"
+#include "sl_sleeptimer.h"
+
+static const auto_repeat_settings_t default_settings = {
+  .das_ms = 170,
+  .arr_ms = 50,
+  .soft_drop_factor = 20,
+};
+
+static auto_repeat_settings_t settings;
+static sl_joystick_position_t active_position = JOYSTICK_NONE;
+static bool das_charged = false;
+static uint32_t next_tick = 0; // deadline of the next repeat
+static sl_sleeptimer_timer_handle_t repeat_timer;
+
+// --- Local function prototypes ---
+static bool settings_valid(const auto_repeat_settings_t *candidate);
+static uint32_t repeat_period_ticks(void);
+static void schedule_repeat(uint32_t now);
+static void stop_repeat(void);
+static void repeat_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+// --- Public functions ---
+
+void auto_repeat_init(void)
+{
+  if (nvm_cache_read(AUTO_REPEAT_SETTINGS_KEY, &settings, sizeof(settings)) != ECODE_NVM3_OK
+      || !settings_valid(&settings)) {
+    settings = default_settings;
+  }
+  active_position = JOYSTICK_NONE;
+}
+
+void auto_repeat_get_settings(auto_repeat_settings_t *out)
+{
+  *out = settings;
+}
+
+void auto_repeat_set_settings(const auto_repeat_settings_t *candidate)
+{
+  if (!settings_valid(candidate)) {
+    return;
+  }
+  if (candidate->das_ms != settings.das_ms
+      || candidate->arr_ms != settings.arr_ms
+      || candidate->soft_drop_factor != settings.soft_drop_factor) {
+    settings = *candidate;
+    settings.reserved = 0;
+    nvm_cache_write(AUTO_REPEAT_SETTINGS_KEY, &settings, sizeof(settings));
+  }
+}
+
+bool auto_repeat_handles(sl_joystick_position_t position)
+{
+  return position == JOYSTICK_W || position == JOYSTICK_E || position == JOYSTICK_S;
+}
+
+// Acts on the press right away and times the repeats from the press timestamp.
+void auto_repeat_press(sl_joystick_position_t position, uint32_t tick)
+{
+  if (!auto_repeat_handles(position)) {
+    return;
+  }
+  active_position = position;
+  das_charged = false;
+
+  if (position == JOYSTICK_S) {
+    tetris_move_down();
+    next_tick = tick + repeat_period_ticks();
+  } else {
+    tetris_shift(position == JOYSTICK_W ? -1 : 1, 1);
+    next_tick = tick + sl_sleeptimer_ms_to_tick(settings.das_ms);
+  }
+  schedule_repeat(sl_sleeptimer_get_tick_count());
+}
+
+void auto_repeat_release(sl_joystick_position_t position)
+{
+  if (position == active_position) {
+    stop_repeat();
+  }
+}
+
+// Called on repeat deadlines and after gravity, so an instant (ARR 0) shift
+// also carries over to the next piece while the direction stays held.
+void auto_repeat_process_action(void)
+{
+  if (active_position == JOYSTICK_NONE) {
+    return;
+  }
+  if (tetris_get_game_state() != GAME_STATE_IN_GAME) {
+    stop_repeat();
+    return;
+  }
+
+  bool horizontal = active_position != JOYSTICK_S;
+  int dx = active_position == JOYSTICK_W ? -1 : 1;
+  uint32_t now = sl_sleeptimer_get_tick_count();
+
+  if (horizontal && das_charged && settings.arr_ms == 0) {
+    tetris_shift(dx, BOARD_WIDTH);
+    return;
+  }
+  if ((int32_t)(now - next_tick) < 0) {
+    schedule_repeat(now);
+    return;
+  }
+  latency_input(LATENCY_INPUT_REPEAT, next_tick); // the deadline is the input's source time
+
+  if (horizontal && !das_charged) {
+    das_charged = true;
+    if (settings.arr_ms == 0) {
+      tetris_shift(dx, BOARD_WIDTH);
+      return;
+    }
+  }
+
+  // Every deadline that passed since the last wakeup gets its move
+  uint32_t period = repeat_period_ticks();
+  uint32_t steps = 1 + (now - next_tick) / period;
+  if (horizontal) {
+    tetris_shift(dx, steps > BOARD_WIDTH ? BOARD_WIDTH : (int)steps);
+  } else {
+    if (steps > BOARD_HEIGHT) {
+      steps = BOARD_HEIGHT;
+    }
+    for (uint32_t i = 0; i < steps && tetris_get_game_state() == GAME_STATE_IN_GAME; i++) {
+      tetris_move_down();
+    }
+  }
+  next_tick += steps * period;
+  if ((int32_t)(now - next_tick) >= 0) {
+    next_tick = now + period; // capped catch-up: resume from now
+  }
+  schedule_repeat(now);
+}
+
+// --- Internal Helper Functions ---
+
+static bool settings_valid(const auto_repeat_settings_t *candidate)
+{
+  return candidate->das_ms >= AUTO_REPEAT_DAS_MIN_MS
+         && candidate->das_ms <= AUTO_REPEAT_DAS_MAX_MS
+         && candidate->arr_ms <= AUTO_REPEAT_ARR_MAX_MS
+         && candidate->soft_drop_factor >= 1
+         && candidate->soft_drop_factor <= AUTO_REPEAT_SOFT_DROP_MAX;
+}
+
+static uint32_t repeat_period_ticks(void)
+{
+  uint32_t period;
+  if (active_position == JOYSTICK_S) {
+    period = sl_sleeptimer_ms_to_tick(tetris_get_gravity_ms()) / settings.soft_drop_factor;
+  } else {
+    period = sl_sleeptimer_ms_to_tick(settings.arr_ms);
+  }
+  return period > 0 ? period : 1;
+}
+
+static void schedule_repeat(uint32_t now)
+{
+  int32_t delay = (int32_t)(next_tick - now);
+  sl_sleeptimer_stop_timer(&repeat_timer);
+  sl_sleeptimer_start_timer(&repeat_timer, delay > 0 ? (uint32_t)delay : 1,
+                            repeat_timer_callback, NULL, 0, 0);
+}
+
+static void stop_repeat(void)
+{
+  active_position = JOYSTICK_NONE;
+  sl_sleeptimer_stop_timer(&repeat_timer);
+}
+
+static void repeat_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  app_events_post(APP_EVENT_AUTO_REPEAT);
+}
@@ -0,0 +1,37 @@
+#ifndef AUTO_REPEAT_H
+#define AUTO_REPEAT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sl_joystick.h"
+
+// In-game handling: delayed auto shift (DAS) and auto repeat rate (ARR) for
+// left/right, and a soft-drop speed relative to gravity. Timing runs off the
+// joystick event timestamps, so late wakeups catch up instead of losing moves.
+// Settings live in one small NVM3 object written through the nvm_cache.
+#define AUTO_REPEAT_SETTINGS_KEY  310
+
+#define AUTO_REPEAT_DAS_MIN_MS    30
+#define AUTO_REPEAT_DAS_MAX_MS    300
+#define AUTO_REPEAT_DAS_STEP_MS   10
+#define AUTO_REPEAT_ARR_MAX_MS    100 // ARR 0 moves to the wall in one step
+#define AUTO_REPEAT_ARR_STEP_MS   5
+#define AUTO_REPEAT_SOFT_DROP_MAX 40  // soft drop is gravity times this factor
+
+typedef struct {
+  uint16_t das_ms;
+  uint16_t arr_ms;
+  uint16_t soft_drop_factor;
+  uint16_t reserved;
+} auto_repeat_settings_t;
+
+void auto_repeat_init(void);
+void auto_repeat_get_settings(auto_repeat_settings_t *settings);
+void auto_repeat_set_settings(const auto_repeat_settings_t *settings);
+bool auto_repeat_handles(sl_joystick_position_t position);
+void auto_repeat_press(sl_joystick_position_t position, uint32_t tick);
+void auto_repeat_release(sl_joystick_position_t position);
+void auto_repeat_process_action(void);
+
+#endif // AUTO_REPEAT_H
@@ -0,0 +1,178 @@
+#include "autosave.h"
+#include "memory_monitor.h"
+#include "tetris.h"
+#include "em_core.h"
+#include "nvm3_default.h"
+#include "storage_telemetry.h"
+#include "sl_sleeptimer.h"
+#include "app_events.h"
+#include <string.h>
+
+#define AUTOSAVE_MAGIC 0x54534156 // "TSAV"
+
+typedef struct {
+  uint32_t magic;
+  uint32_t sequence;
+  tetris_snapshot_t snapshot;
+} autosave_record_t;
+
+// Budget tokens are kept in 1/60000 of a write so refills stay integral per ms
+#define TOKEN_ONE_WRITE   60000u
+#define TOKEN_CAPACITY    (AUTOSAVE_BURST_WRITES * TOKEN_ONE_WRITE)
+
+static autosave_record_t pending_record;
+static volatile bool record_pending = false;
+static volatile bool discard_requested = false;
+static bool checkpoint_in_flash = false;
+static uint32_t sequence = 0;
+static uint32_t tokens = TOKEN_CAPACITY;
+static uint32_t last_refill_tick = 0;
+static autosave_stats_t stats;
+static sl_sleeptimer_timer_handle_t retry_timer;
+
+// --- Local function prototypes ---
+static void refill_tokens(void);
+static void retry_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+// --- Public functions ---
+
+void autosave_init(void)
+{
+  autosave_record_t record;
+  uint32_t type;
+  size_t len;
+
+  memory_monitor_account("autosave", sizeof(pending_record) + sizeof(stats));
+  memset(&stats, 0, sizeof(stats));
+  record_pending = false;
+  discard_requested = false;
+  checkpoint_in_flash = false;
+  tokens = TOKEN_CAPACITY;
+  last_refill_tick = sl_sleeptimer_get_tick_count();
+
+  if (nvm3_getObjectInfo(nvm3_defaultHandle, AUTOSAVE_KEY, &type, &len) == ECODE_NVM3_OK
+      && len == sizeof(record)
+      && nvm3_readData(nvm3_defaultHandle, AUTOSAVE_KEY, &record, len) == ECODE_NVM3_OK
+      && record.magic == AUTOSAVE_MAGIC) {
+    checkpoint_in_flash = true;
+    sequence = record.sequence;
+  }
+}
+
+// Called from the lock path, possibly in timer context: encode only, never touch flash.
+void autosave_on_lock(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (record_pending) {
+    stats.checkpoints_dropped++;
+  }
+  tetris_snapshot_take(&pending_record.snapshot);
+  record_pending = true;
+  discard_requested = false;
+  stats.checkpoints_taken++;
+  CORE_EXIT_ATOMIC();
+}
+
+// The run is over; there is nothing left to resume.
+void autosave_discard(void)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  record_pending = false;
+  discard_requested = true;
+  CORE_EXIT_ATOMIC();
+}
+
+void autosave_process_action(void)
+{
+  if (discard_requested) {
+    discard_requested = false;
+    if (checkpoint_in_flash) {
+      storage_delete(AUTOSAVE_KEY);
+      checkpoint_in_flash = false;
+    }
+    return;
+  }
+
+  if (!record_pending) {
+    return;
+  }
+
+  refill_tokens();
+  if (tokens < TOKEN_ONE_WRITE) {
+    // Keep the newest checkpoint pending and wake up once the budget allows a write
+    bool running = false;
+    sl_sleeptimer_is_timer_running(&retry_timer, &running);
+    if (!running) {
+      uint32_t wait_ms = (TOKEN_ONE_WRITE - tokens) / AUTOSAVE_MAX_WRITES_PER_MINUTE + 1;
+      sl_sleeptimer_start_timer_ms(&retry_timer, wait_ms, retry_timer_callback, NULL, 0, 0);
+    }
+    return;
+  }
+
+  autosave_record_t record;
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  record = pending_record;
+  record_pending = false;
+  CORE_EXIT_ATOMIC();
+
+  record.magic = AUTOSAVE_MAGIC;
+  record.sequence = sequence + 1;
+  if (storage_write(AUTOSAVE_KEY, &record, sizeof(record)) == ECODE_NVM3_OK) {
+    sequence = record.sequence;
+    checkpoint_in_flash = true;
+    tokens -= TOKEN_ONE_WRITE;
+    stats.checkpoints_written++;
+  }
+}
+
+bool autosave_has_checkpoint(void)
+{
+  return checkpoint_in_flash;
+}
+
+bool autosave_resume(void)
+{
+  autosave_record_t record;
+  if (!checkpoint_in_flash
+      || nvm3_readData(nvm3_defaultHandle, AUTOSAVE_KEY, &record, sizeof(record)) != ECODE_NVM3_OK
+      || record.magic != AUTOSAVE_MAGIC) {
+    return false;
+  }
+  tetris_start_from_snapshot(&record.snapshot);
+  return tetris_get_game_state() == GAME_STATE_IN_GAME;
+}
+
+void autosave_get_stats(autosave_stats_t *out)
+{
+  *out = stats;
+}
+
+// --- Internal Helper Functions ---
+
+static void refill_tokens(void)
+{
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  uint32_t elapsed_ms = sl_sleeptimer_tick_to_ms(now - last_refill_tick);
+  if (elapsed_ms == 0) {
+    return;
+  }
+  last_refill_tick = now;
+
+  // AUTOSAVE_MAX_WRITES_PER_MINUTE writes per 60000 ms
+  uint32_t refill = elapsed_ms * AUTOSAVE_MAX_WRITES_PER_MINUTE;
+  if (elapsed_ms > TOKEN_CAPACITY || tokens + refill > TOKEN_CAPACITY) {
+    tokens = TOKEN_CAPACITY;
+  } else {
+    tokens += refill;
+  }
+}
+
+static void retry_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  app_events_post(APP_EVENT_STORAGE);
+}
@@ -0,0 +1,28 @@
+#ifndef AUTOSAVE_H
+#define AUTOSAVE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Crash-safe checkpoint taken at piece-lock boundaries. All checkpoints go
+// through one NVM3 object; NVM3 places every rewrite in fresh flash, and the
+// write rate is capped by a flash-wear budget.
+#define AUTOSAVE_KEY                    350
+#define AUTOSAVE_MAX_WRITES_PER_MINUTE  6
+#define AUTOSAVE_BURST_WRITES           2
+
+typedef struct {
+  uint32_t checkpoints_taken;   // lock-path encodes
+  uint32_t checkpoints_written; // NVM3 writes
+  uint32_t checkpoints_dropped; // superseded by a newer checkpoint before a write was allowed
+} autosave_stats_t;
+
+void autosave_init(void);
+void autosave_on_lock(void);
+void autosave_discard(void);
+void autosave_process_action(void);
+bool autosave_has_checkpoint(void);
+bool autosave_resume(void);
+void autosave_get_stats(autosave_stats_t *stats);
+
+#endif // AUTOSAVE_H
@@ -0,0 +1,304 @@
+#include "tetris.h"
+
+#if TETRIS_BENCH
+
+#include "benchmark.h"
+#include "main_menu.h"
+#include "em_device.h"
+#include "sl_debug_swo.h"
+#include <stdio.h>
+#include <string.h>
+#if !defined(DWT)
+#include <time.h>
+#endif
+
+#define SWO_CHANNEL      0
+#define LINE_LENGTH      192
+#define MAX_ITERATIONS   (1u << 20)
+
+typedef struct {
+  const char *name;
+  void (*setup)(void);
+  void (*run)(void);
+} workload_t;
+
+static benchmark_config_t config;
+static benchmark_result_t results[BENCHMARK_MAX_RESULTS];
+static size_t result_count;
+static double per_call[BENCHMARK_MAX_SAMPLES];
+static volatile int sink; // keeps kernel results alive
+
+// Board positions; row 0 is the top, bit x of a row is column x
+static uint16_t rows_empty[BOARD_HEIGHT];
+static uint16_t rows_half[BOARD_HEIGHT];   // 10 rows, one column open
+static uint16_t rows_tall[BOARD_HEIGHT];   // 18 rows, one column open
+static uint16_t rows_clear[5][BOARD_HEIGHT]; // n full rows under a ragged stack
+
+// --- Local function prototypes ---
+static void build_boards(void);
+static void run_workload(const workload_t *workload);
+static uint32_t now(void);
+static uint32_t time_iterations(const workload_t *workload, uint32_t iterations);
+static void sort(double *values, int count);
+static void write_text(const char *text);
+static void write_result(const benchmark_result_t *result, bool last);
+static void format_fixed(char *buffer, size_t size, double value);
+
+// --- Workloads ---
+
+static void setup_collision_empty(void) { tetris_bench_load(rows_empty, 3, 4, 5); }
+static void setup_collision_stack(void) { tetris_bench_load(rows_tall, 3, 4, 1); }
+static void setup_collision_wall(void)  { tetris_bench_load(rows_empty, 1, 1, 5); }
+static void run_collision_down(void)    { sink += tetris_bench_collides(0, 1); }
+static void run_collision_left(void)    { sink += tetris_bench_collides(-1, 0); }
+
+static void setup_rotate_open(void)     { tetris_bench_load(rows_empty, 3, 4, 5); }
+static void setup_rotate_blocked(void)  { tetris_bench_load(rows_empty, 1, 4, BOARD_HEIGHT - 1); }
+static void run_rotate(void)            { sink += tetris_bench_rotate(); }
+
+static void setup_merge(void)           { tetris_bench_load(rows_half, 3, 4, 9); }
+static void run_merge(void)             { tetris_bench_merge(); }
+
+// Clearing changes the board, so every call reloads it; board_load is that cost alone
+static void run_board_load(void)        { tetris_bench_load(rows_clear[4], 3, 4, 0); }
+static void run_clear_0(void)           { tetris_bench_load(rows_clear[0], 3, 4, 0); sink += tetris_bench_clear_lines(false); }
+static void run_clear_1(void)           { tetris_bench_load(rows_clear[1], 3, 4, 0); sink += tetris_bench_clear_lines(false); }
+static void run_clear_2(void)           { tetris_bench_load(rows_clear[2], 3, 4, 0); sink += tetris_bench_clear_lines(false); }
+static void run_clear_3(void)           { tetris_bench_load(rows_clear[3], 3, 4, 0); sink += tetris_bench_clear_lines(false); }
+static void run_clear_4(void)           { tetris_bench_load(rows_clear[4], 3, 4, 0); sink += tetris_bench_clear_lines(false); }
+static void run_tspin_0(void)           { tetris_bench_load(rows_clear[0], 3, 4, 0); sink += tetris_bench_clear_lines(true); }
+static void run_tspin_1(void)           { tetris_bench_load(rows_clear[1], 3, 4, 0); sink += tetris_bench_clear_lines(true); }
+static void run_tspin_2(void)           { tetris_bench_load(rows_clear[2], 3, 4, 0); sink += tetris_bench_clear_lines(true); }
+
+// Practice mode's lock-path snapshot and the rewind that puts it back
+static void setup_rewind_half(void)     { tetris_bench_load(rows_half, 3, 4, 0); tetris_bench_rewind_take(); }
+static void setup_rewind_tall(void)     { tetris_bench_load(rows_tall, 3, 4, 0); tetris_bench_rewind_take(); }
+static void run_rewind_take(void)       { tetris_bench_rewind_take(); }
+static void run_rewind_restore(void)    { tetris_bench_rewind_restore(); }
+
+static void setup_drop_empty(void)      { tetris_bench_load(rows_empty, 3, 4, 0); }
+static void setup_drop_half(void)       { tetris_bench_load(rows_half, 3, 4, 0); }
+static void setup_drop_tall(void)       { tetris_bench_load(rows_tall, 3, 4, 0); }
+static void run_drop(void)              { sink += tetris_bench_drop(); }
+
+static void setup_nothing(void)         {}
+static void run_draw_board(void)        { tetris_draw_board(); }
+static void run_menu_main(void)         { main_menu_draw(); }
+static void run_menu_scoreboard(void)   { scoreboard_draw(); }
+static void run_menu_stats(void)        { stats_screen_draw(); }
+static void run_menu_slots(void)        { slot_menu_draw(); }
+
+static const workload_t workloads[] = {
+  { "collision_empty",  setup_collision_empty, run_collision_down },
+  { "collision_stack",  setup_collision_stack, run_collision_down },
+  { "collision_wall",   setup_collision_wall,  run_collision_left },
+  { "rotate_open",      setup_rotate_open,     run_rotate },
+  { "rotate_blocked",   setup_rotate_blocked,  run_rotate },
+  { "merge",            setup_merge,           run_merge },
+  { "board_load",       setup_nothing,         run_board_load },
+  { "clear_lines_0",    setup_nothing,         run_clear_0 },
+  { "clear_lines_1",    setup_nothing,         run_clear_1 },
+  { "clear_lines_2",    setup_nothing,         run_clear_2 },
+  { "clear_lines_3",    setup_nothing,         run_clear_3 },
+  { "clear_lines_4",    setup_nothing,         run_clear_4 },
+  { "t_spin_mini",      setup_nothing,         run_tspin_0 },
+  { "t_spin_single",    setup_nothing,         run_tspin_1 },
+  { "t_spin_double",    setup_nothing,         run_tspin_2 },
+  { "rewind_take_half", setup_rewind_half,     run_rewind_take },
+  { "rewind_take_tall", setup_rewind_tall,     run_rewind_take },
+  { "rewind_restore",   setup_rewind_tall,     run_rewind_restore },
+  { "hard_drop_empty",  setup_drop_empty,      run_drop },
+  { "hard_drop_half",   setup_drop_half,       run_drop },
+  { "hard_drop_tall",   setup_drop_tall,       run_drop },
+  { "draw_board_empty", setup_drop_empty,      run_draw_board },
+  { "draw_board_half",  setup_drop_half,       run_draw_board },
+  { "draw_board_tall",  setup_drop_tall,       run_draw_board },
+  { "menu_main",        setup_nothing,         run_menu_main },
+  { "menu_scoreboard",  setup_nothing,         run_menu_scoreboard },
+  { "menu_stats",       setup_nothing,         run_menu_stats },
+  { "menu_slots",       setup_nothing,         run_menu_slots },
+};
+
+// --- Public functions ---
+
+void benchmark_configure(const benchmark_config_t *new_config)
+{
+  config = *new_config;
+}
+
+// Leaves the game on the main menu with an empty board
+void benchmark_run(void)
+{
+#if defined(DWT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  build_boards();
+  result_count = 0;
+
+  for (size_t i = 0; i < sizeof(workloads) / sizeof(workloads[0]) && result_count < BENCHMARK_MAX_RESULTS; i++) {
+    if (config.filter != NULL && strstr(workloads[i].name, config.filter) == NULL) {
+      continue;
+    }
+    run_workload(&workloads[i]);
+  }
+  benchmark_write_results(results, result_count);
+
+  tetris_bench_load(rows_empty, 3, 4, 0);
+  tetris_set_game_state(GAME_STATE_MAIN_MENU);
+}
+
+const benchmark_result_t *benchmark_get_results(size_t *count)
+{
+  *count = result_count;
+  return results;
+}
+
+// Writes results as benchmark_run() does; a host driver merging several runs uses it too
+void benchmark_write_results(const benchmark_result_t *results_to_write, size_t count)
+{
+  char line[LINE_LENGTH];
+  uint32_t samples = config.samples ? config.samples : BENCHMARK_SAMPLES;
+  snprintf(line, sizeof(line), "{\n  \"unit\": \"" BENCHMARK_UNIT "\",\n  \"samples\": %lu,\n  \"results\": [\n",
+           (unsigned long)(samples < BENCHMARK_MAX_SAMPLES ? samples : BENCHMARK_MAX_SAMPLES));
+  write_text(line);
+  for (size_t i = 0; i < count; i++) {
+    write_result(&results_to_write[i], i + 1 == count);
+  }
+  write_text("  ]\n}\n");
+}
+
+// --- Internal Helper Functions ---
+
+static void build_boards(void)
+{
+  const uint16_t full = (1u << BOARD_WIDTH) - 1;
+  memset(rows_empty, 0, sizeof(rows_empty));
+  memset(rows_half, 0, sizeof(rows_half));
+  memset(rows_tall, 0, sizeof(rows_tall));
+  memset(rows_clear, 0, sizeof(rows_clear));
+
+  for (int y = BOARD_HEIGHT - 10; y < BOARD_HEIGHT; y++) {
+    rows_half[y] = full & ~(1u << 9);
+  }
+  for (int y = BOARD_HEIGHT - 18; y < BOARD_HEIGHT; y++) {
+    rows_tall[y] = full & ~(1u << 9);
+  }
+  // n full rows at the bottom under six ragged rows, so clearing shifts a real stack
+  for (int n = 0; n <= 4; n++) {
+    for (int i = 0; i < n; i++) {
+      rows_clear[n][BOARD_HEIGHT - 1 - i] = full;
+    }
+    for (int i = 0; i < 6; i++) {
+      rows_clear[n][BOARD_HEIGHT - 1 - n - i] = full & ~(1u << ((i * 3) % BOARD_WIDTH));
+    }
+  }
+}
+
+static void run_workload(const workload_t *workload)
+{
+  uint32_t samples = config.samples ? config.samples : BENCHMARK_SAMPLES;
+  if (samples > BENCHMARK_MAX_SAMPLES) {
+    samples = BENCHMARK_MAX_SAMPLES;
+  }
+
+  // Grow the batch until one sample is long enough to time reliably. A batch
+  // size handed in from a baseline keeps the two runs comparable.
+  workload->setup();
+  uint32_t iterations = config.iterations != NULL ? config.iterations(workload->name) : 0;
+  if (iterations == 0 || iterations > MAX_ITERATIONS) {
+    iterations = 1;
+    while (iterations < MAX_ITERATIONS && time_iterations(workload, iterations) < BENCHMARK_MIN_SAMPLE) {
+      iterations *= 2;
+    }
+  }
+  for (int i = 0; i < BENCHMARK_WARMUP; i++) {
+    time_iterations(workload, iterations);
+  }
+  for (uint32_t i = 0; i < samples; i++) {
+    per_call[i] = (double)time_iterations(workload, iterations) / iterations;
+  }
+
+  sort(per_call, (int)samples);
+  benchmark_result_t *result = &results[result_count++];
+  result->name = workload->name;
+  result->iterations = iterations;
+  result->median = per_call[samples / 2];
+  result->min = per_call[0];
+  result->max = per_call[samples - 1];
+
+  // The samples are no longer needed, so their deviations from the median replace them
+  for (uint32_t i = 0; i < samples; i++) {
+    per_call[i] = per_call[i] > result->median ? per_call[i] - result->median : result->median - per_call[i];
+  }
+  sort(per_call, (int)samples);
+  result->mad = per_call[samples / 2];
+}
+
+static uint32_t now(void)
+{
+#if defined(DWT)
+  return DWT->CYCCNT;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+static uint32_t time_iterations(const workload_t *workload, uint32_t iterations)
+{
+  uint32_t start = now();
+  for (uint32_t i = 0; i < iterations; i++) {
+    workload->run();
+  }
+  return now() - start;
+}
+
+// Insertion sort: at most a few dozen samples
+static void sort(double *values, int count)
+{
+  for (int i = 1; i < count; i++) {
+    double value = values[i];
+    int j = i - 1;
+    while (j >= 0 && values[j] > value) {
+      values[j + 1] = values[j];
+      j--;
+    }
+    values[j + 1] = value;
+  }
+}
+
+static void write_text(const char *text)
+{
+  if (config.write != NULL) {
+    config.write(text, config.context);
+    return;
+  }
+  while (*text) {
+    sl_debug_swo_write_u8(SWO_CHANNEL, (uint8_t)*text++);
+  }
+}
+
+static void write_result(const benchmark_result_t *result, bool last)
+{
+  char median[24], mad[24], min[24], max[24];
+  char line[LINE_LENGTH];
+  format_fixed(median, sizeof(median), result->median);
+  format_fixed(mad, sizeof(mad), result->mad);
+  format_fixed(min, sizeof(min), result->min);
+  format_fixed(max, sizeof(max), result->max);
+  snprintf(line, sizeof(line),
+           "    { \"name\": \"%s\", \"iterations\": %lu, \"median\": %s, \"mad\": %s, \"min\": %s, \"max\": %s }%s\n",
+           result->name, (unsigned long)result->iterations, median, mad, min, max, last ? "" : ",");
+  write_text(line);
+}
+
+// Three decimals without printf float support, which newlib-nano leaves out
+static void format_fixed(char *buffer, size_t size, double value)
+{
+  uint64_t thousandths = (uint64_t)(value * 1000.0 + 0.5);
+  snprintf(buffer, size, "%lu.%03lu", (unsigned long)(thousandths / 1000), (unsigned long)(thousandths % 1000));
+}
+
+#endif // TETRIS_BENCH
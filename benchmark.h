@@ -0,0 +1,55 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Microbenchmarks of the engine and render kernels: collision, rotation,
+// merge, line clears, hard drops, board frames and menu draws, each on fixed
+// board positions. A workload is repeated until one sample takes at least
+// BENCHMARK_MIN_SAMPLE time units, unless the configuration fixes its batch
+// size, then BENCHMARK_SAMPLES such samples are taken after a warm-up.
+// Results are per call: median, median absolute deviation, min and max over
+// the samples.
+//
+// Units are DWT cycles on target and nanoseconds on the host. Only
+// TETRIS_BENCH builds contain the suite; app_init() then runs it once before
+// the menu and writes the results as JSON to SWO.
+#define BENCHMARK_SAMPLES       31
+#define BENCHMARK_MAX_SAMPLES   63
+#define BENCHMARK_WARMUP        3
+#define BENCHMARK_MAX_RESULTS   32
+#if defined(DWT)
+#define BENCHMARK_MIN_SAMPLE    200000u   // cycles
+#define BENCHMARK_UNIT          "cycles"
+#else
+#define BENCHMARK_MIN_SAMPLE    200000u   // ns
+#define BENCHMARK_UNIT          "ns"
+#endif
+
+typedef struct {
+  const char *name;
+  uint32_t iterations;     // calls per sample
+  double median;           // per call, in BENCHMARK_UNIT
+  double mad;
+  double min;
+  double max;
+} benchmark_result_t;
+
+typedef void (*benchmark_write_fn)(const char *text, void *context);
+typedef uint32_t (*benchmark_iterations_fn)(const char *name); // 0 = calibrate
+
+typedef struct {
+  const char *filter;      // only run workloads whose name contains this; NULL runs all
+  uint32_t samples;        // 0 = BENCHMARK_SAMPLES, at most BENCHMARK_MAX_SAMPLES
+  benchmark_write_fn write; // NULL = SWO
+  benchmark_iterations_fn iterations; // calls per sample for a workload; NULL calibrates them all
+  void *context;
+} benchmark_config_t;
+
+void benchmark_configure(const benchmark_config_t *config);
+void benchmark_run(void);
+const benchmark_result_t *benchmark_get_results(size_t *count);
+void benchmark_write_results(const benchmark_result_t *results, size_t count);
+
+#endif // BENCHMARK_H
@@ -0,0 +1,149 @@
+#include "board_bits.h"
+#include <string.h>
+
+#define WALL_OFFSET     3   // lines are tested 3 bits left of the board, so a piece may hang 3 columns off either side
+#define WALL_BITS       (~((uint32_t)BOARD_BITS_FULL_ROW << WALL_OFFSET))
+#define PIVOT           2   // piece box row and column of the piece origin
+#define BOARD_PIXELS_W  (BOARD_WIDTH * BLOCK_SIZE + 2)   // border included
+#define BOARD_PIXELS_H  (BOARD_HEIGHT * BLOCK_SIZE + 2)
+
+// --- Local function prototypes ---
+static uint32_t wall_line(const board_bits_t *board, int y);
+static uint64_t expand_row(uint16_t cells);
+static void write_line(uint8_t *line, uint64_t pixels);
+
+// --- Public functions ---
+
+void board_bits_piece(const Tetromino *piece, board_bits_piece_t *out)
+{
+  memset(out, 0, sizeof(*out));
+  for (int i = 0; i < 4; i++) {
+    out->rows[piece->blocks[i].y + PIVOT] |= (uint8_t)(1u << (piece->blocks[i].x + PIVOT));
+  }
+}
+
+bool board_bits_collides(const board_bits_t *board, const board_bits_piece_t *piece, Point pos)
+{
+  // A box column c lands on line bit pos.x + c - PIVOT + WALL_OFFSET
+  int shift = pos.x - PIVOT + WALL_OFFSET;
+  if (shift < 0 || shift > 32 - BOARD_BITS_PIECE_SPAN) {
+    return true; // more than WALL_OFFSET columns off the board
+  }
+  for (int r = 0; r < BOARD_BITS_PIECE_SPAN; r++) {
+    if (piece->rows[r] != 0 && (((uint32_t)piece->rows[r] << shift) & wall_line(board, pos.y + r - PIVOT))) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Cells above the top row are dropped, as merge_tetromino() does
+void board_bits_merge(board_bits_t *board, const board_bits_piece_t *piece, Point pos)
+{
+  for (int r = 0; r < BOARD_BITS_PIECE_SPAN; r++) {
+    int y = pos.y + r - PIVOT;
+    if (piece->rows[r] == 0 || y < 0 || y >= BOARD_HEIGHT) {
+      continue;
+    }
+    int shift = pos.x - PIVOT;
+    uint32_t bits = shift >= 0 ? (uint32_t)piece->rows[r] << shift : (uint32_t)piece->rows[r] >> -shift;
+    board->rows[y] |= (uint16_t)(bits & BOARD_BITS_FULL_ROW);
+  }
+}
+
+// One bottom-up pass that keeps every row that is not full
+int board_bits_clear_lines(board_bits_t *board)
+{
+  int write = BOARD_HEIGHT - 1;
+  for (int read = BOARD_HEIGHT - 1; read >= 0; read--) {
+    if (board->rows[read] != BOARD_BITS_FULL_ROW) {
+      board->rows[write--] = board->rows[read];
+    }
+  }
+  int cleared = write + 1;
+  while (write >= 0) {
+    board->rows[write--] = 0;
+  }
+  return cleared;
+}
+
+// Rows the piece can fall before it rests on the stack or the floor
+int board_bits_drop_distance(const board_bits_t *board, const board_bits_piece_t *piece, Point pos)
+{
+  int rows = 0;
+  pos.y++;
+  while (!board_bits_collides(board, piece, pos)) {
+    rows++;
+    pos.y++;
+  }
+  return rows;
+}
+
+bool board_bits_filled(const board_bits_t *board, int x, int y)
+{
+  return x >= 0 && x < BOARD_WIDTH && y >= 0 && y < BOARD_HEIGHT && ((board->rows[y] >> x) & 1u);
+}
+
+void board_bits_render(const board_bits_t *board, const board_bits_piece_t *piece, Point pos,
+                       uint8_t *frame, int stride)
+{
+  const uint64_t full = ~0ull << (64 - BOARD_PIXELS_W);
+  const uint64_t border = (1ull << 63) | (1ull << (64 - BOARD_PIXELS_W));
+  write_line(frame, full);
+  write_line(frame + (BOARD_PIXELS_H - 1) * stride, full);
+
+  for (int y = 0; y < BOARD_HEIGHT; y++) {
+    uint16_t cells = board->rows[y];
+    int r = y - pos.y + PIVOT;
+    if (piece != NULL && r >= 0 && r < BOARD_BITS_PIECE_SPAN) {
+      int shift = pos.x - PIVOT;
+      uint32_t bits = shift >= 0 ? (uint32_t)piece->rows[r] << shift : (uint32_t)piece->rows[r] >> -shift;
+      cells |= (uint16_t)(bits & BOARD_BITS_FULL_ROW);
+    }
+    // A cell row is BLOCK_SIZE identical pixel lines
+    uint64_t pixels = border | expand_row(cells);
+    uint8_t *line = frame + (y * BLOCK_SIZE + 1) * stride;
+    for (int i = 0; i < BLOCK_SIZE; i++) {
+      write_line(line + i * stride, pixels);
+    }
+  }
+}
+
+// --- Internal Helper Functions ---
+
+static uint32_t wall_line(const board_bits_t *board, int y)
+{
+  if (y >= BOARD_HEIGHT) {
+    return UINT32_MAX; // the floor
+  }
+  if (y < 0) {
+    return WALL_BITS;  // above the board only the side walls block
+  }
+  return ((uint32_t)board->rows[y] << WALL_OFFSET) | WALL_BITS;
+}
+
+// Lines are built MSB first like the frame: pixel x is bit 63 - x
+static uint64_t expand_row(uint16_t cells)
+{
+  uint64_t pixels = 0;
+  const uint64_t block = (1ull << BLOCK_SIZE) - 1;
+  while (cells != 0) {
+    int x = __builtin_ctz(cells);
+    pixels |= block << (64 - BLOCK_SIZE - 1 - x * BLOCK_SIZE);
+    cells &= (uint16_t)(cells - 1);
+  }
+  return pixels;
+}
+
+// Writes pixels 0 to BOARD_PIXELS_W - 1; the rest of the last byte keeps its value
+static void write_line(uint8_t *line, uint64_t pixels)
+{
+  int i = 0;
+  for (; i < BOARD_PIXELS_W / 8; i++) {
+    line[i] = (uint8_t)(pixels >> (56 - 8 * i));
+  }
+#if BOARD_PIXELS_W % 8
+  const uint8_t ours = (uint8_t)(0xFFu << (8 - BOARD_PIXELS_W % 8));
+  line[i] = (uint8_t)((line[i] & ~ours) | ((uint8_t)(pixels >> (56 - 8 * i)) & ours));
+#endif
+}
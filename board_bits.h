@@ -0,0 +1,42 @@
+#ifndef BOARD_BITS_H
+#define BOARD_BITS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tetris.h"
+
+// Bitboard versions of the engine kernels: the board is one occupancy mask
+// per row (bit x set for a filled cell in column x) and a piece is up to five
+// row masks in a 5x5 box around its pivot, so collision tests a whole row of
+// the piece at once and a line clear is a single compaction pass. Cells keep
+// no color; the memory LCD draws every filled cell the same.
+//
+// These are candidates for replacing the board[][] code in tetris.c. The
+// differential harness (host/diff_harness.c) plays both in lockstep and
+// they must not be swapped in before it passes.
+#define BOARD_BITS_FULL_ROW   ((uint16_t)((1u << BOARD_WIDTH) - 1u))
+#define BOARD_BITS_PIECE_SPAN 5   // rows and columns of the box a rotated piece fits in
+
+typedef struct {
+  uint16_t rows[BOARD_HEIGHT];
+} board_bits_t;
+
+typedef struct {
+  uint8_t rows[BOARD_BITS_PIECE_SPAN]; // rows[r] is piece row r - 2, bit c is column c - 2
+} board_bits_piece_t;
+
+void board_bits_piece(const Tetromino *piece, board_bits_piece_t *out);
+bool board_bits_collides(const board_bits_t *board, const board_bits_piece_t *piece, Point pos);
+void board_bits_merge(board_bits_t *board, const board_bits_piece_t *piece, Point pos);
+int board_bits_clear_lines(board_bits_t *board);
+int board_bits_drop_distance(const board_bits_t *board, const board_bits_piece_t *piece, Point pos);
+bool board_bits_filled(const board_bits_t *board, int x, int y);
+
+// Draws the playfield as tetris_draw_board() does (border, settled cells and
+// the falling piece, or no piece when piece is NULL) into a 1bpp frame, MSB
+// first with set bits black, stride bytes per line. Pixels right of the
+// border are left alone.
+void board_bits_render(const board_bits_t *board, const board_bits_piece_t *piece, Point pos,
+                       uint8_t *frame, int stride);
+
+#endif // BOARD_BITS_H
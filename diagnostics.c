@@ -0,0 +1,78 @@
+#include "diagnostics.h"
+#include "app_events.h"
+#include "sl_sleeptimer.h"
+
+static uint32_t loops;
+static uint32_t frames;
+static uint64_t frame_ticks;
+static uint32_t frame_worst_ticks;
+static uint32_t window_start_tick;
+static app_duty_cycle_t window_start_duty;
+
+// --- Local function prototypes ---
+static uint32_t ticks_to_us(uint64_t ticks);
+static void start_window(void);
+
+// --- Public functions ---
+
+void diagnostics_init(void)
+{
+  start_window();
+}
+
+void diagnostics_on_loop(void)
+{
+  loops++;
+}
+
+// A frame runs from the start of drawing until the LCD transfer returns
+void diagnostics_on_frame(uint32_t start_tick)
+{
+  uint32_t ticks = sl_sleeptimer_get_tick_count() - start_tick;
+  frames++;
+  frame_ticks += ticks;
+  if (ticks > frame_worst_ticks) {
+    frame_worst_ticks = ticks;
+  }
+}
+
+void diagnostics_sample(diagnostics_window_t *window)
+{
+  uint32_t elapsed = sl_sleeptimer_get_tick_count() - window_start_tick;
+  uint32_t frequency = sl_sleeptimer_get_timer_frequency();
+  if (elapsed == 0) {
+    elapsed = 1;
+  }
+
+  window->window_ms = ticks_to_us(elapsed) / 1000;
+  window->frames = frames;
+  window->frame_avg_us = frames ? ticks_to_us(frame_ticks / frames) : 0;
+  window->frame_worst_us = ticks_to_us(frame_worst_ticks);
+  window->frames_per_second = (uint32_t)(((uint64_t)frames * frequency) / elapsed);
+  window->loops_per_second = (uint32_t)(((uint64_t)loops * frequency) / elapsed);
+
+  app_duty_cycle_t duty;
+  app_events_get_duty_cycle(&duty);
+  uint64_t total = duty.total_ticks - window_start_duty.total_ticks;
+  uint64_t sleep = duty.sleep_ticks - window_start_duty.sleep_ticks;
+  window->sleep_permille = total ? (uint32_t)((sleep * 1000) / total) : 0;
+
+  start_window();
+}
+
+// --- Internal Helper Functions ---
+
+static uint32_t ticks_to_us(uint64_t ticks)
+{
+  return (uint32_t)((ticks * 1000000u) / sl_sleeptimer_get_timer_frequency());
+}
+
+static void start_window(void)
+{
+  loops = 0;
+  frames = 0;
+  frame_ticks = 0;
+  frame_worst_ticks = 0;
+  window_start_tick = sl_sleeptimer_get_tick_count();
+  app_events_get_duty_cycle(&window_start_duty);
+}
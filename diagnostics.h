@@ -0,0 +1,26 @@
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+#include <stdint.h>
+
+// Live counters for the hidden diagnostics screen. The hooks are a few adds
+// each; diagnostics_sample() turns the counts since the previous sample into
+// rates, so every refresh of the screen shows one window.
+#define DIAGNOSTICS_REFRESH_MS  1000
+
+typedef struct {
+  uint32_t window_ms;
+  uint32_t frames;
+  uint32_t frame_avg_us;
+  uint32_t frame_worst_us;
+  uint32_t frames_per_second;  // LCD updates; each one sends the whole panel
+  uint32_t loops_per_second;   // main loop passes, i.e. wakeups
+  uint32_t sleep_permille;     // share of the window spent in EM2
+} diagnostics_window_t;
+
+void diagnostics_init(void);
+void diagnostics_on_loop(void);
+void diagnostics_on_frame(uint32_t start_tick);
+void diagnostics_sample(diagnostics_window_t *window);
+
+#endif // DIAGNOSTICS_H
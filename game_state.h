@@ -7,7 +7,10 @@ typedef enum {
   GAME_STATE_PAUSED,
   GAME_STATE_GAME_OVER,
   GAME_STATE_SLOT_SELECTION,
-  GAME_STATE_SCOREBOARD
+  GAME_STATE_SCOREBOARD,
+  GAME_STATE_STATS,
+  GAME_STATE_HANDLING,
+  GAME_STATE_DIAGNOSTICS
 } game_state_t;
 
 #endif // GAME_STATE_H
@@ -0,0 +1,255 @@
+#include "gravity.h"
+#include "app_events.h"
+#include "sl_sleeptimer.h"
+#include <stddef.h>
+
+#define ROW_ONE        (1ull << 32)
+#define ROW_FRACTION   (ROW_ONE - 1)
+
+#if GRAVITY_CURVE_GUIDELINE
+// (0.8 - (level - 1) * 0.007) ^ (level - 1) seconds per row, capped at 20G
+static const uint32_t guideline_curve[] = {
+  1092, 1377, 1768, 2311, 3075, 4169, 5759, 8107, 11634, 17026,
+  25416, 38709, 60169, 95483, 154742, 256187, 433425, 749597, GRAVITY_20G, GRAVITY_20G
+};
+#define GUIDELINE_LEVELS ((int)(sizeof(guideline_curve) / sizeof(guideline_curve[0])))
+#endif
+
+static uint32_t rate;             // rows per tick, 32 fractional bits
+static uint32_t row_ms;           // the same rate as a drop interval, for soft drop
+static uint64_t accumulator;      // rows owed, 32 fractional bits
+static uint64_t clock_ticks;      // game clock: ticks spent in play
+static uint32_t last_tick;
+static uint32_t due_tick;         // sleeptimer tick the gravity timer is armed for
+static bool running = false;
+static bool grounded = false;
+static uint64_t grounded_at;      // game clock when the lock delay (re)started
+static int lock_resets;
+static sl_sleeptimer_timer_handle_t gravity_timer;
+
+// --- Local function prototypes ---
+static void set_rate(int level);
+static void advance_clock(void);
+static void gravity_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+// --- Public functions ---
+
+// New game, load or resume from a checkpoint: fresh clock, fresh phase.
+void gravity_start(int level)
+{
+  set_rate(level);
+  accumulator = 0;
+  clock_ticks = 0;
+  grounded = false;
+  lock_resets = 0;
+  last_tick = gravity_now();
+  running = true;
+  gravity_schedule();
+}
+
+// Level up: the new rate applies from now, the partial row already owed is kept.
+void gravity_set_level(int level)
+{
+  advance_clock();
+  set_rate(level);
+  gravity_schedule();
+}
+
+void gravity_pause(void)
+{
+  advance_clock();
+  running = false;
+  sl_sleeptimer_stop_timer(&gravity_timer);
+}
+
+void gravity_resume(void)
+{
+  last_tick = gravity_now();
+  running = true;
+  gravity_schedule();
+}
+
+void gravity_stop(void)
+{
+  running = false;
+  sl_sleeptimer_stop_timer(&gravity_timer);
+}
+
+void gravity_on_spawn(void)
+{
+  advance_clock();
+  accumulator = 0;
+  grounded = false;
+  lock_resets = 0;
+}
+
+// Whole rows the piece should fall now; the fraction stays in the accumulator.
+uint32_t gravity_take_rows(void)
+{
+  advance_clock();
+  uint64_t rows = accumulator >> 32;
+  accumulator &= ROW_FRACTION;
+  return rows > UINT32_MAX ? UINT32_MAX : (uint32_t)rows;
+}
+
+// Gravity does not accumulate while the piece rests on the stack.
+void gravity_set_grounded(bool is_grounded)
+{
+  advance_clock();
+  if (is_grounded && !grounded) {
+    grounded_at = clock_ticks;
+  }
+  grounded = is_grounded;
+}
+
+// A successful move or rotation on the ground restarts the lock delay, a limited number of times.
+void gravity_on_piece_moved(void)
+{
+  if (grounded && lock_resets < GRAVITY_MAX_LOCK_RESETS) {
+    advance_clock();
+    grounded_at = clock_ticks;
+    lock_resets++;
+  }
+}
+
+bool gravity_lock_due(void)
+{
+  advance_clock();
+  return grounded && clock_ticks - grounded_at >= sl_sleeptimer_ms_to_tick(GRAVITY_LOCK_DELAY_MS);
+}
+
+// Arms the timer for the next row, or for the lock deadline while grounded.
+void gravity_schedule(void)
+{
+  sl_sleeptimer_stop_timer(&gravity_timer);
+  if (!running) {
+    return;
+  }
+  advance_clock();
+
+  uint64_t wait;
+  if (grounded) {
+    uint64_t deadline = grounded_at + sl_sleeptimer_ms_to_tick(GRAVITY_LOCK_DELAY_MS);
+    wait = deadline > clock_ticks ? deadline - clock_ticks : 1;
+  } else if (accumulator >= ROW_ONE) {
+    wait = 1;
+  } else {
+    wait = (ROW_ONE - accumulator + rate - 1) / rate;
+    uint32_t frame = sl_sleeptimer_ms_to_tick(GRAVITY_FRAME_MS);
+    if (wait < frame) {
+      wait = frame;
+    }
+  }
+  wait = (wait + GRAVITY_TICK_STEP - 1) & ~(uint64_t)(GRAVITY_TICK_STEP - 1);
+  if (wait > UINT32_MAX - GRAVITY_TICK_STEP) {
+    wait = UINT32_MAX - GRAVITY_TICK_STEP;
+  }
+  due_tick = last_tick + (uint32_t)wait;
+  // The clock may be part way into the step last_tick stands for: arm for the deadline itself
+  sl_sleeptimer_start_timer(&gravity_timer, due_tick - sl_sleeptimer_get_tick_count(),
+                            gravity_timer_callback, NULL, 0, 0);
+}
+
+uint32_t gravity_get_row_ms(void)
+{
+  return row_ms;
+}
+
+uint64_t gravity_get_clock_ticks(void)
+{
+  advance_clock();
+  return clock_ticks;
+}
+
+uint32_t gravity_get_due_tick(void)
+{
+  return due_tick;
+}
+
+uint32_t gravity_now(void)
+{
+  return sl_sleeptimer_get_tick_count() & ~(uint32_t)(GRAVITY_TICK_STEP - 1);
+}
+
+void gravity_save(gravity_state_t *state)
+{
+  advance_clock();
+  state->accumulator = accumulator;
+  state->clock_ticks = clock_ticks;
+  state->grounded_for = (uint32_t)(clock_ticks - grounded_at);
+  state->due_in = running ? due_tick - last_tick : 0;
+  state->lock_resets = (uint8_t)lock_resets;
+  state->running = running;
+  state->grounded = grounded;
+}
+
+// Picks up at the current tick; the timer is re-armed for the saved deadline
+// rather than rescheduled, since a deadline computed now could round differently.
+void gravity_restore(const gravity_state_t *state, int level)
+{
+  sl_sleeptimer_stop_timer(&gravity_timer);
+  set_rate(level);
+  accumulator = state->accumulator;
+  clock_ticks = state->clock_ticks;
+  grounded_at = state->clock_ticks - state->grounded_for;
+  lock_resets = state->lock_resets;
+  grounded = state->grounded;
+  running = state->running;
+  last_tick = gravity_now();
+  if (running) {
+    due_tick = last_tick + state->due_in;
+    int32_t wait = (int32_t)(due_tick - sl_sleeptimer_get_tick_count());
+    sl_sleeptimer_start_timer(&gravity_timer, wait > 0 ? (uint32_t)wait : 1, // already overdue: fire right away
+                              gravity_timer_callback, NULL, 0, 0);
+  }
+}
+
+// --- Internal Helper Functions ---
+
+static void set_rate(int level)
+{
+  if (level < 1) {
+    level = 1;
+  }
+  uint32_t frequency = sl_sleeptimer_get_timer_frequency();
+#if GRAVITY_CURVE_GUIDELINE
+  uint32_t g = guideline_curve[(level > GUIDELINE_LEVELS ? GUIDELINE_LEVELS : level) - 1];
+  // rows per tick = (g / 65536) rows per frame * 60 frames per second / ticks per second
+  rate = (uint32_t)(((uint64_t)g * 65536u * 60u) / frequency);
+  row_ms = (uint32_t)((65536ull * 1000u) / (60ull * g));
+#else
+  int ms = 500 - ((level - 1) * 50);
+  if (ms < 50) {
+    ms = 50;
+  }
+  rate = (uint32_t)((ROW_ONE * 1000u) / ((uint64_t)ms * frequency));
+  row_ms = (uint32_t)ms;
+#endif
+  if (rate == 0) {
+    rate = 1;
+  }
+  if (row_ms == 0) {
+    row_ms = 1;
+  }
+}
+
+static void advance_clock(void)
+{
+  if (!running) {
+    return;
+  }
+  uint32_t now = gravity_now();
+  uint32_t elapsed = now - last_tick;
+  last_tick = now;
+  clock_ticks += elapsed;
+  if (!grounded) {
+    accumulator += (uint64_t)rate * elapsed;
+  }
+}
+
+static void gravity_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  app_events_post(APP_EVENT_GRAVITY);
+}
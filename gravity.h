@@ -0,0 +1,60 @@
+#ifndef GRAVITY_H
+#define GRAVITY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Gravity and lock-delay scheduling on a game clock that only runs while the
+// game is in play. Gravity is a fixed-point rate (rows per sleeptimer tick),
+// and the fraction of a row left over is carried in an accumulator. Level
+// changes, pauses and resumes therefore never reset the drop phase.
+//
+// Levels follow the original 500 ms - 50 ms per level curve by default; build
+// with GRAVITY_CURVE_GUIDELINE=1 for the guideline curve, which reaches 20G.
+#ifndef GRAVITY_CURVE_GUIDELINE
+#define GRAVITY_CURVE_GUIDELINE 0
+#endif
+
+#define GRAVITY_LOCK_DELAY_MS     500
+#define GRAVITY_MAX_LOCK_RESETS   15  // moves that may restart the lock delay per piece
+#define GRAVITY_FRAME_MS          16  // shortest wakeup interval; faster gravity drops several rows per wakeup
+// The game clock moves in steps of this many sleeptimer ticks (1/1024 s at
+// 32768 Hz, a power of two): every time the game acts on lies on a step, so
+// recordings store times in steps and still replay exactly.
+#define GRAVITY_TICK_STEP         32
+
+// G: rows per 60 Hz frame, Q16.16
+#define GRAVITY_G(rows_per_frame) ((uint32_t)((rows_per_frame) * 65536.0 + 0.5))
+#define GRAVITY_20G               GRAVITY_G(20)
+
+// Everything gravity needs to carry on from a point in play as if it had never
+// stopped: the drop phase, the lock delay and the deadline the timer is armed for.
+typedef struct {
+  uint64_t accumulator;
+  uint64_t clock_ticks;
+  uint32_t grounded_for;  // game clock ticks since the lock delay (re)started
+  uint32_t due_in;        // ticks from the save to the armed deadline
+  uint8_t lock_resets;
+  bool running;
+  bool grounded;
+} gravity_state_t;
+
+void gravity_start(int level);
+void gravity_set_level(int level);
+void gravity_pause(void);
+void gravity_resume(void);
+void gravity_stop(void);
+void gravity_on_spawn(void);
+uint32_t gravity_take_rows(void);
+void gravity_set_grounded(bool grounded);
+void gravity_on_piece_moved(void);
+bool gravity_lock_due(void);
+void gravity_schedule(void);
+uint32_t gravity_get_row_ms(void);
+uint64_t gravity_get_clock_ticks(void);
+uint32_t gravity_get_due_tick(void); // when the armed timer fires, in sleeptimer ticks
+uint32_t gravity_now(void);          // the sleeptimer tick count, rounded down to a step
+void gravity_save(gravity_state_t *state);
+void gravity_restore(const gravity_state_t *state, int level);
+
+#endif // GRAVITY_H
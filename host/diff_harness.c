@@ -0,0 +1,789 @@
+// Differential harness: plays the engine in tetris.c (the reference, with its
+// board[][] kernels) and a candidate built on the bitboard kernels in
+// board_bits.c in lockstep, and compares them after every input: game over,
+// score, lines, level, current and next piece, piece position and rotation,
+// board occupancy, and the playfield pixels of the frame tetris_draw_board()
+// pushes against board_bits_render().
+//
+// Cases come from a seeded generator, from a replayable case file (-r) or from
+// libFuzzer (build with -DDIFF_FUZZER). A divergence is shrunk with delta
+// debugging (ddmin) to a short case file that reproduces it. The run also
+// reports the time per input and per playfield drawing of both sides.
+//
+// The candidate keeps occupancy only: cell colors are not compared. Inputs
+// are the player's (shift, rotate, soft drop, hard drop); gravity and lock
+// delay are timer driven and not exercised here.
+
+#include "tetris.h"
+#include "board_bits.h"
+#include "app_events.h"
+#include "trace.h"
+#include "latency.h"
+#include "diagnostics.h"
+#include "nvm3_host.h"
+#include "glib_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_CASES       2000
+#define DEFAULT_STEPS       400
+#define MAX_STEPS           4096
+#define MAX_CASE_LINE       128
+#define MAX_GARBAGE_HEIGHT  12
+#define SPAWN_X             (BOARD_WIDTH / 2 - 1)
+#define COLOR_T             3
+#define COLOR_O             2
+
+typedef struct {
+  uint32_t seed;
+  int level;
+  bool garbage;                   // start from rows[] and piece instead of an empty board
+  int piece;
+  uint16_t rows[BOARD_HEIGHT];
+  size_t count;
+  char ops[MAX_STEPS];            // L, R, U (rotate), D (soft drop), H (hard drop)
+} diff_case_t;
+
+// The candidate engine: the rules of tetris.c on the bitboard kernels
+typedef struct {
+  board_bits_t board;
+  Tetromino piece;
+  board_bits_piece_t mask;
+  Point pos;
+  int next;
+  int32_t score;
+  int lines;
+  int level;
+  bool last_move_was_rotation;
+  bool game_over;
+  uint32_t rng;
+} candidate_t;
+
+typedef struct {
+  uint64_t reference_ns;
+  uint64_t candidate_ns;
+  uint64_t count;
+} timing_t;
+
+// tetris.c's spawn orientations, indexed by color - 1
+static const Tetromino shapes[7] = {
+  { { {-1, 0}, {0, 0}, {1, 0}, {2, 0} }, 1 },
+  { { {0, 0}, {1, 0}, {0, 1}, {1, 1} }, 2 },
+  { { {-1, 0}, {0, 0}, {1, 0}, {0, 1} }, 3 },
+  { { {1, -1}, {-1, 0}, {0, 0}, {1, 0} }, 4 },
+  { { {-1, -1}, {-1, 0}, {0, 0}, {1, 0} }, 5 },
+  { { {0, 0}, {1, 0}, {-1, 1}, {0, 1} }, 6 },
+  { { {-1, 0}, {0, 0}, {0, 1}, {1, 1} }, 7 },
+};
+
+static const char op_letters[] = "LRUDH";
+
+static candidate_t cand;
+static uint8_t cand_frame[GLIB_HOST_FRAME_BYTES];
+static char divergence[160];
+static timing_t step_timing;
+static timing_t frame_timing;
+static bool timing_enabled;
+static bool render_enabled = true;
+
+// --- Candidate engine ---
+
+static uint32_t cand_random(void)
+{
+  cand.rng ^= cand.rng << 13;
+  cand.rng ^= cand.rng >> 17;
+  cand.rng ^= cand.rng << 5;
+  return cand.rng;
+}
+
+static void cand_set_piece(const Tetromino *piece)
+{
+  cand.piece = *piece;
+  board_bits_piece(piece, &cand.mask);
+}
+
+static void cand_spawn(void)
+{
+  cand_set_piece(&shapes[cand.next - 1]);
+  cand.next = (int)(cand_random() % 7) + 1;
+  cand.pos = (Point){ SPAWN_X, 0 };
+}
+
+static void cand_start(const diff_case_t *c)
+{
+  memset(&cand, 0, sizeof(cand));
+  cand.rng = c->seed != 0 ? c->seed : TETRIS_DEFAULT_SEED;
+  cand.level = c->level;
+  cand.next = (int)(cand_random() % 7) + 1;
+  cand_spawn();
+  if (c->garbage) {
+    // As tetris_bench_load(): level 1, a T next, the random sequence untouched
+    memcpy(cand.board.rows, c->rows, sizeof(cand.board.rows));
+    cand_set_piece(&shapes[c->piece - 1]);
+    cand.next = COLOR_T;
+    cand.level = 1;
+  }
+}
+
+static void cand_clear_and_score(bool is_t_spin)
+{
+  int cleared = board_bits_clear_lines(&cand.board);
+  if (cleared > 0) {
+    static const int32_t line_points[] = { 0, 100, 300, 500, 800 };
+    static const int32_t t_spin_points[] = { 0, 800, 1200, 1600, 0 };
+    cand.lines += cleared;
+    cand.score += (is_t_spin ? t_spin_points[cleared] : line_points[cleared]) * cand.level;
+    int new_level = cand.lines / 10 + 1;
+    if (new_level > cand.level) {
+      cand.level = new_level;
+    }
+  } else if (is_t_spin) {
+    cand.score += 400 * cand.level;
+  }
+}
+
+static void cand_lock(bool is_t_spin)
+{
+  board_bits_merge(&cand.board, &cand.mask, cand.pos);
+  cand_clear_and_score(is_t_spin);
+  cand_spawn();
+  if (board_bits_collides(&cand.board, &cand.mask, cand.pos)) {
+    cand.game_over = true;
+  }
+}
+
+static void cand_lock_current(void)
+{
+  bool is_t_spin = false;
+  if (cand.piece.color == COLOR_T && cand.last_move_was_rotation) {
+    int x = cand.pos.x;
+    int y = cand.pos.y;
+    int corners = board_bits_filled(&cand.board, x - 1, y - 1) + board_bits_filled(&cand.board, x + 1, y - 1)
+                  + board_bits_filled(&cand.board, x - 1, y + 1) + board_bits_filled(&cand.board, x + 1, y + 1);
+    is_t_spin = corners >= 3;
+  }
+  cand_lock(is_t_spin);
+}
+
+static void cand_step(char op)
+{
+  if (cand.game_over) {
+    return;
+  }
+  Point next = cand.pos;
+  switch (op) {
+    case 'L':
+    case 'R':
+      next.x += op == 'L' ? -1 : 1;
+      if (!board_bits_collides(&cand.board, &cand.mask, next)) {
+        cand.pos = next;
+        cand.last_move_was_rotation = false;
+      }
+      break;
+    case 'U':
+      if (cand.piece.color != COLOR_O) {
+        Tetromino rotated = cand.piece;
+        for (int i = 0; i < 4; i++) {
+          rotated.blocks[i].x = -cand.piece.blocks[i].y;
+          rotated.blocks[i].y = cand.piece.blocks[i].x;
+        }
+        board_bits_piece_t mask;
+        board_bits_piece(&rotated, &mask);
+        if (!board_bits_collides(&cand.board, &mask, cand.pos)) {
+          cand.piece = rotated;
+          cand.mask = mask;
+          cand.last_move_was_rotation = true;
+        }
+      }
+      break;
+    case 'D':
+      next.y++;
+      if (board_bits_collides(&cand.board, &cand.mask, next)) {
+        cand_lock_current();
+      } else {
+        cand.pos = next;
+      }
+      cand.last_move_was_rotation = false;
+      break;
+    case 'H':
+      // tetris_hard_drop() scores the resting row too
+      if (!board_bits_collides(&cand.board, &cand.mask, cand.pos)) {
+        int rows = board_bits_drop_distance(&cand.board, &cand.mask, cand.pos);
+        cand.pos.y += rows;
+        cand.score += (rows + 1) * 2;
+      }
+      cand_lock(false);
+      break;
+  }
+}
+
+// --- Reference engine ---
+
+static void ref_start(const diff_case_t *c)
+{
+  tetris_start_seeded_game(c->level, c->seed);
+  if (c->garbage) {
+    tetris_bench_load(c->rows, c->piece, SPAWN_X, 0);
+  }
+}
+
+static void ref_step(char op)
+{
+  switch (op) {
+    case 'L': tetris_move_left(); break;
+    case 'R': tetris_move_right(); break;
+    case 'U': tetris_rotate(); break;
+    case 'D': tetris_move_down(); break;
+    case 'H': tetris_hard_drop(); break;
+  }
+}
+
+// Drops whatever the last case left queued in the storage modules
+static void ref_settle(void)
+{
+  tetris_set_game_state(GAME_STATE_MAIN_MENU);
+  app_events_take();
+  tetris_process_action();
+}
+
+// --- Comparison ---
+
+static uint64_t wall_ns(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static bool compare_frames(void)
+{
+  tetris_draw_board();
+  const uint8_t *frame = glib_host_frame();
+  memcpy(cand_frame, frame, sizeof(cand_frame));
+  uint64_t render_start = wall_ns();
+  board_bits_render(&cand.board, &cand.mask, cand.pos, cand_frame, GLIB_HOST_LINE_BYTES);
+  uint64_t render_end = wall_ns();
+  if (timing_enabled) {
+    // Time the same region on the reference side: its playfield calls only,
+    // into the cleared GLIB buffer, without the side panel or the LCD push
+    GLIB_clear(tetris_get_glib_context());
+    uint64_t start = wall_ns();
+    tetris_bench_draw_playfield();
+    frame_timing.reference_ns += wall_ns() - start;
+    frame_timing.candidate_ns += render_end - render_start;
+    frame_timing.count++;
+  }
+
+  for (int i = 0; i < GLIB_HOST_FRAME_BYTES; i++) {
+    if (frame[i] != cand_frame[i]) {
+      uint8_t diff = frame[i] ^ cand_frame[i];
+      int bit = __builtin_clz((unsigned)diff) - 24;
+      int x = (i % GLIB_HOST_LINE_BYTES) * 8 + bit;
+      int y = i / GLIB_HOST_LINE_BYTES;
+      snprintf(divergence, sizeof(divergence), "pixel (%d,%d) is %s in the reference frame",
+               x, y, (frame[i] << bit) & 0x80 ? "black" : "white");
+      return false;
+    }
+  }
+  return true;
+}
+
+// Fills divergence[] and returns false when the engines disagree
+static bool compare(void)
+{
+  bool ref_over = tetris_get_game_state() == GAME_STATE_GAME_OVER;
+  if (ref_over != cand.game_over) {
+    snprintf(divergence, sizeof(divergence), "game over: reference %d, candidate %d", ref_over, cand.game_over);
+    return false;
+  }
+  tetris_snapshot_t snap;
+  tetris_snapshot_take(&snap);
+  if (snap.score != cand.score || snap.lines_cleared != cand.lines || snap.level != cand.level) {
+    snprintf(divergence, sizeof(divergence), "score/lines/level: reference %ld/%u/%u, candidate %ld/%d/%d",
+             (long)snap.score, snap.lines_cleared, snap.level, (long)cand.score, cand.lines, cand.level);
+    return false;
+  }
+  if (snap.current_piece != cand.piece.color || snap.next_piece != cand.next) {
+    snprintf(divergence, sizeof(divergence), "pieces: reference %u next %u, candidate %d next %d",
+             snap.current_piece, snap.next_piece, cand.piece.color, cand.next);
+    return false;
+  }
+  for (int x = 0; x < BOARD_WIDTH; x++) {
+    for (int y = 0; y < BOARD_HEIGHT; y++) {
+      int index = x * BOARD_HEIGHT + y;
+      bool filled = ((index & 1) ? (snap.cells[index / 2] >> 4) : (snap.cells[index / 2] & 0x0F)) != 0;
+      if (filled != board_bits_filled(&cand.board, x, y)) {
+        snprintf(divergence, sizeof(divergence), "cell (%d,%d) is %s in the reference", x, y, filled ? "filled" : "empty");
+        return false;
+      }
+    }
+  }
+  Tetromino piece;
+  Point pos;
+  tetris_bench_get_piece(&piece, &pos);
+  if (pos.x != cand.pos.x || pos.y != cand.pos.y || memcmp(piece.blocks, cand.piece.blocks, sizeof(piece.blocks)) != 0) {
+    snprintf(divergence, sizeof(divergence), "piece at (%d,%d) in the reference, (%d,%d) in the candidate, or rotated differently",
+             pos.x, pos.y, cand.pos.x, cand.pos.y);
+    return false;
+  }
+  return ref_over || !render_enabled || compare_frames();
+}
+
+// Returns the index of the first input after which the engines disagree, or
+// -1 (0 is the start position, input i is step i + 1)
+static long run_case(const diff_case_t *c, bool verbose)
+{
+  ref_start(c);
+  cand_start(c);
+  long result = -1;
+  if (!compare()) {
+    result = 0;
+  }
+  for (size_t i = 0; result < 0 && i < c->count; i++) {
+    uint64_t start = wall_ns();
+    ref_step(c->ops[i]);
+    uint64_t middle = wall_ns();
+    cand_step(c->ops[i]);
+    uint64_t end = wall_ns();
+    if (timing_enabled) {
+      step_timing.reference_ns += middle - start;
+      step_timing.candidate_ns += end - middle;
+      step_timing.count++;
+    }
+    if (verbose) {
+      printf("%4zu %c  score %ld lines %d level %d piece %d at (%d,%d)%s\n", i, c->ops[i], (long)cand.score,
+             cand.lines, cand.level, cand.piece.color, cand.pos.x, cand.pos.y, cand.game_over ? " game over" : "");
+    }
+    if (!compare()) {
+      result = (long)i + 1;
+    }
+    if (cand.game_over && result < 0) {
+      break; // neither engine takes input any more
+    }
+  }
+  ref_settle();
+  return result;
+}
+
+// --- Cases ---
+
+#if !defined(DIFF_FUZZER)
+
+static uint32_t harness_seed = 1;
+
+static uint32_t harness_random(uint32_t bound)
+{
+  harness_seed ^= harness_seed << 13;
+  harness_seed ^= harness_seed >> 17;
+  harness_seed ^= harness_seed << 5;
+  return harness_seed % bound;
+}
+
+static void push_ops(diff_case_t *c, char op, int count)
+{
+  for (; count > 0 && c->count < MAX_STEPS; count--) {
+    c->ops[c->count++] = op;
+  }
+}
+
+// Carves a T-slot with an overhang into the top three garbage rows and starts
+// the inputs with the T entering it sideways and turning into place, so the
+// T-spin corner check and its scoring run on almost every such case
+static void add_t_slot(diff_case_t *c, int top)
+{
+  int slot = 1 + (int)harness_random(BOARD_WIDTH - 2);
+  c->rows[top] = (uint16_t)((c->rows[top] | (1u << (slot + 1))) & ~(3u << (slot - 1)));
+  c->rows[top + 1] = (uint16_t)(BOARD_BITS_FULL_ROW & ~(7u << (slot - 1)));
+  c->rows[top + 2] = (uint16_t)(BOARD_BITS_FULL_ROW & ~(1u << slot));
+  // An extra hole in a row keeps the T from completing it: double, single or mini
+  int lines = (int)harness_random(3);
+  int hole = (slot + 2 + (int)harness_random(BOARD_WIDTH - 3)) % BOARD_WIDTH;  // outside slot - 1 .. slot + 1
+  if (lines < 2) {
+    c->rows[top + 2] &= (uint16_t)~(1u << hole);
+  }
+  if (lines < 1) {
+    c->rows[top + 1] &= (uint16_t)~(1u << hole);
+  }
+  c->piece = COLOR_T;
+  push_ops(c, 'U', 1);                                    // stem pointing left
+  push_ops(c, slot < SPAWN_X ? 'L' : 'R', abs(slot - SPAWN_X));
+  push_ops(c, 'D', top + 1);                              // rests in the slot
+  push_ops(c, 'U', 3);                                    // stem down, under the overhang
+  push_ops(c, 'D', 1);                                    // locks right after the rotation
+}
+
+static void random_case(diff_case_t *c, size_t steps)
+{
+  memset(c, 0, sizeof(*c));
+  c->seed = harness_random(UINT32_MAX);
+  c->level = 1 + (int)harness_random(15);
+  c->garbage = harness_random(2) == 0;
+  if (c->garbage) {
+    c->piece = 1 + (int)harness_random(7);
+    int height = (int)harness_random(MAX_GARBAGE_HEIGHT + 1);
+    for (int y = BOARD_HEIGHT - height; y < BOARD_HEIGHT; y++) {
+      // Mostly one or two holes per row, now and then a full row waiting to clear
+      uint16_t row = BOARD_BITS_FULL_ROW;
+      if (harness_random(10) != 0) {
+        row &= (uint16_t)~(1u << harness_random(BOARD_WIDTH));
+        row &= (uint16_t)~(harness_random(2) << harness_random(BOARD_WIDTH));
+      }
+      c->rows[y] = row;
+    }
+    if (height >= 3 && harness_random(2) == 0) {
+      add_t_slot(c, BOARD_HEIGHT - height);
+    }
+  }
+  // Weighted towards moves so pieces travel before they lock; soft drops
+  // come in runs, which often land the piece
+  static const char weighted[] = "LLLLRRRRUUUUDDDDHH";
+  while (c->count < steps) {
+    char op = weighted[harness_random(sizeof(weighted) - 1)];
+    int run = op == 'D' ? 1 + (int)harness_random(BOARD_HEIGHT) : 1;
+    push_ops(c, op, run < (int)(steps - c->count) ? run : (int)(steps - c->count));
+  }
+}
+
+#endif // !DIFF_FUZZER
+
+// libFuzzer input: seed (4 bytes, little endian), level, flags (bit 0: a
+// preloaded board, bits 1-7: its piece), the board as 2 bytes per row when
+// preloaded, then one input per byte
+static void decode_case(const uint8_t *data, size_t size, diff_case_t *c)
+{
+  memset(c, 0, sizeof(*c));
+  if (size < 6) {
+    c->seed = TETRIS_DEFAULT_SEED;
+    c->level = 1;
+    return;
+  }
+  c->seed = (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+  c->level = 1 + data[4] % 15;
+  c->garbage = (data[5] & 1) != 0;
+  c->piece = 1 + (data[5] >> 1) % 7;
+  size_t offset = 6;
+  if (c->garbage) {
+    for (int y = 0; y < BOARD_HEIGHT && offset + 1 < size; y++, offset += 2) {
+      c->rows[y] = (uint16_t)(data[offset] | data[offset + 1] << 8) & BOARD_BITS_FULL_ROW;
+    }
+  }
+  for (; offset < size && c->count < MAX_STEPS; offset++) {
+    c->ops[c->count++] = op_letters[data[offset] % 5];
+  }
+}
+
+#if !defined(DIFF_FUZZER)
+
+static bool diverges(const diff_case_t *c)
+{
+  return run_case(c, false) >= 0;
+}
+
+// Delta debugging: drop ever smaller chunks of inputs while the case still
+// diverges, then try without the preloaded board and row by row without it
+static void minimize(diff_case_t *c)
+{
+  static diff_case_t trial;
+  size_t chunks = 2;
+  while (c->count >= 2) {
+    size_t chunk = (c->count + chunks - 1) / chunks;
+    bool reduced = false;
+    for (size_t start = 0; start < c->count && !reduced; start += chunk) {
+      size_t end = start + chunk < c->count ? start + chunk : c->count;
+      trial = *c;
+      memmove(&trial.ops[start], &c->ops[end], c->count - end);
+      trial.count = c->count - (end - start);
+      if (diverges(&trial)) {
+        *c = trial;
+        chunks = chunks > 2 ? chunks - 1 : 2;
+        reduced = true;
+      }
+    }
+    if (!reduced) {
+      if (chunks >= c->count) {
+        break;
+      }
+      chunks = chunks * 2 < c->count ? chunks * 2 : c->count;
+    }
+  }
+  if (c->count == 1) {
+    trial = *c;
+    trial.count = 0;
+    if (diverges(&trial)) {
+      *c = trial;
+    }
+  }
+
+  if (c->garbage) {
+    trial = *c;
+    trial.garbage = false;
+    if (diverges(&trial)) {
+      *c = trial;
+      return;
+    }
+    for (int y = 0; y < BOARD_HEIGHT; y++) {
+      if (c->rows[y] != 0) {
+        trial = *c;
+        trial.rows[y] = 0;
+        if (diverges(&trial)) {
+          *c = trial;
+        }
+      }
+    }
+  }
+}
+
+static bool write_case(const char *path, const diff_case_t *c)
+{
+  FILE *file = fopen(path, "w");
+  if (file == NULL) {
+    perror(path);
+    return false;
+  }
+  fprintf(file, "# diff_harness: %s\n", divergence);
+  fprintf(file, "seed %u\nlevel %d\n", (unsigned)c->seed, c->level);
+  if (c->garbage) {
+    fprintf(file, "piece %d\n", c->piece);
+    for (int y = 0; y < BOARD_HEIGHT; y++) {
+      if (c->rows[y] != 0) {
+        fprintf(file, "row %d 0x%03x\n", y, c->rows[y]);
+      }
+    }
+  }
+  for (size_t i = 0; i < c->count; i++) {
+    fprintf(file, "%zu %c\n", i, c->ops[i]);
+  }
+  fclose(file);
+  return true;
+}
+
+// Case files use the replay corpus input letters; the first column only orders the lines
+static bool read_case(const char *path, diff_case_t *c)
+{
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    return false;
+  }
+  memset(c, 0, sizeof(*c));
+  c->seed = TETRIS_DEFAULT_SEED;
+  c->level = 1;
+  c->piece = 1;
+
+  char line[MAX_CASE_LINE];
+  int line_number = 0;
+  bool ok = true;
+  while (ok && fgets(line, sizeof(line), file) != NULL) {
+    line_number++;
+    char *comment = strchr(line, '#');
+    if (comment != NULL) {
+      *comment = '\0';
+    }
+    char word[16];
+    unsigned long value;
+    unsigned long mask;
+    char op;
+    if (sscanf(line, " %15s", word) != 1) {
+      continue;
+    }
+    if (sscanf(line, " seed %lu", &value) == 1) {
+      c->seed = (uint32_t)value;
+    } else if (sscanf(line, " level %lu", &value) == 1) {
+      c->level = (int)value;
+    } else if (sscanf(line, " piece %lu", &value) == 1 && value >= 1 && value <= 7) {
+      c->garbage = true;
+      c->piece = (int)value;
+    } else if (sscanf(line, " row %lu %lx", &value, &mask) == 2 && value < BOARD_HEIGHT) {
+      c->garbage = true;
+      c->rows[value] = (uint16_t)(mask & BOARD_BITS_FULL_ROW);
+    } else if (sscanf(line, " %lu %c", &value, &op) == 2 && strchr(op_letters, op) != NULL && c->count < MAX_STEPS) {
+      c->ops[c->count++] = op;
+    } else {
+      fprintf(stderr, "%s:%d: cannot parse: %s", path, line_number, line);
+      ok = false;
+    }
+  }
+  fclose(file);
+  return ok;
+}
+
+#endif // !DIFF_FUZZER
+
+static void init_engine(void)
+{
+  nvm3_host_config_t nvm;
+  nvm3_host_default_config(&nvm);
+  nvm3_host_configure(&nvm);
+  glib_host_config_t render = { 0 };
+  glib_host_configure(&render);
+  trace_init();
+  latency_init();
+  app_events_init();
+  diagnostics_init();
+  tetris_init();
+}
+
+#if defined(DIFF_FUZZER)
+
+// clang -fsanitize=fuzzer,address -DDIFF_FUZZER -DTETRIS_BENCH=1 ...; a
+// divergence aborts, and the saved crash input converts to a minimized case
+// file with the normal build's -x option
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  static bool initialized;
+  static diff_case_t c;
+  if (!initialized) {
+    init_engine();
+    initialized = true;
+  }
+  decode_case(data, size, &c);
+  long step = run_case(&c, false);
+  if (step >= 0) {
+    fprintf(stderr, "diff_harness: divergence after input %ld: %s\n", step, divergence);
+    abort();
+  }
+  return 0;
+}
+
+#else
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr,
+          "usage: %s [-n cases] [-k steps] [-s seed] [-o out] [-q]\n"
+          "       %s -r case-file | -x fuzzer-input [-o out]\n"
+          "  -n  random cases to run (default %d)\n"
+          "  -k  inputs per case (default %d, at most %d)\n"
+          "  -s  generator seed (default 1)\n"
+          "  -o  where to write a minimized divergence (default divergence.txt)\n"
+          "  -q  compare state only, not frames\n"
+          "  -r  replay a case file step by step\n"
+          "  -x  minimize a libFuzzer crash input into a case file\n",
+          argv0, argv0, DEFAULT_CASES, DEFAULT_STEPS, MAX_STEPS);
+}
+
+static void print_timing(const char *what, const timing_t *t, const char *note)
+{
+  if (t->count == 0) {
+    return;
+  }
+  double reference = (double)t->reference_ns / t->count;
+  double candidate = (double)t->candidate_ns / t->count;
+  printf("%-9s reference %9.1f ns  candidate %9.1f ns  %5.2fx  (%llu samples; %s)\n", what, reference, candidate,
+         candidate > 0 ? reference / candidate : 0.0, (unsigned long long)t->count, note);
+}
+
+static int report_divergence(diff_case_t *c, long step, const char *out_path)
+{
+  printf("divergence after input %ld of %zu: %s\n", step, c->count, divergence);
+  c->count = (size_t)step;
+  timing_enabled = false;
+  minimize(c);
+  step = run_case(c, false); // leaves the message of the minimized case in divergence[]
+  if (!write_case(out_path, c)) {
+    return 1;
+  }
+  printf("minimized to %zu inputs%s: %s\n", c->count, c->garbage ? " on a preloaded board" : "", out_path);
+  return 1;
+}
+
+int main(int argc, char **argv)
+{
+  static diff_case_t c;
+  uint32_t cases = DEFAULT_CASES;
+  size_t steps = DEFAULT_STEPS;
+  const char *out_path = "divergence.txt";
+  const char *replay_path = NULL;
+  const char *fuzz_path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      cases = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+      steps = strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      harness_seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      replay_path = argv[++i];
+    } else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc) {
+      fuzz_path = argv[++i];
+    } else if (strcmp(argv[i], "-q") == 0) {
+      render_enabled = false;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (steps == 0 || steps > MAX_STEPS || harness_seed == 0) {
+    usage(argv[0]);
+    return 2;
+  }
+  init_engine();
+
+  if (replay_path != NULL) {
+    if (!read_case(replay_path, &c)) {
+      return 1;
+    }
+    long step = run_case(&c, true);
+    if (step >= 0) {
+      printf("divergence after input %ld: %s\n", step, divergence);
+      return 1;
+    }
+    printf("%s: engines agree over %zu inputs\n", replay_path, c.count);
+    return 0;
+  }
+
+  if (fuzz_path != NULL) {
+    FILE *file = fopen(fuzz_path, "rb");
+    if (file == NULL) {
+      perror(fuzz_path);
+      return 1;
+    }
+    static uint8_t data[6 + 2 * BOARD_HEIGHT + MAX_STEPS];
+    size_t size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+    decode_case(data, size, &c);
+    long step = run_case(&c, false);
+    if (step < 0) {
+      printf("%s: engines agree over %zu inputs\n", fuzz_path, c.count);
+      return 0;
+    }
+    return report_divergence(&c, step, out_path);
+  }
+
+  uint32_t first_seed = harness_seed;
+  uint64_t inputs = 0;
+  timing_enabled = true;
+  for (uint32_t n = 0; n < cases; n++) {
+    random_case(&c, steps);
+    long step = run_case(&c, false);
+    if (step >= 0) {
+      printf("case %u (seed %u, level %d%s)\n", n, (unsigned)c.seed, c.level, c.garbage ? ", preloaded board" : "");
+      return report_divergence(&c, step, out_path);
+    }
+    inputs += c.count;
+  }
+  printf("%u cases, %llu inputs generated: reference and candidate agree\n", cases, (unsigned long long)inputs);
+
+  // Time the inputs again without drawing, so both sides do engine work only
+  memset(&step_timing, 0, sizeof(step_timing));
+  glib_host_config_t discard = { .discard = true };
+  glib_host_configure(&discard);
+  render_enabled = false;
+  harness_seed = first_seed;
+  for (uint32_t n = 0; n < cases; n++) {
+    random_case(&c, steps);
+    run_case(&c, false);
+  }
+  print_timing("input", &step_timing, "the reference's GLIB calls are counted, not drawn");
+  print_timing("playfield", &frame_timing, "GLIB rectangles into a cleared buffer against board_bits_render()");
+  nvm3_host_close();
+  return 0;
+}
+
+#endif // DIFF_FUZZER
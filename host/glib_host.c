@@ -0,0 +1,346 @@
+// Host GLIB/DMD: renders the drawing calls the app makes into a 128x128 1bpp
+// framebuffer, the memory LCD's geometry. Every primitive and pixel write is
+// counted against the screen being drawn, and each DMD_updateDisplay() is
+// compared line by line with the previous frame to find the lines that
+// actually changed. Frames can be dumped as PBM images.
+
+#include "glib.h"
+#include "glib_host.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#define FONT_FIRST_CHAR   0x20
+#define FONT_CHAR_COUNT   95
+#define FONT_GLYPH_WIDTH  5   // the sixth column of each cell is spacing
+
+// 5x7 glyphs in 6x8 cells, one byte per column, LSB at the top
+static const uint8_t font_narrow_6x8[FONT_CHAR_COUNT][FONT_GLYPH_WIDTH] = {
+  { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, // space ! "
+  { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, // # $ %
+  { 0x36, 0x49, 0x56, 0x20, 0x50 }, { 0x00, 0x08, 0x07, 0x03, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 }, // & ' (
+  { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x2A, 0x1C, 0x7F, 0x1C, 0x2A }, { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // ) * +
+  { 0x00, 0x80, 0x70, 0x30, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x00, 0x60, 0x60, 0x00 }, // , - .
+  { 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, // / 0 1
+  { 0x72, 0x49, 0x49, 0x49, 0x46 }, { 0x21, 0x41, 0x49, 0x4D, 0x33 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 }, // 2 3 4
+  { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x31 }, { 0x41, 0x21, 0x11, 0x09, 0x07 }, // 5 6 7
+  { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x46, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x00, 0x14, 0x00, 0x00 }, // 8 9 :
+  { 0x00, 0x40, 0x34, 0x00, 0x00 }, { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, // ; < =
+  { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x59, 0x09, 0x06 }, { 0x3E, 0x41, 0x5D, 0x59, 0x4E }, // > ? @
+  { 0x7C, 0x12, 0x11, 0x12, 0x7C }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // A B C
+  { 0x7F, 0x41, 0x41, 0x41, 0x3E }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 }, // D E F
+  { 0x3E, 0x41, 0x41, 0x51, 0x73 }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, // G H I
+  { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 }, // J K L
+  { 0x7F, 0x02, 0x1C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // M N O
+  { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 }, // P Q R
+  { 0x26, 0x49, 0x49, 0x49, 0x32 }, { 0x03, 0x01, 0x7F, 0x01, 0x03 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, // S T U
+  { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, { 0x63, 0x14, 0x08, 0x14, 0x63 }, // V W X
+  { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x59, 0x49, 0x4D, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x41 }, // Y Z [
+  { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x41, 0x7F }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, // \ ] ^
+  { 0x40, 0x40, 0x40, 0x40, 0x40 }, { 0x00, 0x03, 0x07, 0x08, 0x00 }, { 0x20, 0x54, 0x54, 0x78, 0x40 }, // _ ` a
+  { 0x7F, 0x28, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x28 }, { 0x38, 0x44, 0x44, 0x28, 0x7F }, // b c d
+  { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x00, 0x08, 0x7E, 0x09, 0x02 }, { 0x18, 0xA4, 0xA4, 0x9C, 0x78 }, // e f g
+  { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x40, 0x3D, 0x00 }, // h i j
+  { 0x7F, 0x10, 0x28, 0x44, 0x00 }, { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x78, 0x04, 0x78 }, // k l m
+  { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, { 0xFC, 0x18, 0x24, 0x24, 0x18 }, // n o p
+  { 0x18, 0x24, 0x24, 0x18, 0xFC }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x24 }, // q r s
+  { 0x04, 0x04, 0x3F, 0x44, 0x24 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C }, // t u v
+  { 0x3C, 0x40, 0x30, 0x40, 0x3C }, { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x4C, 0x90, 0x90, 0x90, 0x7C }, // w x y
+  { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, { 0x00, 0x00, 0x77, 0x00, 0x00 }, // z { |
+  { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x02, 0x01, 0x02, 0x04, 0x02 },                                   // } ~
+};
+
+static const GLIB_DisplayGeometry_t display_geometry = { .xSize = GLIB_HOST_WIDTH, .ySize = GLIB_HOST_HEIGHT };
+
+const GLIB_Font_t GLIB_FontNarrow6x8 = {
+  .pFontPixMap = font_narrow_6x8,
+  .fontWidth = 6,
+  .fontHeight = 8,
+  .cntOfMapElements = FONT_CHAR_COUNT,
+  .lineSpacing = 0,
+  .charSpacing = 0
+};
+
+static uint8_t framebuffer[GLIB_HOST_HEIGHT][GLIB_HOST_LINE_BYTES];   // being drawn
+static uint8_t pushed[GLIB_HOST_HEIGHT][GLIB_HOST_LINE_BYTES];        // last sent to the "LCD"
+static bool pushed_valid = false;
+static uint32_t frame_number = 0;
+
+static glib_host_config_t config;
+static glib_host_screen_stats_t screens[GLIB_HOST_MAX_SCREENS];
+
+// --- Local function prototypes ---
+static glib_host_screen_stats_t *current_screen(void);
+static uint32_t fill(const GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect, uint32_t color);
+static uint32_t set_pixel(const GLIB_Context_t *pContext, int32_t x, int32_t y, uint32_t color);
+static uint32_t draw_char(const GLIB_Context_t *pContext, char c, int32_t x0, int32_t y0, bool opaque);
+static void log_changed_lines(const bool changed[GLIB_HOST_HEIGHT], uint32_t count);
+
+// --- Host control ---
+
+void glib_host_configure(const glib_host_config_t *new_config)
+{
+  config = *new_config;
+}
+
+void glib_host_get_screen_stats(int screen, glib_host_screen_stats_t *stats)
+{
+  *stats = screens[screen];
+}
+
+void glib_host_print_report(FILE *out)
+{
+  for (int i = 0; i < GLIB_HOST_MAX_SCREENS; i++) {
+    const glib_host_screen_stats_t *s = &screens[i];
+    if (s->frames == 0 && s->primitives == 0) {
+      continue;
+    }
+    char fallback[12];
+    const char *name = NULL;
+    if (config.screen_names != NULL && i < config.screen_count) {
+      name = config.screen_names[i];
+    }
+    if (name == NULL) {
+      snprintf(fallback, sizeof(fallback), "screen%d", i);
+      name = fallback;
+    }
+    uint32_t frames = s->frames ? s->frames : 1;
+    fprintf(out, "render %s frames=%u unchanged=%u lines/frame=%.1f prims/frame=%.1f chars/frame=%.1f pixels/frame=%.0f\n",
+            name, s->frames, s->unchanged_frames,
+            (double)s->changed_lines / frames, (double)s->primitives / frames,
+            (double)s->chars / frames, (double)s->pixels_touched / frames);
+  }
+}
+
+const uint8_t *glib_host_frame(void)
+{
+  return &pushed[0][0];
+}
+
+bool glib_host_write_pbm(const char *path)
+{
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    return false;
+  }
+  fprintf(file, "P4\n%d %d\n", GLIB_HOST_WIDTH, GLIB_HOST_HEIGHT);
+  bool ok = fwrite(pushed, sizeof(pushed), 1, file) == 1;
+  return fclose(file) == 0 && ok;
+}
+
+// --- DMD ---
+
+EMSTATUS DMD_init(void *param)
+{
+  (void)param;
+  memset(framebuffer, 0, sizeof(framebuffer));
+  pushed_valid = false;
+  return DMD_OK;
+}
+
+// The memory LCD addresses whole lines, so changed lines are the minimal transfer
+EMSTATUS DMD_updateDisplay(void)
+{
+  glib_host_screen_stats_t *stats = current_screen();
+  bool changed[GLIB_HOST_HEIGHT];
+  uint32_t changed_count = 0;
+
+  if (config.discard) {
+    stats->frames++;
+    return DMD_OK;
+  }
+  for (int y = 0; y < GLIB_HOST_HEIGHT; y++) {
+    changed[y] = !pushed_valid || memcmp(framebuffer[y], pushed[y], GLIB_HOST_LINE_BYTES) != 0;
+    changed_count += changed[y];
+  }
+  memcpy(pushed, framebuffer, sizeof(pushed));
+  pushed_valid = true;
+  frame_number++;
+
+  stats->frames++;
+  stats->changed_lines += changed_count;
+  if (changed_count == 0) {
+    stats->unchanged_frames++;
+  }
+  if (config.frame_log != NULL) {
+    log_changed_lines(changed, changed_count);
+  }
+  if (config.dump_dir != NULL) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/frame_%06u.pbm", config.dump_dir, frame_number);
+    if (!glib_host_write_pbm(path)) {
+      perror(path);
+    }
+  }
+  return DMD_OK;
+}
+
+// --- GLIB ---
+
+EMSTATUS GLIB_contextInit(GLIB_Context_t *pContext)
+{
+  pContext->pDisplayGeometry = &display_geometry;
+  pContext->backgroundColor = White;
+  pContext->foregroundColor = Black;
+  pContext->clippingRegion = (GLIB_Rectangle_t){ 0, 0, display_geometry.xSize - 1, display_geometry.ySize - 1 };
+  pContext->font = GLIB_FontNarrow6x8;
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_clear(GLIB_Context_t *pContext)
+{
+  GLIB_Rectangle_t all = { 0, 0, display_geometry.xSize - 1, display_geometry.ySize - 1 };
+  glib_host_screen_stats_t *stats = current_screen();
+  stats->primitives++;
+  if (config.discard) {
+    return GLIB_OK;
+  }
+  stats->pixels_touched += fill(pContext, &all, pContext->backgroundColor);
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_setFont(GLIB_Context_t *pContext, GLIB_Font_t *pFont)
+{
+  pContext->font = *pFont;
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawRect(GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect)
+{
+  GLIB_Rectangle_t edges[4] = {
+    { pRect->xMin, pRect->yMin, pRect->xMax, pRect->yMin },
+    { pRect->xMin, pRect->yMax, pRect->xMax, pRect->yMax },
+    { pRect->xMin, pRect->yMin + 1, pRect->xMin, pRect->yMax - 1 },
+    { pRect->xMax, pRect->yMin + 1, pRect->xMax, pRect->yMax - 1 },
+  };
+  glib_host_screen_stats_t *stats = current_screen();
+  stats->primitives++;
+  if (config.discard) {
+    return GLIB_OK;
+  }
+  for (int i = 0; i < 4; i++) {
+    stats->pixels_touched += fill(pContext, &edges[i], pContext->foregroundColor);
+  }
+  return GLIB_OK;
+}
+
+EMSTATUS GLIB_drawRectFilled(GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect)
+{
+  glib_host_screen_stats_t *stats = current_screen();
+  stats->primitives++;
+  if (config.discard) {
+    return GLIB_OK;
+  }
+  stats->pixels_touched += fill(pContext, pRect, pContext->foregroundColor);
+  return GLIB_OK;
+}
+
+// Like GLIB, '\n' continues on the next line at x0
+EMSTATUS GLIB_drawString(GLIB_Context_t *pContext, const char *pString, uint32_t sLength,
+                         int32_t x0, int32_t y0, bool opaque)
+{
+  int32_t x = x0;
+  int32_t y = y0;
+  glib_host_screen_stats_t *stats = current_screen();
+  stats->primitives++;
+  if (config.discard) {
+    return GLIB_OK;
+  }
+  for (uint32_t i = 0; i < sLength && pString[i] != '\0'; i++) {
+    if (pString[i] == '\n') {
+      x = x0;
+      y += pContext->font.fontHeight + pContext->font.lineSpacing;
+      continue;
+    }
+    stats->chars++;
+    stats->pixels_touched += draw_char(pContext, pString[i], x, y, opaque);
+    x += pContext->font.fontWidth + pContext->font.charSpacing;
+  }
+  return GLIB_OK;
+}
+
+// --- Internal Helper Functions ---
+
+static glib_host_screen_stats_t *current_screen(void)
+{
+  int screen = config.screen != NULL ? config.screen() : 0;
+  if (screen < 0 || screen >= GLIB_HOST_MAX_SCREENS) {
+    screen = 0;
+  }
+  return &screens[screen];
+}
+
+// The helpers below return the number of pixels they wrote
+static uint32_t fill(const GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect, uint32_t color)
+{
+  uint32_t written = 0;
+  for (int32_t y = pRect->yMin; y <= pRect->yMax; y++) {
+    for (int32_t x = pRect->xMin; x <= pRect->xMax; x++) {
+      written += set_pixel(pContext, x, y, color);
+    }
+  }
+  return written;
+}
+
+static uint32_t set_pixel(const GLIB_Context_t *pContext, int32_t x, int32_t y, uint32_t color)
+{
+  const GLIB_Rectangle_t *clip = &pContext->clippingRegion;
+  if (x < clip->xMin || x > clip->xMax || y < clip->yMin || y > clip->yMax
+      || x < 0 || x >= GLIB_HOST_WIDTH || y < 0 || y >= GLIB_HOST_HEIGHT) {
+    return 0;
+  }
+  uint8_t mask = (uint8_t)(0x80u >> (x & 7));
+  if (color == Black) {
+    framebuffer[y][x >> 3] |= mask;
+  } else {
+    framebuffer[y][x >> 3] &= (uint8_t)~mask;
+  }
+  return 1;
+}
+
+static uint32_t draw_char(const GLIB_Context_t *pContext, char c, int32_t x0, int32_t y0, bool opaque)
+{
+  const uint8_t (*glyphs)[FONT_GLYPH_WIDTH] = pContext->font.pFontPixMap;
+  unsigned index = (unsigned char)c - FONT_FIRST_CHAR;
+  if (glyphs == NULL || index >= FONT_CHAR_COUNT) {
+    index = '?' - FONT_FIRST_CHAR;
+  }
+  if (glyphs == NULL) {
+    glyphs = font_narrow_6x8;
+  }
+  uint32_t written = 0;
+  for (int col = 0; col < pContext->font.fontWidth; col++) {
+    uint8_t bits = col < FONT_GLYPH_WIDTH ? glyphs[index][col] : 0;
+    for (int row = 0; row < pContext->font.fontHeight; row++) {
+      if (bits & (1u << row)) {
+        written += set_pixel(pContext, x0 + col, y0 + row, pContext->foregroundColor);
+      } else if (opaque) {
+        written += set_pixel(pContext, x0 + col, y0 + row, pContext->backgroundColor);
+      }
+    }
+  }
+  return written;
+}
+
+static void log_changed_lines(const bool changed[GLIB_HOST_HEIGHT], uint32_t count)
+{
+  fprintf(config.frame_log, "frame %u screen %d lines %u", frame_number,
+          (int)(current_screen() - screens), count);
+  const char *separator = " ";
+  for (int y = 0; y < GLIB_HOST_HEIGHT; y++) {
+    if (!changed[y]) {
+      continue;
+    }
+    int first = y;
+    while (y + 1 < GLIB_HOST_HEIGHT && changed[y + 1]) {
+      y++;
+    }
+    if (first == y) {
+      fprintf(config.frame_log, "%s%d", separator, first);
+    } else {
+      fprintf(config.frame_log, "%s%d-%d", separator, first, y);
+    }
+    separator = ",";
+  }
+  fputc('\n', config.frame_log);
+}
@@ -0,0 +1,41 @@
+#ifndef GLIB_HOST_H
+#define GLIB_HOST_H
+
+// Configuration and render metrics of the host GLIB/DMD framebuffer.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define GLIB_HOST_WIDTH        128
+#define GLIB_HOST_HEIGHT       128
+#define GLIB_HOST_LINE_BYTES   (GLIB_HOST_WIDTH / 8)
+#define GLIB_HOST_FRAME_BYTES  (GLIB_HOST_LINE_BYTES * GLIB_HOST_HEIGHT)
+#define GLIB_HOST_MAX_SCREENS  16
+
+typedef struct {
+  int (*screen)(void);              // screen being drawn (e.g. the game state); NULL counts everything as screen 0
+  const char *const *screen_names;  // optional, screen_count entries, for the report
+  int screen_count;
+  const char *dump_dir;             // write every pushed frame as <dir>/frame_NNNNNN.pbm
+  FILE *frame_log;                  // one line per pushed frame with its changed line ranges
+  bool discard;                     // count calls but draw and compare nothing, to time the app without rendering
+} glib_host_config_t;
+
+typedef struct {
+  uint32_t frames;                  // DMD_updateDisplay() calls
+  uint32_t unchanged_frames;        // transfers that changed no line at all
+  uint64_t changed_lines;           // lines that differ from the previous frame, summed
+  uint64_t primitives;              // clear, rectangle and string calls
+  uint64_t chars;
+  uint64_t pixels_touched;          // pixel writes, whether or not they changed the pixel
+} glib_host_screen_stats_t;
+
+void glib_host_configure(const glib_host_config_t *config);
+void glib_host_get_screen_stats(int screen, glib_host_screen_stats_t *stats);
+void glib_host_print_report(FILE *out);
+// Last pushed frame, one bit per pixel, MSB first, set bits black (the PBM layout)
+const uint8_t *glib_host_frame(void);
+bool glib_host_write_pbm(const char *path);
+
+#endif // GLIB_HOST_H
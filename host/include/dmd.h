@@ -0,0 +1,15 @@
+#ifndef DMD_H
+#define DMD_H
+
+// Host stand-in for the DMD calls used by the app. Implemented by host/glib_host.c.
+
+#include <stdint.h>
+
+#define DMD_OK 0
+
+typedef uint32_t EMSTATUS;
+
+EMSTATUS DMD_init(void *param);
+EMSTATUS DMD_updateDisplay(void);
+
+#endif // DMD_H
@@ -0,0 +1,6 @@
+#ifndef EM_CHIP_H
+#define EM_CHIP_H
+
+#define CHIP_Init() ((void)0)
+
+#endif // EM_CHIP_H
@@ -0,0 +1,12 @@
+#ifndef EM_CORE_H
+#define EM_CORE_H
+
+// Host stand-in: the host build is single threaded and timer callbacks run
+// from the main loop, so critical sections compile to nothing.
+#define CORE_DECLARE_IRQ_STATE  int core_irq_state_unused __attribute__((unused)) = 0
+#define CORE_ENTER_ATOMIC()     ((void)0)
+#define CORE_EXIT_ATOMIC()      ((void)0)
+#define CORE_ENTER_CRITICAL()   ((void)0)
+#define CORE_EXIT_CRITICAL()    ((void)0)
+
+#endif // EM_CORE_H
@@ -0,0 +1,7 @@
+#ifndef EM_DEVICE_H
+#define EM_DEVICE_H
+
+// Host stand-in: only the flash geometry of the EFR32MG27 is needed.
+#define FLASH_PAGE_SIZE 8192
+
+#endif // EM_DEVICE_H
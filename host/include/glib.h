@@ -0,0 +1,58 @@
+#ifndef GLIB_H
+#define GLIB_H
+
+// Host stand-in for the GLIB subset used by the app. Implemented by host/glib_host.c.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "dmd.h"
+
+#define GLIB_OK 0
+
+typedef enum {
+  Black = 0x000000,
+  White = 0xFFFFFF
+} GLIB_Color_t;
+
+typedef struct {
+  int32_t xSize;
+  int32_t ySize;
+} GLIB_DisplayGeometry_t;
+
+typedef struct {
+  int32_t xMin;
+  int32_t yMin;
+  int32_t xMax;
+  int32_t yMax;
+} GLIB_Rectangle_t;
+
+typedef struct {
+  const void *pFontPixMap;
+  uint16_t fontWidth;
+  uint16_t fontHeight;
+  uint16_t cntOfMapElements;
+  uint16_t lineSpacing;
+  uint16_t charSpacing;
+} GLIB_Font_t;
+
+typedef struct {
+  const GLIB_DisplayGeometry_t *pDisplayGeometry;
+  uint32_t backgroundColor;
+  uint32_t foregroundColor;
+  GLIB_Rectangle_t clippingRegion;
+  GLIB_Font_t font;
+} GLIB_Context_t;
+
+extern const GLIB_Font_t GLIB_FontNarrow6x8;
+
+EMSTATUS GLIB_contextInit(GLIB_Context_t *pContext);
+EMSTATUS GLIB_clear(GLIB_Context_t *pContext);
+EMSTATUS GLIB_setFont(GLIB_Context_t *pContext, GLIB_Font_t *pFont);
+EMSTATUS GLIB_drawRect(GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect);
+EMSTATUS GLIB_drawRectFilled(GLIB_Context_t *pContext, const GLIB_Rectangle_t *pRect);
+EMSTATUS GLIB_drawString(GLIB_Context_t *pContext, const char *pString, uint32_t sLength,
+                         int32_t x0, int32_t y0, bool opaque);
+
+#endif // GLIB_H
@@ -0,0 +1,47 @@
+#ifndef NVM3_H
+#define NVM3_H
+
+// Host stand-in for the NVM3 API subset used by the app. Implemented by
+// host/nvm3_host.c on top of a memory-mapped flash image.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t Ecode_t;
+typedef uint32_t nvm3_ObjectKey_t;
+typedef struct nvm3_Handle nvm3_Handle_t;
+
+#define ECODE_NVM3_OK                    0
+#define ECODE_EMDRV_NVM3_BASE            0xF0000000u
+#define ECODE_NVM3_ERR_STORAGE_FULL      (ECODE_EMDRV_NVM3_BASE | 0x04u)
+#define ECODE_NVM3_ERR_NOT_OPENED        (ECODE_EMDRV_NVM3_BASE | 0x05u)
+#define ECODE_NVM3_ERR_KEY_INVALID       (ECODE_EMDRV_NVM3_BASE | 0x0Au)
+#define ECODE_NVM3_ERR_KEY_NOT_FOUND     (ECODE_EMDRV_NVM3_BASE | 0x0Bu)
+#define ECODE_NVM3_ERR_OBJECT_IS_NOT_DATA (ECODE_EMDRV_NVM3_BASE | 0x0Cu)
+#define ECODE_NVM3_ERR_OBJECT_IS_NOT_A_COUNTER (ECODE_EMDRV_NVM3_BASE | 0x0Du)
+#define ECODE_NVM3_ERR_WRITE_DATA_SIZE   (ECODE_EMDRV_NVM3_BASE | 0x0Fu)
+#define ECODE_NVM3_ERR_WRITE_FAILED      (ECODE_EMDRV_NVM3_BASE | 0x10u)
+#define ECODE_NVM3_ERR_READ_DATA_SIZE    (ECODE_EMDRV_NVM3_BASE | 0x11u)
+
+#define NVM3_OBJECTTYPE_DATA     0
+#define NVM3_OBJECTTYPE_COUNTER  1
+
+#define NVM3_KEY_MIN  0x00000u
+#define NVM3_KEY_MAX  0xFFFFFu
+
+Ecode_t nvm3_readData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, void *value, size_t len);
+Ecode_t nvm3_writeData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, const void *value, size_t len);
+Ecode_t nvm3_getObjectInfo(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t *type, size_t *len);
+Ecode_t nvm3_deleteObject(nvm3_Handle_t *h, nvm3_ObjectKey_t key);
+Ecode_t nvm3_readCounter(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t *value);
+Ecode_t nvm3_writeCounter(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t value);
+Ecode_t nvm3_incrementCounter(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t *newValue);
+size_t nvm3_enumObjects(nvm3_Handle_t *h, nvm3_ObjectKey_t *keyListPtr, size_t keyListSize,
+                        nvm3_ObjectKey_t keyMin, nvm3_ObjectKey_t keyMax);
+size_t nvm3_countObjects(nvm3_Handle_t *h);
+bool nvm3_repackNeeded(nvm3_Handle_t *h);
+Ecode_t nvm3_repack(nvm3_Handle_t *h);
+Ecode_t nvm3_getEraseCount(nvm3_Handle_t *h, uint32_t *eraseCnt);
+
+#endif // NVM3_H
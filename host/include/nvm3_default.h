@@ -0,0 +1,11 @@
+#ifndef NVM3_DEFAULT_H
+#define NVM3_DEFAULT_H
+
+#include "nvm3.h"
+
+extern nvm3_Handle_t *nvm3_defaultHandle;
+
+Ecode_t nvm3_initDefault(void);
+Ecode_t nvm3_deinitDefault(void);
+
+#endif // NVM3_DEFAULT_H
@@ -0,0 +1,8 @@
+#ifndef SL_ASSERT_H
+#define SL_ASSERT_H
+
+#include <assert.h>
+
+#define EFM_ASSERT(expr) assert(expr)
+
+#endif // SL_ASSERT_H
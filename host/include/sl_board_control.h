@@ -0,0 +1,11 @@
+#ifndef SL_BOARD_CONTROL_H
+#define SL_BOARD_CONTROL_H
+
+#include "sl_status.h"
+
+static inline sl_status_t sl_board_enable_display(void)
+{
+  return SL_STATUS_OK;
+}
+
+#endif // SL_BOARD_CONTROL_H
@@ -0,0 +1,7 @@
+#ifndef SL_COMPONENT_CATALOG_H
+#define SL_COMPONENT_CATALOG_H
+
+// Host builds link no SDK components; in particular there is no power
+// manager, so the app runs without sleeping.
+
+#endif // SL_COMPONENT_CATALOG_H
@@ -0,0 +1,22 @@
+#ifndef SL_DEBUG_SWO_H
+#define SL_DEBUG_SWO_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "sl_status.h"
+
+// Host stand-in: every ITM stimulus port is enabled and goes to stdout.
+static inline sl_status_t sl_debug_swo_enable_itm(uint32_t channel)
+{
+  (void)channel;
+  return SL_STATUS_OK;
+}
+
+static inline sl_status_t sl_debug_swo_write_u8(uint32_t channel, uint8_t byte)
+{
+  (void)channel;
+  putchar(byte);
+  return SL_STATUS_OK;
+}
+
+#endif // SL_DEBUG_SWO_H
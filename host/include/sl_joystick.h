@@ -0,0 +1,29 @@
+#ifndef SL_JOYSTICK_H
+#define SL_JOYSTICK_H
+
+// Host stand-in for the joystick driver. The position is whatever the host
+// program last set with input_host_set_joystick() (host/input_host.c).
+
+#include "sl_status.h"
+
+typedef enum {
+  JOYSTICK_NONE,
+  JOYSTICK_C,
+  JOYSTICK_N,
+  JOYSTICK_E,
+  JOYSTICK_S,
+  JOYSTICK_W,
+} sl_joystick_position_t;
+
+typedef struct {
+  int started;
+} sl_joystick_t;
+
+#define JOYSTICK_HANDLE_DEFAULT { 0 }
+
+sl_status_t sl_joystick_init(sl_joystick_t *joystick_handle);
+sl_status_t sl_joystick_start(sl_joystick_t *joystick_handle);
+sl_status_t sl_joystick_stop(sl_joystick_t *joystick_handle);
+sl_status_t sl_joystick_get_position(sl_joystick_t *joystick_handle, sl_joystick_position_t *pos);
+
+#endif // SL_JOYSTICK_H
@@ -0,0 +1,22 @@
+#ifndef SL_SIMPLE_BUTTON_H
+#define SL_SIMPLE_BUTTON_H
+
+// Host stand-in for the simple button driver. States are set by the host
+// program with input_host_set_button() (host/input_host.c), which also runs
+// the app's sl_button_on_change() the way the GPIO interrupt would.
+
+#include <stdint.h>
+
+#define SL_SIMPLE_BUTTON_RELEASED 0
+#define SL_SIMPLE_BUTTON_PRESSED  1
+
+typedef uint8_t sl_button_state_t;
+
+typedef struct {
+  void *context;
+} sl_button_t;
+
+sl_button_state_t sl_button_get_state(const sl_button_t *handle);
+void sl_button_on_change(const sl_button_t *handle);
+
+#endif // SL_SIMPLE_BUTTON_H
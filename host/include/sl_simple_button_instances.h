@@ -0,0 +1,9 @@
+#ifndef SL_SIMPLE_BUTTON_INSTANCES_H
+#define SL_SIMPLE_BUTTON_INSTANCES_H
+
+#include "sl_simple_button.h"
+
+extern const sl_button_t sl_button_btn0;
+extern const sl_button_t sl_button_btn1;
+
+#endif // SL_SIMPLE_BUTTON_INSTANCES_H
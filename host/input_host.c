@@ -0,0 +1,61 @@
+// Host joystick and button drivers: the positions and states the host
+// program scripts, read back by the app through the SDK calls it uses.
+
+#include "input_host.h"
+#include "sl_simple_button_instances.h"
+
+#include <stddef.h>
+
+const sl_button_t sl_button_btn0 = { .context = NULL };
+const sl_button_t sl_button_btn1 = { .context = NULL };
+
+static sl_joystick_position_t joystick_position = JOYSTICK_NONE;
+static sl_button_state_t button_states[2] = { SL_SIMPLE_BUTTON_RELEASED, SL_SIMPLE_BUTTON_RELEASED };
+
+// --- Host control ---
+
+void input_host_set_joystick(sl_joystick_position_t position)
+{
+  joystick_position = position;
+}
+
+void input_host_set_button(int index, bool pressed)
+{
+  sl_button_state_t state = pressed ? SL_SIMPLE_BUTTON_PRESSED : SL_SIMPLE_BUTTON_RELEASED;
+  if (index < 0 || index > 1 || button_states[index] == state) {
+    return;
+  }
+  button_states[index] = state;
+  sl_button_on_change(index == 0 ? &sl_button_btn0 : &sl_button_btn1);
+}
+
+// --- SDK calls ---
+
+sl_status_t sl_joystick_init(sl_joystick_t *joystick_handle)
+{
+  joystick_handle->started = 0;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_joystick_start(sl_joystick_t *joystick_handle)
+{
+  joystick_handle->started = 1;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_joystick_stop(sl_joystick_t *joystick_handle)
+{
+  joystick_handle->started = 0;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_joystick_get_position(sl_joystick_t *joystick_handle, sl_joystick_position_t *pos)
+{
+  *pos = joystick_handle->started ? joystick_position : JOYSTICK_NONE;
+  return SL_STATUS_OK;
+}
+
+sl_button_state_t sl_button_get_state(const sl_button_t *handle)
+{
+  return button_states[handle == &sl_button_btn0 ? 0 : 1];
+}
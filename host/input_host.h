@@ -0,0 +1,14 @@
+#ifndef INPUT_HOST_H
+#define INPUT_HOST_H
+
+// Scripted joystick and buttons for host runs of the full app.
+
+#include <stdbool.h>
+#include "sl_joystick.h"
+
+// Takes effect at the joystick sampler's next tick, as a real deflection would
+void input_host_set_joystick(sl_joystick_position_t position);
+// Changes the button state and runs sl_button_on_change() like the GPIO interrupt
+void input_host_set_button(int index, bool pressed);
+
+#endif // INPUT_HOST_H
@@ -0,0 +1,330 @@
+// Host driver for the benchmark suite in benchmark.c. Boots the app as on
+// target (app_init() runs the suite in TETRIS_BENCH builds) in several child
+// processes, keeps each workload's fastest process, writes the results as
+// JSON and optionally compares them with a stored baseline.
+//
+// A workload regresses when its median is slower than the baseline median by
+// more than the threshold and by more than three times the combined median
+// absolute deviations. The deviations only capture noise within one run, and
+// most of the variance is between processes, so both sides keep the fastest
+// of several processes, and a slowdown must repeat in every confirmation
+// batch before it fails the build. Workloads keep the batch size recorded in
+// the baseline instead of calibrating a new one.
+
+#include "app.h"
+#include "benchmark.h"
+#include "nvm3_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define NOISE_FACTOR        3.0
+#define DEFAULT_PROCESSES   5
+#define CONFIRM_BATCHES     2
+
+typedef struct {
+  char name[48];
+  double median;
+  double mad;
+  uint32_t iterations;
+} baseline_entry_t;
+
+static baseline_entry_t baseline[BENCHMARK_MAX_RESULTS];
+static size_t baseline_count;
+static benchmark_result_t fastest[BENCHMARK_MAX_RESULTS];
+static size_t fastest_count;
+static bool regressed[BENCHMARK_MAX_RESULTS]; // in the first batch and in every confirmation batch so far
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr,
+          "usage: %s [-f filter] [-n samples] [-p processes] [-o out.json] [-b baseline.json] [-t percent]\n"
+          "  -f  only run workloads whose name contains this text\n"
+          "  -n  samples per workload (default %d, at most %d)\n"
+          "  -p  run the suite in this many processes; each workload keeps its fastest (default %d)\n"
+          "  -o  write the JSON results here (default bench.json)\n"
+          "  -b  compare against a previous results file and reuse its batch sizes; exit 1 on a\n"
+          "      regression that repeats in %d more batches of processes\n"
+          "  -t  regression threshold in percent of the baseline median (default 10)\n",
+          argv0, BENCHMARK_SAMPLES, BENCHMARK_MAX_SAMPLES, DEFAULT_PROCESSES, CONFIRM_BATCHES);
+}
+
+static void write_file(const char *text, void *context)
+{
+  fputs(text, (FILE *)context);
+}
+
+static void discard_text(const char *text, void *context)
+{
+  (void)text;
+  (void)context;
+}
+
+static bool read_number(const char *object, const char *key, double *value)
+{
+  const char *field = strstr(object, key);
+  if (field == NULL) {
+    return false;
+  }
+  field = strchr(field + strlen(key), ':');
+  if (field == NULL) {
+    return false;
+  }
+  *value = strtod(field + 1, NULL);
+  return true;
+}
+
+// Reads the files benchmark.c writes: one result object per line
+static bool load_baseline(const char *path)
+{
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    return false;
+  }
+  char line[512];
+  while (fgets(line, sizeof(line), file) != NULL && baseline_count < BENCHMARK_MAX_RESULTS) {
+    const char *name = strstr(line, "\"name\"");
+    if (name == NULL) {
+      continue;
+    }
+    baseline_entry_t *entry = &baseline[baseline_count];
+    double iterations = 0;
+    if (sscanf(name, "\"name\": \"%47[^\"]\"", entry->name) != 1
+        || !read_number(line, "\"median\"", &entry->median)
+        || !read_number(line, "\"mad\"", &entry->mad)) {
+      fprintf(stderr, "%s: cannot parse: %s", path, line);
+      fclose(file);
+      return false;
+    }
+    read_number(line, "\"iterations\"", &iterations); // older baselines calibrate instead
+    entry->iterations = (uint32_t)iterations;
+    baseline_count++;
+  }
+  fclose(file);
+  return true;
+}
+
+static const baseline_entry_t *find_baseline(const char *name)
+{
+  for (size_t i = 0; i < baseline_count; i++) {
+    if (strcmp(baseline[i].name, name) == 0) {
+      return &baseline[i];
+    }
+  }
+  return NULL;
+}
+
+static uint32_t baseline_iterations(const char *name)
+{
+  const baseline_entry_t *base = find_baseline(name);
+  return base != NULL ? base->iterations : 0;
+}
+
+static bool is_slower(const benchmark_result_t *r, const baseline_entry_t *base, double threshold)
+{
+  return base != NULL && base->median > 0
+         && (r->median - base->median) / base->median > threshold
+         && r->median - base->median > NOISE_FACTOR * (r->mad + base->mad);
+}
+
+// Boots the app in a child process, which sends its results back over a pipe.
+// The parent's copy of the suite never runs, so every process starts cold.
+static bool run_process(const benchmark_config_t *config, benchmark_result_t *results, size_t *count)
+{
+  int fds[2];
+  if (pipe(fds) != 0) {
+    perror("pipe");
+    return false;
+  }
+  fflush(NULL);
+  pid_t pid = fork();
+  if (pid < 0) {
+    perror("fork");
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    close(fds[0]);
+    benchmark_config_t child_config = *config;
+    child_config.write = discard_text;
+    benchmark_configure(&child_config);
+    nvm3_host_config_t nvm;
+    nvm3_host_default_config(&nvm);
+    nvm3_host_configure(&nvm);
+    app_init();
+    size_t child_count;
+    const benchmark_result_t *child_results = benchmark_get_results(&child_count);
+    bool sent = write(fds[1], &child_count, sizeof(child_count)) == (ssize_t)sizeof(child_count)
+                && write(fds[1], child_results, child_count * sizeof(*child_results))
+                   == (ssize_t)(child_count * sizeof(*child_results));
+    nvm3_host_close();
+    _exit(sent ? 0 : 1);
+  }
+
+  // Results are a few KB, well under the pipe buffer, so the child never blocks on them
+  close(fds[1]);
+  int status;
+  waitpid(pid, &status, 0);
+  bool ok = WIFEXITED(status) && WEXITSTATUS(status) == 0
+            && read(fds[0], count, sizeof(*count)) == (ssize_t)sizeof(*count)
+            && *count <= BENCHMARK_MAX_RESULTS
+            && read(fds[0], results, *count * sizeof(*results)) == (ssize_t)(*count * sizeof(*results));
+  close(fds[0]);
+  if (!ok) {
+    fprintf(stderr, "benchmark process failed\n");
+  }
+  return ok;
+}
+
+// Runs a batch of processes; out[] gets each workload's fastest run. Workload
+// names point into the suite's static data, which fork() leaves at the same address.
+static bool run_batch(const benchmark_config_t *config, uint32_t processes,
+                      benchmark_result_t *out, size_t *out_count)
+{
+  static benchmark_result_t results[BENCHMARK_MAX_RESULTS];
+  *out_count = 0;
+  for (uint32_t p = 0; p < processes; p++) {
+    size_t count;
+    if (!run_process(config, results, &count)) {
+      return false;
+    }
+    for (size_t i = 0; i < count; i++) {
+      if (p == 0) {
+        out[i] = results[i];
+      } else if (results[i].median < out[i].median) {
+        out[i] = results[i];
+      }
+    }
+    *out_count = count;
+  }
+  return true;
+}
+
+// Runs more batches and keeps only the workloads that are still slower
+static bool confirm_regressions(const benchmark_config_t *config, uint32_t processes, double threshold)
+{
+  static benchmark_result_t results[BENCHMARK_MAX_RESULTS];
+  for (int batch = 0; batch < CONFIRM_BATCHES; batch++) {
+    size_t count;
+    if (!run_batch(config, processes, results, &count)) {
+      return false;
+    }
+    for (size_t i = 0; i < fastest_count && i < count; i++) {
+      regressed[i] = regressed[i] && is_slower(&results[i], find_baseline(results[i].name), threshold);
+    }
+  }
+  return true;
+}
+
+// Prints one row per workload of the first batch; returns the number of regressions
+static int report(double threshold)
+{
+  int regressions = 0;
+
+  printf("%-18s %12s %10s %10s", "workload", "median/" BENCHMARK_UNIT, "mad", "calls");
+  if (baseline_count > 0) {
+    printf(" %12s %8s", "baseline", "change");
+  }
+  printf("\n");
+
+  for (size_t i = 0; i < fastest_count; i++) {
+    const benchmark_result_t *r = &fastest[i];
+    printf("%-18s %12.2f %10.2f %10u", r->name, r->median, r->mad, r->iterations);
+    const baseline_entry_t *base = baseline_count > 0 ? find_baseline(r->name) : NULL;
+    if (base != NULL && base->median > 0) {
+      double change = (r->median - base->median) / base->median;
+      double noise = NOISE_FACTOR * (r->mad + base->mad);
+      const char *verdict = "";
+      if (regressed[i]) {
+        verdict = "  REGRESSION";
+        regressions++;
+      } else if (is_slower(r, base, threshold)) {
+        verdict = "  not repeated";
+      } else if (change < -threshold && base->median - r->median > noise) {
+        verdict = "  improved";
+      }
+      printf(" %12.2f %+7.1f%%%s", base->median, change * 100.0, verdict);
+    } else if (baseline_count > 0) {
+      printf(" %12s", "new");
+    }
+    printf("\n");
+  }
+  return regressions;
+}
+
+int main(int argc, char **argv)
+{
+  benchmark_config_t config = { 0 };
+  const char *out_path = "bench.json";
+  const char *baseline_path = NULL;
+  double threshold_percent = 10.0;
+  uint32_t processes = DEFAULT_PROCESSES;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      config.filter = argv[++i];
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      config.samples = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      processes = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+      baseline_path = argv[++i];
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      threshold_percent = strtod(argv[++i], NULL);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (processes == 0) {
+    processes = 1;
+  }
+
+  // Read the baseline first: it may be the file about to be overwritten
+  if (baseline_path != NULL && !load_baseline(baseline_path)) {
+    return 1;
+  }
+  if (baseline_count > 0) {
+    config.iterations = baseline_iterations;
+  }
+  if (!run_batch(&config, processes, fastest, &fastest_count)) {
+    return 1;
+  }
+
+  FILE *out = fopen(out_path, "w");
+  if (out == NULL) {
+    perror(out_path);
+    return 1;
+  }
+  benchmark_config_t write_config = config;
+  write_config.write = write_file;
+  write_config.context = out;
+  benchmark_configure(&write_config);
+  benchmark_write_results(fastest, fastest_count);
+  fclose(out);
+
+  double threshold = threshold_percent / 100.0;
+  bool any_slower = false;
+  for (size_t i = 0; i < fastest_count; i++) {
+    regressed[i] = is_slower(&fastest[i], find_baseline(fastest[i].name), threshold);
+    any_slower |= regressed[i];
+  }
+  if (any_slower && !confirm_regressions(&config, processes, threshold)) {
+    return 1;
+  }
+
+  int regressions = report(threshold);
+  if (regressions > 0) {
+    fprintf(stderr, "%d workload(s) regressed by more than %.1f%% in %d batches of %u processes\n",
+            regressions, threshold_percent, 1 + CONFIRM_BATCHES, (unsigned)processes);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,227 @@
+// Runs the save, load and high-score paths of tetris.c against the host NVM3
+// emulator and reports simulated flash time and wear per operation. Slot loads
+// are also timed on the wall clock, cold and after the slot menu's prefetch.
+
+#include "tetris.h"
+#include "nvm_cache.h"
+#include "nvm3_host.h"
+#include "sleeptimer_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef enum {
+  OP_BOOT,
+  OP_SAVE,
+  OP_LOAD,
+  OP_HIGH_SCORE,
+  OP_CACHE_FLUSH,
+  OP_BACKGROUND,
+  OP_COUNT
+} bench_op_t;
+
+static const char *op_names[OP_COUNT] = {
+  "boot", "save", "load", "high_score", "cache_flush", "background"
+};
+
+typedef struct {
+  uint32_t count;
+  uint64_t sim_ns;
+  uint64_t bytes;
+  uint32_t erases;
+  uint32_t failures;
+} op_stats_t;
+
+static op_stats_t ops[OP_COUNT];
+static nvm3_host_stats_t before;
+
+typedef struct {
+  uint32_t count;
+  uint64_t wall_ns;
+  uint32_t mismatched;  // tetris_get_last_load_ticks() disagreed about the path taken
+} load_stats_t;
+
+static load_stats_t cold_loads;
+static load_stats_t prefetched_loads;
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr,
+          "usage: %s [-i image] [-n rounds] [-w write_ns_per_word] [-e erase_us_per_page]\n"
+          "          [-f fail_write_after] [-F] [-r]\n"
+          "  -i  back the store with this image file (default: anonymous memory)\n"
+          "  -n  save/load/high-score rounds to run (default 200)\n"
+          "  -f  fault injection: let this many writes succeed, then fail every write\n"
+          "  -F  fault injection: report a full store on every write\n"
+          "  -r  sleep for the simulated flash time as well\n", argv0);
+}
+
+static void op_begin(void)
+{
+  nvm3_host_get_stats(&before);
+}
+
+static void op_end(bench_op_t op)
+{
+  nvm3_host_stats_t after;
+  nvm3_host_get_stats(&after);
+  ops[op].count++;
+  ops[op].sim_ns += after.sim_time_ns - before.sim_time_ns;
+  ops[op].bytes += after.bytes_programmed - before.bytes_programmed;
+  ops[op].erases += after.page_erases - before.page_erases;
+  ops[op].failures += after.failed_writes - before.failed_writes;
+}
+
+static uint64_t wall_ns(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void timed_load(int slot_index, bool expect_prefetched, load_stats_t *stats)
+{
+  uint64_t start = wall_ns();
+  tetris_load_from_slot(slot_index);
+  stats->wall_ns += wall_ns() - start;
+  stats->count++;
+  uint32_t ticks;
+  bool was_prefetched;
+  if (!tetris_get_last_load_ticks(&ticks, &was_prefetched) || was_prefetched != expect_prefetched) {
+    stats->mismatched++;
+  }
+}
+
+// The slot menu highlights the slot and the main loop reads it one object per pass
+static void prefetch_slot(int slot_index)
+{
+  tetris_set_game_state(GAME_STATE_SLOT_SELECTION);
+  tetris_prefetch_slot(slot_index);
+  for (int pass = 0; pass < 8; pass++) {
+    tetris_process_action();
+  }
+}
+
+// Drops a few pieces so every save carries a different board
+static void play_some_pieces(void)
+{
+  if (tetris_get_game_state() != GAME_STATE_IN_GAME) {
+    tetris_start_new_game(1);
+  }
+  int pieces = 1 + rand() % 4;
+  for (int i = 0; i < pieces && tetris_get_game_state() == GAME_STATE_IN_GAME; i++) {
+    int shift = rand() % 9 - 4;
+    for (int s = 0; s < abs(shift); s++) {
+      if (shift < 0) {
+        tetris_move_left();
+      } else {
+        tetris_move_right();
+      }
+    }
+    tetris_hard_drop();
+  }
+  if (tetris_get_game_state() != GAME_STATE_IN_GAME) {
+    tetris_start_new_game(1);
+  }
+}
+
+int main(int argc, char **argv)
+{
+  nvm3_host_config_t config;
+  nvm3_host_default_config(&config);
+  int rounds = 200;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+      config.image_path = argv[++i];
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      rounds = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) {
+      config.write_ns_per_word = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      config.erase_us_per_page = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-f") == 0 && i + 1 < argc) {
+      config.fail_write_after = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-F") == 0) {
+      config.force_full = true;
+    } else if (strcmp(argv[i], "-r") == 0) {
+      config.real_time = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  nvm3_host_configure(&config);
+  srand(1);
+
+  op_begin();
+  tetris_init();
+  op_end(OP_BOOT);
+
+  uint32_t fake_score = 100;
+  for (int round = 0; round < rounds; round++) {
+    play_some_pieces();
+
+    op_begin();
+    tetris_save_game();
+    op_end(OP_SAVE);
+
+    tetris_prefetch_slot(-1); // nothing highlighted: a cold load
+    op_begin();
+    timed_load(round % 5, false, &cold_loads);
+    op_end(OP_LOAD);
+
+    prefetch_slot(round % 5);
+    timed_load(round % 5, true, &prefetched_loads);
+
+    op_begin();
+    tetris_add_high_score(fake_score);
+    op_end(OP_HIGH_SCORE);
+    fake_score += 37;
+
+    if (round % 10 == 9) {
+      op_begin();
+      nvm_cache_flush();
+      op_end(OP_CACHE_FLUSH);
+    }
+
+    // Repacks, autosave and statistics flushes happen from the main loop
+    sleeptimer_host_advance_ms(1000);
+    op_begin();
+    tetris_process_action();
+    op_end(OP_BACKGROUND);
+  }
+
+  nvm3_host_stats_t total;
+  nvm3_host_get_stats(&total);
+
+  printf("%-12s %8s %12s %12s %10s %8s %8s\n",
+         "operation", "count", "sim_ms", "avg_us", "bytes", "erases", "failed");
+  for (int op = 0; op < OP_COUNT; op++) {
+    double avg_us = ops[op].count ? (double)ops[op].sim_ns / ops[op].count / 1000.0 : 0.0;
+    printf("%-12s %8u %12.3f %12.1f %10llu %8u %8u\n",
+           op_names[op], ops[op].count, (double)ops[op].sim_ns / 1e6, avg_us,
+           (unsigned long long)ops[op].bytes, ops[op].erases, ops[op].failures);
+  }
+  printf("\nslot load (wall clock): cold %u avg_us %.2f, prefetched %u avg_us %.2f",
+         cold_loads.count, cold_loads.count ? (double)cold_loads.wall_ns / cold_loads.count / 1000.0 : 0.0,
+         prefetched_loads.count,
+         prefetched_loads.count ? (double)prefetched_loads.wall_ns / prefetched_loads.count / 1000.0 : 0.0);
+  if (cold_loads.mismatched + prefetched_loads.mismatched > 0) {
+    printf(", %u loads took the other path", cold_loads.mismatched + prefetched_loads.mismatched);
+  }
+  printf("\n");
+  printf("\nflash: %llu bytes programmed, %u page erases (%u forced repacks), %u repacks\n",
+         (unsigned long long)total.bytes_programmed, total.page_erases, total.forced_repacks, total.repacks);
+  printf("wear: %u pages, erase count min %u max %u\n",
+         total.page_count, total.min_page_erase_count, total.max_page_erase_count);
+  for (uint32_t page = 0; page < total.page_count; page++) {
+    printf("  page %u: %u erases\n", page, nvm3_host_get_page_erase_count(page));
+  }
+
+  nvm3_host_close();
+  return 0;
+}
@@ -0,0 +1,521 @@
+// Fleet flash-dump analyzer. Memory-maps raw dumps of the NVM3 region, walks
+// the object headers in place and decodes the save system records under the
+// current key map (save_format.h). Images are spread over worker threads and
+// the results are merged into fleet-wide statistics.
+
+#define _DEFAULT_SOURCE
+#include "save_format.h"
+#include "stats.h"
+#include "autosave.h"
+#include "nvm3_image.h"
+#include "nvm3_default_config.h"
+#include "em_device.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define MAX_PAGES           64
+#define INDEX_SIZE          1024 // power of two, open addressing
+#define SCORE_BUCKETS       12   // powers of four from 100 upward
+#define FRAGMENTATION_BINS  10
+#define MAX_LEVEL_BIN       15
+#define REPACK_THRESHOLD_PAGES 2
+
+typedef struct {
+  uint32_t key;
+  const nvm3_image_object_header_t *header; // points into the mapping, never copied
+} index_slot_t;
+
+typedef struct {
+  uint64_t images;
+  uint64_t bad_images;
+  uint64_t bytes_scanned;
+  uint64_t records;
+  uint64_t live_objects;
+  uint64_t live_bytes;
+  uint64_t dead_bytes;
+  uint64_t tombstones;
+  uint64_t torn_pages;
+  uint64_t repack_pending;
+  uint64_t max_page_erases;
+  uint64_t total_page_erases;
+  uint64_t pages;
+  uint64_t slots_used_hist[NUM_SLOTS + 1];
+  uint64_t slot_occupied[NUM_SLOTS];
+  uint64_t legacy_slot_entries;
+  uint64_t saves_decoded;
+  uint64_t save_level_hist[MAX_LEVEL_BIN + 1];
+  uint64_t save_score_hist[SCORE_BUCKETS];
+  uint64_t high_score_hist[SCORE_BUCKETS];
+  uint64_t high_score_images;
+  uint64_t best_score;
+  uint64_t save_counter_images;
+  uint64_t save_counter_sum;
+  uint64_t save_counter_max;
+  uint64_t autosave_present;
+  uint64_t stats_games;
+  uint64_t stats_pieces;
+  uint64_t fragmentation_hist[FRAGMENTATION_BINS];
+} fleet_stats_t;
+
+typedef struct {
+  char **paths;
+  size_t count;
+  atomic_size_t next;
+  uint32_t page_size;
+  uint32_t nvm_size;
+  bool verbose;
+} work_queue_t;
+
+typedef struct {
+  work_queue_t *queue;
+  fleet_stats_t stats;
+} worker_t;
+
+// --- Local function prototypes ---
+static void collect_paths(const char *path, char ***paths, size_t *count, size_t *capacity);
+static void *worker_main(void *arg);
+static void analyze_image(const work_queue_t *queue, const char *path, fleet_stats_t *stats);
+static const nvm3_image_object_header_t *lookup(const index_slot_t *index, uint32_t key);
+static const void *payload(const nvm3_image_object_header_t *header);
+static int score_bucket(uint64_t score);
+static void merge_stats(fleet_stats_t *into, const fleet_stats_t *from);
+static void print_report(const fleet_stats_t *stats);
+
+int main(int argc, char **argv)
+{
+  work_queue_t queue = { .page_size = FLASH_PAGE_SIZE, .nvm_size = NVM3_DEFAULT_NVM_SIZE };
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+  char **paths = NULL;
+  size_t count = 0;
+  size_t capacity = 0;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      threads = atol(argv[++i]);
+    } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      queue.page_size = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      queue.nvm_size = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-v") == 0) {
+      queue.verbose = true;
+    } else if (argv[i][0] == '-') {
+      fprintf(stderr, "usage: %s [-j threads] [-p page_size] [-s nvm_size] [-v] dump|dir...\n", argv[0]);
+      return 2;
+    } else {
+      collect_paths(argv[i], &paths, &count, &capacity);
+    }
+  }
+  if (count == 0) {
+    fprintf(stderr, "no images given\n");
+    return 2;
+  }
+  if (threads < 1) {
+    threads = 1;
+  }
+  if ((size_t)threads > count) {
+    threads = (long)count;
+  }
+
+  queue.paths = paths;
+  queue.count = count;
+  atomic_init(&queue.next, 0);
+
+  worker_t *workers = calloc((size_t)threads, sizeof(worker_t));
+  pthread_t *tids = calloc((size_t)threads, sizeof(pthread_t));
+  for (long t = 0; t < threads; t++) {
+    workers[t].queue = &queue;
+    pthread_create(&tids[t], NULL, worker_main, &workers[t]);
+  }
+
+  fleet_stats_t total;
+  memset(&total, 0, sizeof(total));
+  for (long t = 0; t < threads; t++) {
+    pthread_join(tids[t], NULL);
+    merge_stats(&total, &workers[t].stats);
+  }
+
+  printf("analyzed %zu images with %ld threads\n\n", count, threads);
+  print_report(&total);
+
+  for (size_t i = 0; i < count; i++) {
+    free(paths[i]);
+  }
+  free(paths);
+  free(workers);
+  free(tids);
+  return 0;
+}
+
+// --- Internal Helper Functions ---
+
+static void collect_paths(const char *path, char ***paths, size_t *count, size_t *capacity)
+{
+  struct stat st;
+  if (stat(path, &st) != 0) {
+    fprintf(stderr, "skipping %s: not found\n", path);
+    return;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    DIR *dir = opendir(path);
+    if (dir == NULL) {
+      return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+      if (entry->d_name[0] == '.') {
+        continue;
+      }
+      size_t len = strlen(path) + strlen(entry->d_name) + 2;
+      char *child = malloc(len);
+      snprintf(child, len, "%s/%s", path, entry->d_name);
+      collect_paths(child, paths, count, capacity);
+      free(child);
+    }
+    closedir(dir);
+    return;
+  }
+  if (*count == *capacity) {
+    *capacity = *capacity ? *capacity * 2 : 256;
+    *paths = realloc(*paths, *capacity * sizeof(char *));
+  }
+  (*paths)[(*count)++] = strdup(path);
+}
+
+static void *worker_main(void *arg)
+{
+  worker_t *worker = arg;
+  work_queue_t *queue = worker->queue;
+  for (;;) {
+    size_t i = atomic_fetch_add(&queue->next, 1);
+    if (i >= queue->count) {
+      break;
+    }
+    analyze_image(queue, queue->paths[i], &worker->stats);
+  }
+  return NULL;
+}
+
+static void analyze_image(const work_queue_t *queue, const char *path, fleet_stats_t *stats)
+{
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    stats->bad_images++;
+    return;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < (off_t)queue->page_size) {
+    close(fd);
+    stats->bad_images++;
+    return;
+  }
+  size_t size = (size_t)st.st_size;
+  if (size > queue->nvm_size) {
+    size = queue->nvm_size;
+  }
+  const uint8_t *image = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (image == MAP_FAILED) {
+    stats->bad_images++;
+    return;
+  }
+  madvise((void *)image, size, MADV_SEQUENTIAL);
+
+  uint32_t page_count = (uint32_t)(size / queue->page_size);
+  if (page_count > MAX_PAGES) {
+    page_count = MAX_PAGES;
+  }
+
+  // Order the used pages by sequence number so later records win
+  uint32_t order[MAX_PAGES];
+  uint32_t used = 0;
+  uint32_t erased = 0;
+  for (uint32_t p = 0; p < page_count; p++) {
+    const nvm3_image_page_header_t *page = (const nvm3_image_page_header_t *)(image + (size_t)p * queue->page_size);
+    if (page->magic != NVM3_IMAGE_PAGE_MAGIC) {
+      munmap((void *)image, size);
+      stats->bad_images++;
+      return;
+    }
+    stats->total_page_erases += page->erase_count;
+    if (page->erase_count > stats->max_page_erases) {
+      stats->max_page_erases = page->erase_count;
+    }
+    if (page->sequence == NVM3_IMAGE_ERASED_WORD) {
+      erased++;
+      continue;
+    }
+    uint32_t k = used++;
+    while (k > 0) {
+      const nvm3_image_page_header_t *prev =
+        (const nvm3_image_page_header_t *)(image + (size_t)order[k - 1] * queue->page_size);
+      if (prev->sequence <= page->sequence) {
+        break;
+      }
+      order[k] = order[k - 1];
+      k--;
+    }
+    order[k] = p;
+  }
+
+  index_slot_t index[INDEX_SIZE];
+  memset(index, 0, sizeof(index));
+  uint64_t record_bytes = 0;
+
+  for (uint32_t n = 0; n < used; n++) {
+    const uint8_t *page = image + (size_t)order[n] * queue->page_size;
+    uint32_t offset = sizeof(nvm3_image_page_header_t);
+    while (offset + sizeof(nvm3_image_object_header_t) <= queue->page_size) {
+      const nvm3_image_object_header_t *header = (const nvm3_image_object_header_t *)(page + offset);
+      if (header->key_type == NVM3_IMAGE_ERASED_WORD) {
+        break;
+      }
+      uint32_t record_size = NVM3_IMAGE_RECORD_SIZE(header->length);
+      if (header->length > NVM3_DEFAULT_MAX_OBJECT_SIZE || offset + record_size > queue->page_size) {
+        stats->torn_pages++;
+        break;
+      }
+      stats->records++;
+      record_bytes += record_size;
+
+      uint32_t key = nvm3_image_key(header);
+      uint32_t h = (key * 2654435761u) & (INDEX_SIZE - 1);
+      while (index[h].header != NULL && index[h].key != key) {
+        h = (h + 1) & (INDEX_SIZE - 1);
+      }
+      index[h].key = key;
+      index[h].header = header;
+      if (nvm3_image_type(header) == NVM3_IMAGE_TYPE_DELETED) {
+        stats->tombstones++;
+      }
+      offset += record_size;
+    }
+  }
+
+  // Live set: the newest record of every key that is not a tombstone
+  uint64_t live_bytes = 0;
+  for (int h = 0; h < INDEX_SIZE; h++) {
+    if (index[h].header != NULL && nvm3_image_type(index[h].header) != NVM3_IMAGE_TYPE_DELETED) {
+      stats->live_objects++;
+      live_bytes += NVM3_IMAGE_RECORD_SIZE(index[h].header->length);
+    }
+  }
+  stats->live_bytes += live_bytes;
+  stats->dead_bytes += record_bytes - live_bytes;
+  if (record_bytes > 0) {
+    int bin = (int)(((record_bytes - live_bytes) * FRAGMENTATION_BINS) / (record_bytes + 1));
+    stats->fragmentation_hist[bin]++;
+  }
+  if (erased <= REPACK_THRESHOLD_PAGES) {
+    stats->repack_pending++;
+  }
+  stats->pages += page_count;
+
+  // Slot index
+  int slots_used = 0;
+  for (int i = 0; i < NUM_SLOTS; i++) {
+    const nvm3_image_object_header_t *meta = lookup(index, SLOT_META_KEY_BASE + i);
+    bool occupied = false;
+    if (meta != NULL && meta->length == sizeof(game_slot_t)) {
+      const game_slot_t *slot = payload(meta);
+      occupied = slot->is_occupied;
+    } else if (meta != NULL && meta->length == sizeof(legacy_game_slot_t)) {
+      const legacy_game_slot_t *slot = payload(meta);
+      occupied = slot->is_occupied;
+      stats->legacy_slot_entries++;
+    }
+    if (!occupied) {
+      continue;
+    }
+    slots_used++;
+    stats->slot_occupied[i]++;
+
+    const nvm3_image_object_header_t *save = lookup(index, SLOT_DATA_KEY_BASE + i * SLOT_DATA_KEY_STRIDE);
+    if (save != NULL && save->length == sizeof(saved_game_meta_t)) {
+      const saved_game_meta_t *saved = payload(save);
+      int level = saved->level < 0 ? 0 : (saved->level > MAX_LEVEL_BIN ? MAX_LEVEL_BIN : saved->level);
+      stats->saves_decoded++;
+      stats->save_level_hist[level]++;
+      stats->save_score_hist[score_bucket(saved->score < 0 ? 0 : (uint64_t)saved->score)]++;
+    }
+  }
+  stats->slots_used_hist[slots_used]++;
+
+  // Save counter and high scores
+  const nvm3_image_object_header_t *counter = lookup(index, SAVE_COUNTER_KEY);
+  if (counter != NULL && counter->length == sizeof(uint32_t)) {
+    uint32_t value;
+    memcpy(&value, payload(counter), sizeof(value));
+    stats->save_counter_images++;
+    stats->save_counter_sum += value;
+    if (value > stats->save_counter_max) {
+      stats->save_counter_max = value;
+    }
+  }
+  const nvm3_image_object_header_t *scores = lookup(index, HIGH_SCORES_KEY);
+  if (scores != NULL && scores->length == 5 * sizeof(uint32_t)) {
+    const uint32_t *high_scores = payload(scores);
+    stats->high_score_images++;
+    for (int i = 0; i < 5; i++) {
+      if (high_scores[i] == 0) {
+        continue;
+      }
+      stats->high_score_hist[score_bucket(high_scores[i])]++;
+      if (high_scores[i] > stats->best_score) {
+        stats->best_score = high_scores[i];
+      }
+    }
+  }
+
+  if (lookup(index, AUTOSAVE_KEY) != NULL) {
+    stats->autosave_present++;
+  }
+  const nvm3_image_object_header_t *games = lookup(index, STATS_KEY_BASE + STATS_GAMES_PLAYED);
+  if (games != NULL && nvm3_image_type(games) == NVM3_IMAGE_TYPE_COUNTER) {
+    stats->stats_games += *(const uint32_t *)payload(games);
+  }
+  const nvm3_image_object_header_t *pieces = lookup(index, STATS_KEY_BASE + STATS_PIECES_PLACED);
+  if (pieces != NULL && nvm3_image_type(pieces) == NVM3_IMAGE_TYPE_COUNTER) {
+    stats->stats_pieces += *(const uint32_t *)payload(pieces);
+  }
+
+  if (queue->verbose) {
+    printf("%s: %u/%u pages used, %llu live bytes, %d slots, %s\n", path, used, page_count,
+           (unsigned long long)live_bytes, slots_used, erased <= REPACK_THRESHOLD_PAGES ? "repack pending" : "ok");
+  }
+
+  stats->images++;
+  stats->bytes_scanned += size;
+  munmap((void *)image, size);
+}
+
+static const nvm3_image_object_header_t *lookup(const index_slot_t *index, uint32_t key)
+{
+  uint32_t h = (key * 2654435761u) & (INDEX_SIZE - 1);
+  while (index[h].header != NULL) {
+    if (index[h].key == key) {
+      return nvm3_image_type(index[h].header) == NVM3_IMAGE_TYPE_DELETED ? NULL : index[h].header;
+    }
+    h = (h + 1) & (INDEX_SIZE - 1);
+  }
+  return NULL;
+}
+
+static const void *payload(const nvm3_image_object_header_t *header)
+{
+  return (const uint8_t *)header + sizeof(*header);
+}
+
+// Bucket 0 is < 100, bucket n covers [100 * 4^(n-1), 100 * 4^n)
+static int score_bucket(uint64_t score)
+{
+  int bucket = 0;
+  uint64_t limit = 100;
+  while (score >= limit && bucket < SCORE_BUCKETS - 1) {
+    limit *= 4;
+    bucket++;
+  }
+  return bucket;
+}
+
+static void merge_stats(fleet_stats_t *into, const fleet_stats_t *from)
+{
+  // Every field is a sum except the maxima
+  const uint64_t *src = (const uint64_t *)from;
+  uint64_t *dst = (uint64_t *)into;
+  for (size_t i = 0; i < sizeof(fleet_stats_t) / sizeof(uint64_t); i++) {
+    dst[i] += src[i];
+  }
+  into->max_page_erases -= from->max_page_erases;
+  into->best_score -= from->best_score;
+  into->save_counter_max -= from->save_counter_max;
+  if (from->max_page_erases > into->max_page_erases) {
+    into->max_page_erases = from->max_page_erases;
+  }
+  if (from->best_score > into->best_score) {
+    into->best_score = from->best_score;
+  }
+  if (from->save_counter_max > into->save_counter_max) {
+    into->save_counter_max = from->save_counter_max;
+  }
+}
+
+static void print_histogram(const char *title, const uint64_t *bins, int count, uint64_t total)
+{
+  printf("%s\n", title);
+  for (int i = 0; i < count; i++) {
+    if (bins[i] == 0) {
+      continue;
+    }
+    int bar = total ? (int)((bins[i] * 40) / total) : 0;
+    if (count == SCORE_BUCKETS) {
+      uint64_t low = i == 0 ? 0 : 100;
+      for (int k = 1; k < i; k++) {
+        low *= 4;
+      }
+      printf("  >= %-9llu %8llu  %.*s\n", (unsigned long long)low, (unsigned long long)bins[i],
+             bar, "########################################");
+    } else {
+      printf("  %-12d %8llu  %.*s\n", i, (unsigned long long)bins[i],
+             bar, "########################################");
+    }
+  }
+}
+
+static void print_report(const fleet_stats_t *s)
+{
+  double images = s->images ? (double)s->images : 1.0;
+
+  printf("images: %llu ok, %llu unreadable, %.1f MiB scanned\n",
+         (unsigned long long)s->images, (unsigned long long)s->bad_images, s->bytes_scanned / 1048576.0);
+  printf("records: %llu (%llu tombstones), %.1f live objects per image, %llu torn pages\n",
+         (unsigned long long)s->records, (unsigned long long)s->tombstones,
+         s->live_objects / images, (unsigned long long)s->torn_pages);
+
+  uint64_t used_bytes = s->live_bytes + s->dead_bytes;
+  printf("\nfragmentation: %.1f%% of written bytes are stale, %.0f live bytes per image\n",
+         used_bytes ? 100.0 * s->dead_bytes / used_bytes : 0.0, s->live_bytes / images);
+  printf("repack pressure: %llu images (%.1f%%) at or below %d erased pages\n",
+         (unsigned long long)s->repack_pending, 100.0 * s->repack_pending / images, REPACK_THRESHOLD_PAGES);
+  printf("wear: max page erase count %llu, mean %.1f per page\n",
+         (unsigned long long)s->max_page_erases, s->pages ? (double)s->total_page_erases / s->pages : 0.0);
+  uint64_t fragmentation_total = 0;
+  for (int i = 0; i < FRAGMENTATION_BINS; i++) {
+    fragmentation_total += s->fragmentation_hist[i];
+  }
+  print_histogram("stale fraction (tenths):", s->fragmentation_hist, FRAGMENTATION_BINS, fragmentation_total);
+
+  printf("\nslots:\n");
+  print_histogram("occupied slots per image:", s->slots_used_hist, NUM_SLOTS + 1, s->images);
+  for (int i = 0; i < NUM_SLOTS; i++) {
+    printf("  slot %d in use on %.1f%% of units\n", i + 1, 100.0 * s->slot_occupied[i] / images);
+  }
+  printf("  %llu legacy index entries, %llu saves decoded\n",
+         (unsigned long long)s->legacy_slot_entries, (unsigned long long)s->saves_decoded);
+  print_histogram("saved level:", s->save_level_hist, MAX_LEVEL_BIN + 1, s->saves_decoded);
+  print_histogram("saved score:", s->save_score_hist, SCORE_BUCKETS, s->saves_decoded);
+
+  printf("\nsave counter: %llu images, mean %.1f, max %llu\n", (unsigned long long)s->save_counter_images,
+         s->save_counter_images ? (double)s->save_counter_sum / s->save_counter_images : 0.0,
+         (unsigned long long)s->save_counter_max);
+
+  uint64_t score_total = 0;
+  for (int i = 0; i < SCORE_BUCKETS; i++) {
+    score_total += s->high_score_hist[i];
+  }
+  printf("\nhigh scores: %llu images, best %llu\n",
+         (unsigned long long)s->high_score_images, (unsigned long long)s->best_score);
+  print_histogram("high score distribution:", s->high_score_hist, SCORE_BUCKETS, score_total);
+
+  printf("\nautosave checkpoint present on %.1f%% of units\n", 100.0 * s->autosave_present / images);
+  printf("lifetime: %llu games, %llu pieces across the fleet\n",
+         (unsigned long long)s->stats_games, (unsigned long long)s->stats_pieces);
+}
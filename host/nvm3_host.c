@@ -0,0 +1,606 @@
+// Host NVM3 emulator: the NVM3 API subset used by the app, backed by a
+// memory-mapped image laid out as flash pages (see nvm3_image.h). Objects are
+// appended to a log that wraps around the pages; repacking copies the live
+// objects out of the oldest page and erases it. Program and erase operations
+// are charged simulated time and erase counts are kept per page.
+
+#define _DEFAULT_SOURCE
+#include "nvm3.h"
+#include "nvm3_default.h"
+#include "nvm3_host.h"
+#include "nvm3_image.h"
+#include "nvm3_default_config.h"
+#include "em_device.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MAX_OBJECTS             1024
+#define REPACK_THRESHOLD_PAGES  2 // repack once no more than this many pages are erased
+
+struct nvm3_Handle {
+  int unused;
+};
+
+typedef struct {
+  uint32_t key;
+  uint32_t type;
+  uint32_t offset; // of the record header in the image
+  uint32_t length;
+} index_entry_t;
+
+static struct nvm3_Handle default_handle;
+nvm3_Handle_t *nvm3_defaultHandle = &default_handle;
+
+static nvm3_host_config_t config;
+static bool configured = false;
+static bool opened = false;
+
+static uint8_t *image = NULL;
+static size_t image_size = 0;
+static int image_fd = -1;
+static uint32_t page_count = 0;
+static uint32_t tail_page = 0;   // oldest page holding objects
+static uint32_t head_page = 0;   // page currently appended to
+static uint32_t head_offset = 0; // next free byte in the head page
+static uint32_t used_pages = 0;
+static uint32_t next_sequence = 0;
+static uint32_t writes_until_failure = 0;
+static bool in_repack = false;
+
+static index_entry_t objects[MAX_OBJECTS];
+static size_t object_count = 0;
+static nvm3_host_stats_t stats;
+
+// --- Local function prototypes ---
+static nvm3_image_page_header_t *page_header(uint32_t page);
+static void charge_time(uint64_t ns);
+static void program(uint32_t offset, const void *data, size_t len);
+static void erase_page(uint32_t page);
+static void format_image(void);
+static void mount_image(void);
+static void scan_page(uint32_t page);
+static index_entry_t *find_object(uint32_t key);
+static void index_put(uint32_t key, uint32_t type, uint32_t offset, uint32_t length);
+static void index_remove(uint32_t key);
+static Ecode_t open_next_page(bool allow_reserved);
+static Ecode_t append_record(uint32_t key, uint32_t type, const void *data, size_t len);
+static Ecode_t write_object(uint32_t key, uint32_t type, const void *data, size_t len);
+static Ecode_t repack_tail_page(void);
+
+// --- Configuration ---
+
+void nvm3_host_default_config(nvm3_host_config_t *out)
+{
+  memset(out, 0, sizeof(*out));
+  out->image_path = NULL;
+  out->nvm_size = NVM3_DEFAULT_NVM_SIZE;
+  out->page_size = FLASH_PAGE_SIZE;
+  out->write_ns_per_word = 20000;  // typical Series 2 word program time
+  out->erase_us_per_page = 20000;  // typical Series 2 page erase time
+}
+
+void nvm3_host_configure(const nvm3_host_config_t *new_config)
+{
+  nvm3_host_close();
+  config = *new_config;
+  configured = true;
+}
+
+void nvm3_host_get_stats(nvm3_host_stats_t *out)
+{
+  stats.page_count = page_count;
+  stats.min_page_erase_count = 0xFFFFFFFFu;
+  stats.max_page_erase_count = 0;
+  for (uint32_t i = 0; i < page_count; i++) {
+    uint32_t erases = page_header(i)->erase_count;
+    if (erases < stats.min_page_erase_count) {
+      stats.min_page_erase_count = erases;
+    }
+    if (erases > stats.max_page_erase_count) {
+      stats.max_page_erase_count = erases;
+    }
+  }
+  if (page_count == 0) {
+    stats.min_page_erase_count = 0;
+  }
+  *out = stats;
+}
+
+uint32_t nvm3_host_get_page_erase_count(uint32_t page)
+{
+  return (opened && page < page_count) ? page_header(page)->erase_count : 0;
+}
+
+void nvm3_host_close(void)
+{
+  if (image != NULL) {
+    if (image_fd >= 0) {
+      msync(image, image_size, MS_SYNC);
+    }
+    munmap(image, image_size);
+    image = NULL;
+  }
+  if (image_fd >= 0) {
+    close(image_fd);
+    image_fd = -1;
+  }
+  opened = false;
+}
+
+// --- NVM3 API ---
+
+Ecode_t nvm3_initDefault(void)
+{
+  if (!configured) {
+    nvm3_host_default_config(&config);
+    configured = true;
+  }
+  nvm3_host_close();
+
+  page_count = config.nvm_size / config.page_size;
+  image_size = (size_t)page_count * config.page_size;
+  if (page_count < 3) {
+    return ECODE_NVM3_ERR_NOT_OPENED;
+  }
+
+  bool fresh = true;
+  if (config.image_path != NULL) {
+    image_fd = open(config.image_path, O_RDWR | O_CREAT, 0644);
+    if (image_fd < 0) {
+      return ECODE_NVM3_ERR_NOT_OPENED;
+    }
+    off_t existing = lseek(image_fd, 0, SEEK_END);
+    fresh = (existing != (off_t)image_size);
+    if (fresh && ftruncate(image_fd, (off_t)image_size) != 0) {
+      close(image_fd);
+      image_fd = -1;
+      return ECODE_NVM3_ERR_NOT_OPENED;
+    }
+    image = mmap(NULL, image_size, PROT_READ | PROT_WRITE, MAP_SHARED, image_fd, 0);
+  } else {
+    image = mmap(NULL, image_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  }
+  if (image == MAP_FAILED) {
+    image = NULL;
+    nvm3_host_close();
+    return ECODE_NVM3_ERR_NOT_OPENED;
+  }
+
+  memset(&stats, 0, sizeof(stats));
+  writes_until_failure = config.fail_write_after;
+  if (fresh) {
+    format_image();
+  }
+  mount_image();
+  opened = true;
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_deinitDefault(void)
+{
+  nvm3_host_close();
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_readData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, void *value, size_t len)
+{
+  (void)h;
+  if (!opened) {
+    return ECODE_NVM3_ERR_NOT_OPENED;
+  }
+  index_entry_t *object = find_object(key);
+  if (object == NULL) {
+    return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  if (object->type != NVM3_OBJECTTYPE_DATA) {
+    return ECODE_NVM3_ERR_OBJECT_IS_NOT_DATA;
+  }
+  if (len > object->length) {
+    return ECODE_NVM3_ERR_READ_DATA_SIZE;
+  }
+  memcpy(value, image + object->offset + sizeof(nvm3_image_object_header_t), len);
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_writeData(nvm3_Handle_t *h, nvm3_ObjectKey_t key, const void *value, size_t len)
+{
+  (void)h;
+  if (len > NVM3_DEFAULT_MAX_OBJECT_SIZE) {
+    return ECODE_NVM3_ERR_WRITE_DATA_SIZE;
+  }
+  return write_object(key, NVM3_OBJECTTYPE_DATA, value, len);
+}
+
+Ecode_t nvm3_getObjectInfo(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t *type, size_t *len)
+{
+  (void)h;
+  if (!opened) {
+    return ECODE_NVM3_ERR_NOT_OPENED;
+  }
+  index_entry_t *object = find_object(key);
+  if (object == NULL) {
+    return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  *type = object->type;
+  *len = object->length;
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_deleteObject(nvm3_Handle_t *h, nvm3_ObjectKey_t key)
+{
+  (void)h;
+  if (!opened) {
+    return ECODE_NVM3_ERR_NOT_OPENED;
+  }
+  if (find_object(key) == NULL) {
+    return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  return write_object(key, NVM3_IMAGE_TYPE_DELETED, NULL, 0);
+}
+
+Ecode_t nvm3_readCounter(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t *value)
+{
+  (void)h;
+  if (!opened) {
+    return ECODE_NVM3_ERR_NOT_OPENED;
+  }
+  index_entry_t *object = find_object(key);
+  if (object == NULL) {
+    return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  if (object->type != NVM3_OBJECTTYPE_COUNTER) {
+    return ECODE_NVM3_ERR_OBJECT_IS_NOT_A_COUNTER;
+  }
+  memcpy(value, image + object->offset + sizeof(nvm3_image_object_header_t), sizeof(*value));
+  return ECODE_NVM3_OK;
+}
+
+Ecode_t nvm3_writeCounter(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t value)
+{
+  (void)h;
+  index_entry_t *object = find_object(key);
+  if (object != NULL && object->type != NVM3_OBJECTTYPE_COUNTER) {
+    return ECODE_NVM3_ERR_OBJECT_IS_NOT_A_COUNTER;
+  }
+  return write_object(key, NVM3_OBJECTTYPE_COUNTER, &value, sizeof(value));
+}
+
+Ecode_t nvm3_incrementCounter(nvm3_Handle_t *h, nvm3_ObjectKey_t key, uint32_t *newValue)
+{
+  uint32_t value = 0;
+  Ecode_t err = nvm3_readCounter(h, key, &value);
+  if (err != ECODE_NVM3_OK && err != ECODE_NVM3_ERR_KEY_NOT_FOUND) {
+    return err;
+  }
+  value++;
+  err = nvm3_writeCounter(h, key, value);
+  if (err == ECODE_NVM3_OK && newValue != NULL) {
+    *newValue = value;
+  }
+  return err;
+}
+
+size_t nvm3_enumObjects(nvm3_Handle_t *h, nvm3_ObjectKey_t *keyListPtr, size_t keyListSize,
+                        nvm3_ObjectKey_t keyMin, nvm3_ObjectKey_t keyMax)
+{
+  (void)h;
+  size_t found = 0;
+  for (size_t i = 0; i < object_count; i++) {
+    if (objects[i].key < keyMin || objects[i].key > keyMax) {
+      continue;
+    }
+    if (keyListPtr != NULL) {
+      if (found >= keyListSize) {
+        break;
+      }
+      keyListPtr[found] = objects[i].key;
+    }
+    found++;
+  }
+  return found;
+}
+
+size_t nvm3_countObjects(nvm3_Handle_t *h)
+{
+  (void)h;
+  return object_count;
+}
+
+bool nvm3_repackNeeded(nvm3_Handle_t *h)
+{
+  (void)h;
+  return opened && (page_count - used_pages) <= REPACK_THRESHOLD_PAGES;
+}
+
+Ecode_t nvm3_repack(nvm3_Handle_t *h)
+{
+  (void)h;
+  if (!opened) {
+    return ECODE_NVM3_ERR_NOT_OPENED;
+  }
+  if (!nvm3_repackNeeded(h)) {
+    return ECODE_NVM3_OK;
+  }
+  stats.repacks++;
+  return repack_tail_page();
+}
+
+Ecode_t nvm3_getEraseCount(nvm3_Handle_t *h, uint32_t *eraseCnt)
+{
+  (void)h;
+  if (!opened) {
+    return ECODE_NVM3_ERR_NOT_OPENED;
+  }
+  nvm3_host_stats_t current;
+  nvm3_host_get_stats(&current);
+  *eraseCnt = current.min_page_erase_count;
+  return ECODE_NVM3_OK;
+}
+
+// --- Internal Helper Functions ---
+
+static nvm3_image_page_header_t *page_header(uint32_t page)
+{
+  return (nvm3_image_page_header_t *)(image + (size_t)page * config.page_size);
+}
+
+static void charge_time(uint64_t ns)
+{
+  stats.sim_time_ns += ns;
+  if (config.real_time && ns > 0) {
+    struct timespec ts = { .tv_sec = (time_t)(ns / 1000000000u), .tv_nsec = (long)(ns % 1000000000u) };
+    nanosleep(&ts, NULL);
+  }
+}
+
+static void program(uint32_t offset, const void *data, size_t len)
+{
+  memcpy(image + offset, data, len);
+  stats.bytes_programmed += len;
+  charge_time((uint64_t)((len + 3) / 4) * config.write_ns_per_word);
+}
+
+static void erase_page(uint32_t page)
+{
+  nvm3_image_page_header_t *header = page_header(page);
+  uint32_t erase_count = (header->magic == NVM3_IMAGE_PAGE_MAGIC) ? header->erase_count : 0;
+
+  memset(header, 0xFF, config.page_size);
+  header->magic = NVM3_IMAGE_PAGE_MAGIC;
+  header->erase_count = erase_count + 1;
+  stats.page_erases++;
+  charge_time((uint64_t)config.erase_us_per_page * 1000u);
+}
+
+static void format_image(void)
+{
+  memset(image, 0xFF, image_size);
+  for (uint32_t i = 0; i < page_count; i++) {
+    page_header(i)->magic = NVM3_IMAGE_PAGE_MAGIC;
+    page_header(i)->erase_count = 0;
+  }
+}
+
+static void mount_image(void)
+{
+  object_count = 0;
+  used_pages = 0;
+  next_sequence = 0;
+
+  uint32_t oldest_sequence = NVM3_IMAGE_ERASED_WORD;
+  uint32_t newest_sequence = 0;
+  for (uint32_t i = 0; i < page_count; i++) {
+    nvm3_image_page_header_t *header = page_header(i);
+    if (header->magic != NVM3_IMAGE_PAGE_MAGIC) {
+      erase_page(i);
+      continue;
+    }
+    if (header->sequence == NVM3_IMAGE_ERASED_WORD) {
+      continue;
+    }
+    used_pages++;
+    if (header->sequence < oldest_sequence) {
+      oldest_sequence = header->sequence;
+      tail_page = i;
+    }
+    if (header->sequence >= newest_sequence) {
+      newest_sequence = header->sequence;
+      head_page = i;
+    }
+  }
+
+  if (used_pages == 0) {
+    tail_page = 0;
+    head_page = 0;
+    page_header(0)->sequence = next_sequence++;
+    head_offset = sizeof(nvm3_image_page_header_t);
+    used_pages = 1;
+    return;
+  }
+
+  // Replay the log from the oldest page so later records win
+  for (uint32_t n = 0, page = tail_page; n < used_pages; n++, page = (page + 1) % page_count) {
+    scan_page(page);
+  }
+  next_sequence = newest_sequence + 1;
+}
+
+static void scan_page(uint32_t page)
+{
+  uint32_t base = page * config.page_size;
+  uint32_t offset = sizeof(nvm3_image_page_header_t);
+
+  while (offset + sizeof(nvm3_image_object_header_t) <= config.page_size) {
+    const nvm3_image_object_header_t *header = (const nvm3_image_object_header_t *)(image + base + offset);
+    if (header->key_type == NVM3_IMAGE_ERASED_WORD) {
+      break;
+    }
+    uint32_t record_size = NVM3_IMAGE_RECORD_SIZE(header->length);
+    if (header->length > NVM3_DEFAULT_MAX_OBJECT_SIZE || offset + record_size > config.page_size) {
+      break; // torn record: treat the rest of the page as unusable
+    }
+    if (nvm3_image_type(header) == NVM3_IMAGE_TYPE_DELETED) {
+      index_remove(nvm3_image_key(header));
+    } else {
+      index_put(nvm3_image_key(header), nvm3_image_type(header), base + offset, header->length);
+    }
+    offset += record_size;
+  }
+
+  if (page == head_page) {
+    head_offset = offset;
+  }
+}
+
+static index_entry_t *find_object(uint32_t key)
+{
+  for (size_t i = 0; i < object_count; i++) {
+    if (objects[i].key == key) {
+      return &objects[i];
+    }
+  }
+  return NULL;
+}
+
+static void index_put(uint32_t key, uint32_t type, uint32_t offset, uint32_t length)
+{
+  index_entry_t *object = find_object(key);
+  if (object == NULL) {
+    if (object_count >= MAX_OBJECTS) {
+      return;
+    }
+    object = &objects[object_count++];
+    object->key = key;
+  }
+  object->type = type;
+  object->offset = offset;
+  object->length = length;
+}
+
+static void index_remove(uint32_t key)
+{
+  index_entry_t *object = find_object(key);
+  if (object != NULL) {
+    *object = objects[--object_count];
+  }
+}
+
+// One erased page is held back so a repack always has somewhere to copy to.
+static Ecode_t open_next_page(bool allow_reserved)
+{
+  uint32_t erased_pages = page_count - used_pages;
+  if (erased_pages == 0 || (erased_pages == 1 && !allow_reserved)) {
+    return ECODE_NVM3_ERR_STORAGE_FULL;
+  }
+  head_page = (head_page + 1) % page_count;
+  page_header(head_page)->sequence = next_sequence++;
+  charge_time(config.write_ns_per_word);
+  head_offset = sizeof(nvm3_image_page_header_t);
+  used_pages++;
+  return ECODE_NVM3_OK;
+}
+
+static Ecode_t append_record(uint32_t key, uint32_t type, const void *data, size_t len)
+{
+  uint32_t record_size = NVM3_IMAGE_RECORD_SIZE(len);
+  if (head_offset + record_size > config.page_size) {
+    Ecode_t err = open_next_page(in_repack);
+    if (err != ECODE_NVM3_OK) {
+      return err;
+    }
+  }
+
+  uint32_t offset = head_page * config.page_size + head_offset;
+  nvm3_image_object_header_t header = {
+    .key_type = (key & NVM3_IMAGE_KEY_MASK) | (type << NVM3_IMAGE_TYPE_SHIFT),
+    .length = (uint32_t)len
+  };
+  if (len > 0) {
+    program(offset + sizeof(header), data, len);
+  }
+  // The header goes last so a torn write leaves no valid record behind
+  program(offset, &header, sizeof(header));
+  head_offset += record_size;
+
+  if (type == NVM3_IMAGE_TYPE_DELETED) {
+    index_remove(key);
+  } else {
+    index_put(key, type, offset, (uint32_t)len);
+  }
+  return ECODE_NVM3_OK;
+}
+
+static Ecode_t write_object(uint32_t key, uint32_t type, const void *data, size_t len)
+{
+  if (!opened) {
+    return ECODE_NVM3_ERR_NOT_OPENED;
+  }
+  if (key > NVM3_KEY_MAX) {
+    return ECODE_NVM3_ERR_KEY_INVALID;
+  }
+  if (config.force_full) {
+    stats.failed_writes++;
+    return ECODE_NVM3_ERR_STORAGE_FULL;
+  }
+  if (config.fail_write_after > 0) {
+    if (writes_until_failure == 0) {
+      stats.failed_writes++;
+      return ECODE_NVM3_ERR_WRITE_FAILED;
+    }
+    writes_until_failure--;
+  }
+
+  Ecode_t err = append_record(key, type, data, len);
+  while (err == ECODE_NVM3_ERR_STORAGE_FULL && used_pages > 1) {
+    // Like NVM3, fall back to a forced repack when the log has run out of pages
+    stats.forced_repacks++;
+    if (repack_tail_page() != ECODE_NVM3_OK) {
+      break;
+    }
+    err = append_record(key, type, data, len);
+  }
+
+  if (err == ECODE_NVM3_OK) {
+    stats.writes++;
+  } else {
+    stats.failed_writes++;
+  }
+  return err;
+}
+
+static Ecode_t repack_tail_page(void)
+{
+  if (used_pages <= 1) {
+    return ECODE_NVM3_ERR_STORAGE_FULL;
+  }
+
+  uint32_t page_start = tail_page * config.page_size;
+  uint32_t page_end = page_start + config.page_size;
+  Ecode_t err = ECODE_NVM3_OK;
+
+  in_repack = true;
+  for (size_t i = 0; i < object_count && err == ECODE_NVM3_OK; i++) {
+    index_entry_t object = objects[i];
+    if (object.offset < page_start || object.offset >= page_end) {
+      continue;
+    }
+    uint8_t buffer[NVM3_DEFAULT_MAX_OBJECT_SIZE];
+    memcpy(buffer, image + object.offset + sizeof(nvm3_image_object_header_t), object.length);
+    err = append_record(object.key, object.type, buffer, object.length);
+  }
+  in_repack = false;
+  if (err != ECODE_NVM3_OK) {
+    return err;
+  }
+
+  erase_page(tail_page);
+  used_pages--;
+  tail_page = (tail_page + 1) % page_count;
+  return ECODE_NVM3_OK;
+}
@@ -0,0 +1,39 @@
+#ifndef NVM3_HOST_H
+#define NVM3_HOST_H
+
+// Configuration and instrumentation of the host NVM3 emulator.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+  const char *image_path;       // NULL keeps the image in anonymous memory
+  uint32_t nvm_size;
+  uint32_t page_size;
+  uint32_t write_ns_per_word;   // simulated program time per 32-bit word
+  uint32_t erase_us_per_page;   // simulated page erase time
+  bool real_time;               // also sleep for the simulated time
+  uint32_t fail_write_after;    // fault injection: writes that succeed before failing, 0 = never
+  bool force_full;              // fault injection: every write reports a full store
+} nvm3_host_config_t;
+
+typedef struct {
+  uint64_t sim_time_ns;         // total simulated flash busy time
+  uint64_t bytes_programmed;
+  uint32_t writes;
+  uint32_t failed_writes;
+  uint32_t page_erases;
+  uint32_t repacks;
+  uint32_t forced_repacks;      // repacks done inside a write because the log was full
+  uint32_t page_count;
+  uint32_t max_page_erase_count;
+  uint32_t min_page_erase_count;
+} nvm3_host_stats_t;
+
+void nvm3_host_default_config(nvm3_host_config_t *config);
+void nvm3_host_configure(const nvm3_host_config_t *config);
+void nvm3_host_get_stats(nvm3_host_stats_t *stats);
+uint32_t nvm3_host_get_page_erase_count(uint32_t page);
+void nvm3_host_close(void);
+
+#endif // NVM3_HOST_H
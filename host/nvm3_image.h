@@ -0,0 +1,43 @@
+#ifndef NVM3_IMAGE_H
+#define NVM3_IMAGE_H
+
+// On-flash layout of the host NVM3 image: a sequence of flash pages, each
+// starting with a page header and followed by a log of 4-byte aligned
+// object records. Erased flash reads as 0xFF.
+
+#include <stdint.h>
+
+#define NVM3_IMAGE_PAGE_MAGIC     0x4733504Eu // "NP3G"
+#define NVM3_IMAGE_ERASED_WORD    0xFFFFFFFFu
+#define NVM3_IMAGE_KEY_MASK       0x000FFFFFu
+#define NVM3_IMAGE_TYPE_SHIFT     20
+#define NVM3_IMAGE_TYPE_DATA      0x0u
+#define NVM3_IMAGE_TYPE_COUNTER   0x1u
+#define NVM3_IMAGE_TYPE_DELETED   0xFu
+
+typedef struct {
+  uint32_t magic;
+  uint32_t erase_count;
+  uint32_t sequence;    // NVM3_IMAGE_ERASED_WORD while the page holds no objects
+  uint32_t reserved;
+} nvm3_image_page_header_t;
+
+typedef struct {
+  uint32_t key_type;    // key in bits 0..19, record type in bits 20..23
+  uint32_t length;      // payload bytes, padded to 4 in flash
+} nvm3_image_object_header_t;
+
+#define NVM3_IMAGE_RECORD_SIZE(len) \
+  (sizeof(nvm3_image_object_header_t) + (((len) + 3u) & ~3u))
+
+static inline uint32_t nvm3_image_key(const nvm3_image_object_header_t *header)
+{
+  return header->key_type & NVM3_IMAGE_KEY_MASK;
+}
+
+static inline uint32_t nvm3_image_type(const nvm3_image_object_header_t *header)
+{
+  return (header->key_type >> NVM3_IMAGE_TYPE_SHIFT) & 0xFu;
+}
+
+#endif // NVM3_IMAGE_H
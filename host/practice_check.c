@@ -0,0 +1,88 @@
+// Checks that a practice game leaves the autosave checkpoint of a normal game
+// alone. A normal game is checkpointed and abandoned by a power cycle, a
+// practice game tops out, and the normal game's "Resume" must still be there.
+// A normal game topping out is run last, to show the check can fail.
+
+#include "autosave.h"
+#include "tetris.h"
+#include "nvm3_host.h"
+#include "sleeptimer_host.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static int failures;
+
+static void expect(bool condition, const char *what)
+{
+  printf("%-52s %s\n", what, condition ? "ok" : "FAIL");
+  if (!condition) {
+    failures++;
+  }
+}
+
+// Runs the main loop long enough for the autosave write budget to allow a write
+static void settle(void)
+{
+  for (int pass = 0; pass < 4; pass++) {
+    sleeptimer_host_advance_ms(20000);
+    tetris_process_action();
+  }
+}
+
+static void drop_until_game_over(void)
+{
+  for (int piece = 0; piece < 200 && tetris_get_game_state() == GAME_STATE_IN_GAME; piece++) {
+    tetris_hard_drop();
+  }
+}
+
+int main(void)
+{
+  // The power cycles need flash that outlives nvm3_initDefault(): an image file
+  char image_path[] = "/tmp/practice_check_XXXXXX";
+  int fd = mkstemp(image_path);
+  if (fd < 0) {
+    perror("mkstemp");
+    return 2;
+  }
+  close(fd);
+
+  nvm3_host_config_t config;
+  nvm3_host_default_config(&config);
+  config.image_path = image_path;
+  nvm3_host_configure(&config);
+
+  tetris_init();
+  tetris_set_practice(false);
+  tetris_start_new_game(1);
+  tetris_hard_drop();
+  tetris_hard_drop();
+  settle();
+  expect(autosave_has_checkpoint(), "normal game checkpointed");
+
+  // Power cycle mid-game: the checkpoint is what the menu offers to resume
+  tetris_init();
+  expect(autosave_has_checkpoint(), "checkpoint survives the power cycle");
+
+  tetris_set_practice(true);
+  tetris_start_new_game(1);
+  drop_until_game_over();
+  expect(tetris_get_game_state() == GAME_STATE_GAME_OVER, "practice game topped out");
+  settle();
+  expect(autosave_has_checkpoint(), "checkpoint survives the practice game over");
+
+  tetris_init();
+  expect(autosave_has_checkpoint(), "checkpoint survives a second power cycle");
+
+  tetris_set_practice(false);
+  tetris_start_new_game(1);
+  drop_until_game_over();
+  settle();
+  expect(!autosave_has_checkpoint(), "normal game over discards the checkpoint");
+
+  nvm3_host_close();
+  unlink(image_path);
+  return failures == 0 ? 0 : 1;
+}
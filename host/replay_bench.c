@@ -0,0 +1,684 @@
+// Macro benchmark: replays a corpus of recorded games through the engine on
+// the virtual sleeptimer clock and reports pieces per second, time per lock
+// and the slowest single event, so that a change which only pays off on the
+// boards real play produces shows up next to the kernel numbers.
+//
+// A corpus file is text: "seed N", "level N" and "hash 0x..." headers, then
+// one "<ms> <action>" line per input with ms counted from the game start and
+// the action one of L, R (shift), U (rotate), D (soft drop) or H (hard drop).
+// Gravity runs in between exactly as on target. The hash is
+// tetris_state_hash() after the last input; a replay that ends anywhere else
+// means the engine no longer plays the game that was recorded.
+//
+// -g writes new corpus files with a built-in player, so the corpus can be
+// regenerated after a change that intentionally alters the game.
+
+#include "tetris.h"
+#include "app_events.h"
+#include "gravity.h"
+#include "stats.h"
+#include "trace.h"
+#include "latency.h"
+#include "diagnostics.h"
+#include "profiler.h"
+#include "recorder.h"
+#include "sl_sleeptimer.h"
+#include "nvm3_host.h"
+#include "glib_host.h"
+#include "sleeptimer_host.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_CORPUS_LINE     128
+#define GEN_MAX_PIECES      250
+#define GEN_MIN_GAP_MS      20      // between two inputs of the generated player
+#define GEN_GAP_SPREAD_MS   40
+#define GEN_PAUSE_PERCENT   8       // pieces the player hesitates on, letting gravity act
+#define GEN_PAUSE_MS        400
+#define TALL_WELL_COLUMN    (BOARD_WIDTH - 1)
+#define RECORDING_BYTES     (1u << 20)
+
+typedef struct {
+  uint32_t ms;
+  char action;
+} corpus_event_t;
+
+typedef struct {
+  const char *path;
+  uint32_t seed;
+  int level;
+  uint32_t hash;
+  bool has_hash;
+  corpus_event_t *events;
+  size_t count;
+} corpus_game_t;
+
+typedef struct {
+  uint32_t pieces;
+  uint32_t lines;
+  uint64_t events;
+  uint64_t wall_ns;       // engine work: inputs, gravity updates and deferred storage jobs
+  uint64_t peak_ns;       // slowest single input or gravity update
+  uint32_t hash;
+} replay_result_t;
+
+typedef enum {
+  STYLE_GREEDY,           // clean stacking, mostly singles and doubles
+  STYLE_TALL,             // keeps a well open and stacks high for multi-line clears
+  STYLE_RANDOM,           // any legal placement, with soft drops: ragged, holey boards
+  STYLE_COUNT
+} bot_style_t;
+
+static const char *const style_names[STYLE_COUNT] = { "greedy", "tall", "random" };
+
+// A copy of the engine's spawn orientations, indexed by color - 1
+static const Point bot_shapes[7][4] = {
+  { {-1, 0}, {0, 0}, {1, 0}, {2, 0} },
+  { {0, 0}, {1, 0}, {0, 1}, {1, 1} },
+  { {-1, 0}, {0, 0}, {1, 0}, {0, 1} },
+  { {1, -1}, {-1, 0}, {0, 0}, {1, 0} },
+  { {-1, -1}, {-1, 0}, {0, 0}, {1, 0} },
+  { {0, 0}, {1, 0}, {-1, 1}, {0, 1} },
+  { {-1, 0}, {0, 0}, {0, 1}, {1, 1} },
+};
+
+typedef struct {
+  bool cells[BOARD_WIDTH][BOARD_HEIGHT];
+} bot_board_t;
+
+typedef struct {
+  int rotations;
+  int dx;
+  int soft_drops;
+  double score;
+} bot_plan_t;
+
+static uint32_t bot_seed = 1;
+static FILE *gen_out;
+static uint64_t game_start_tick;
+static uint32_t recordings_written;
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr,
+          "usage: %s [-n] [-R dir] corpus-file...\n"
+          "       %s -g out-file [-s seed] [-L level] [-p style] [-m pieces]\n"
+          "  -n  do not render: GLIB and DMD calls are counted, nothing is drawn\n"
+          "  -R  also write a game recording (recorder.h) of every replayed game into this directory\n"
+          "  -g  play a game with the built-in player and write it as a corpus file\n"
+          "  -s  game seed for -g (default 1)\n"
+          "  -L  starting level for -g (default 1)\n"
+          "  -p  player style for -g: greedy, tall or random (default greedy)\n"
+          "  -m  stop -g after this many pieces (default %d)\n", argv0, argv0, GEN_MAX_PIECES);
+}
+
+// Same layout as soak -R: the header, then the event bytes
+static void write_recording(const recorder_header_t *header, const uint8_t *events, void *context)
+{
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "%s/game_%04u.rec", (const char *)context, (unsigned)recordings_written++);
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    perror(path);
+    return;
+  }
+  if (fwrite(header, sizeof(*header), 1, file) != 1
+      || fwrite(events, 1, header->length, file) != header->length) {
+    perror(path);
+  }
+  fclose(file);
+}
+
+static uint64_t wall_ns(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+static uint64_t ms_to_ticks(uint64_t ms)
+{
+  return (ms * sl_sleeptimer_get_timer_frequency()) / 1000u;
+}
+
+// --- Engine driver ---
+
+// The part of app_process_action() the engine needs: gravity and flash jobs
+static void process_events(replay_result_t *result)
+{
+  uint32_t events = app_events_take();
+  uint64_t start = wall_ns();
+  if (events & APP_EVENT_GRAVITY) {
+    tetris_update();
+    uint64_t took = wall_ns() - start;
+    if (took > result->peak_ns) {
+      result->peak_ns = took;
+    }
+  }
+  tetris_process_action();
+  result->wall_ns += wall_ns() - start;
+}
+
+// Runs every timer due up to tick, handling the events each one posts
+static void advance_to(uint64_t tick, replay_result_t *result)
+{
+  uint64_t next;
+  while (sleeptimer_host_next_expiry(&next) && next <= tick) {
+    sleeptimer_host_run_until(next);
+    process_events(result);
+  }
+  sleeptimer_host_run_until(tick);
+  if (app_events_pending()) {
+    process_events(result);
+  }
+}
+
+static bool apply_action(char action, replay_result_t *result)
+{
+  uint64_t start = wall_ns();
+  switch (action) {
+    case 'L': tetris_move_left(); break;
+    case 'R': tetris_move_right(); break;
+    case 'U': tetris_rotate(); break;
+    case 'D': tetris_move_down(); break;
+    case 'H': tetris_hard_drop(); break;
+    default: return false;
+  }
+  uint64_t took = wall_ns() - start;
+  result->wall_ns += took;
+  if (took > result->peak_ns) {
+    result->peak_ns = took;
+  }
+  result->events++;
+  return true;
+}
+
+// The game clock moves in GRAVITY_TICK_STEP steps: starting on one makes a
+// game play the same whatever tick the previous game ended on
+static void begin_game(uint32_t seed, int level)
+{
+  game_start_tick = (sleeptimer_host_now() + GRAVITY_TICK_STEP - 1) & ~(uint64_t)(GRAVITY_TICK_STEP - 1);
+  sleeptimer_host_run_until(game_start_tick);
+  tetris_start_seeded_game(level, seed);
+}
+
+// Leaves nothing of the last game behind that could act on the next one
+static void end_game(replay_result_t *result)
+{
+  gravity_stop();
+  tetris_set_game_state(GAME_STATE_MAIN_MENU);
+  replay_result_t discard = { 0 };
+  advance_to(sleeptimer_host_now(), result != NULL ? result : &discard);
+}
+
+// --- Corpus files ---
+
+static bool load_corpus(const char *path, corpus_game_t *game)
+{
+  memset(game, 0, sizeof(*game));
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    return false;
+  }
+  game->path = path;
+  game->seed = TETRIS_DEFAULT_SEED;
+  game->level = 1;
+
+  char line[MAX_CORPUS_LINE];
+  size_t capacity = 0;
+  int line_number = 0;
+  uint32_t last_ms = 0;
+  bool ok = true;
+  while (ok && fgets(line, sizeof(line), file) != NULL) {
+    line_number++;
+    char *comment = strchr(line, '#');
+    if (comment != NULL) {
+      *comment = '\0';
+    }
+    char word[16];
+    unsigned long value;
+    char action;
+    if (sscanf(line, " %15s", word) != 1) {
+      continue; // blank or comment-only line
+    }
+    if (sscanf(line, " seed %lu", &value) == 1) {
+      game->seed = (uint32_t)value;
+    } else if (sscanf(line, " level %lu", &value) == 1) {
+      game->level = (int)value;
+    } else if (sscanf(line, " hash %lx", &value) == 1) {
+      game->hash = (uint32_t)value;
+      game->has_hash = true;
+    } else if (sscanf(line, " %lu %c", &value, &action) == 2 && strchr("LRUDH", action) != NULL) {
+      if (value < last_ms) {
+        fprintf(stderr, "%s:%d: inputs must be in time order\n", path, line_number);
+        ok = false;
+        break;
+      }
+      last_ms = (uint32_t)value;
+      if (game->count == capacity) {
+        capacity = capacity ? capacity * 2 : 256;
+        game->events = realloc(game->events, capacity * sizeof(corpus_event_t));
+        if (game->events == NULL) {
+          ok = false;
+          break;
+        }
+      }
+      game->events[game->count++] = (corpus_event_t){ .ms = last_ms, .action = action };
+    } else {
+      fprintf(stderr, "%s:%d: cannot parse: %s", path, line_number, line);
+      ok = false;
+    }
+  }
+  fclose(file);
+  return ok;
+}
+
+static void replay_game(const corpus_game_t *game, replay_result_t *result)
+{
+  memset(result, 0, sizeof(*result));
+  uint32_t pieces_before = stats_get(STATS_PIECES_PLACED);
+  uint32_t lines_before = stats_get(STATS_LINES_CLEARED);
+
+  begin_game(game->seed, game->level);
+  for (size_t i = 0; i < game->count; i++) {
+    advance_to(game_start_tick + ms_to_ticks(game->events[i].ms), result);
+    apply_action(game->events[i].action, result);
+  }
+  result->hash = tetris_state_hash();
+  result->pieces = stats_get(STATS_PIECES_PLACED) - pieces_before;
+  result->lines = stats_get(STATS_LINES_CLEARED) - lines_before;
+  end_game(result);
+}
+
+// --- Built-in player ---
+
+static uint32_t bot_random(uint32_t bound)
+{
+  bot_seed ^= bot_seed << 13;
+  bot_seed ^= bot_seed >> 17;
+  bot_seed ^= bot_seed << 5;
+  return bot_seed % bound;
+}
+
+static void bot_read_board(bot_board_t *model, int *piece)
+{
+  tetris_snapshot_t snap;
+  tetris_snapshot_take(&snap);
+  for (int x = 0; x < BOARD_WIDTH; x++) {
+    for (int y = 0; y < BOARD_HEIGHT; y++) {
+      int index = x * BOARD_HEIGHT + y;
+      uint8_t packed = snap.cells[index / 2];
+      model->cells[x][y] = ((index & 1) ? (packed >> 4) : (packed & 0x0F)) != 0;
+    }
+  }
+  *piece = snap.current_piece;
+}
+
+static bool bot_collides(const bot_board_t *model, const Point blocks[4], int px, int py)
+{
+  for (int i = 0; i < 4; i++) {
+    int x = px + blocks[i].x;
+    int y = py + blocks[i].y;
+    if (x < 0 || x >= BOARD_WIDTH || y >= BOARD_HEIGHT || (y >= 0 && model->cells[x][y])) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Places the piece on a copy of the board and scores the result; false when
+// the path from the spawn position is blocked
+static bool bot_evaluate(const bot_board_t *model, int piece, int rotations, int dx,
+                         bot_style_t style, double *score)
+{
+  Point blocks[4];
+  memcpy(blocks, bot_shapes[piece - 1], sizeof(blocks));
+  int px = BOARD_WIDTH / 2 - 1;
+  int py = 0;
+  for (int r = 0; r < rotations; r++) {
+    Point rotated[4];
+    for (int i = 0; i < 4; i++) {
+      rotated[i].x = -blocks[i].y;
+      rotated[i].y = blocks[i].x;
+    }
+    if (bot_collides(model, rotated, px, py)) {
+      return false;
+    }
+    memcpy(blocks, rotated, sizeof(blocks));
+  }
+  int step = dx < 0 ? -1 : 1;
+  for (int moved = 0; moved != dx; moved += step) {
+    if (bot_collides(model, blocks, px + step, py)) {
+      return false;
+    }
+    px += step;
+  }
+  while (!bot_collides(model, blocks, px, py + 1)) {
+    py++;
+  }
+
+  bot_board_t placed = *model;
+  for (int i = 0; i < 4; i++) {
+    if (py + blocks[i].y >= 0) {
+      placed.cells[px + blocks[i].x][py + blocks[i].y] = true;
+    }
+  }
+  int lines = 0;
+  for (int y = BOARD_HEIGHT - 1; y >= 0; y--) {
+    bool full = true;
+    for (int x = 0; x < BOARD_WIDTH && full; x++) {
+      full = placed.cells[x][y];
+    }
+    if (!full) {
+      continue;
+    }
+    lines++;
+    for (int x = 0; x < BOARD_WIDTH; x++) {
+      memmove(&placed.cells[x][1], &placed.cells[x][0], (size_t)y * sizeof(bool));
+      placed.cells[x][0] = false;
+    }
+    y++; // look at the row that moved down into this one
+  }
+
+  int heights[BOARD_WIDTH];
+  int aggregate = 0;
+  int holes = 0;
+  for (int x = 0; x < BOARD_WIDTH; x++) {
+    heights[x] = 0;
+    for (int y = 0; y < BOARD_HEIGHT; y++) {
+      if (placed.cells[x][y]) {
+        if (heights[x] == 0) {
+          heights[x] = BOARD_HEIGHT - y;
+        }
+      } else if (heights[x] != 0) {
+        holes++;
+      }
+    }
+    aggregate += heights[x];
+  }
+  int bumpiness = 0;
+  int last_column = style == STYLE_TALL ? TALL_WELL_COLUMN - 1 : BOARD_WIDTH - 1;
+  for (int x = 0; x < last_column; x++) {
+    bumpiness += abs(heights[x] - heights[x + 1]);
+  }
+
+  if (style == STYLE_TALL) {
+    double clears = lines >= 2 ? 3.0 * lines * lines : -1.0 * lines;
+    double well = heights[TALL_WELL_COLUMN] > 0 ? -3.0 : 0.0;
+    *score = clears + well - 0.3 * aggregate - 0.7 * holes - 0.2 * bumpiness;
+  } else {
+    *score = -0.51 * aggregate + 0.76 * lines - 0.36 * holes - 0.18 * bumpiness;
+  }
+  return true;
+}
+
+static bool bot_plan(bot_style_t style, bot_plan_t *plan)
+{
+  bot_board_t model;
+  int piece;
+  bot_read_board(&model, &piece);
+  if (piece < 1 || piece > 7) {
+    return false;
+  }
+  int max_rotations = piece == 2 ? 1 : 4; // the engine never rotates O
+
+  if (style == STYLE_RANDOM) {
+    for (int attempt = 0; attempt < 16; attempt++) {
+      double ignored;
+      plan->rotations = (int)bot_random((uint32_t)max_rotations);
+      plan->dx = (int)bot_random(BOARD_WIDTH) - BOARD_WIDTH / 2;
+      plan->soft_drops = (int)bot_random(4);
+      if (bot_evaluate(&model, piece, plan->rotations, plan->dx, style, &ignored)) {
+        return true;
+      }
+    }
+    plan->rotations = 0;
+    plan->dx = 0;
+    return true;
+  }
+
+  bool found = false;
+  for (int r = 0; r < max_rotations; r++) {
+    for (int dx = -BOARD_WIDTH / 2; dx <= BOARD_WIDTH / 2; dx++) {
+      double score;
+      if (bot_evaluate(&model, piece, r, dx, style, &score) && (!found || score > plan->score)) {
+        *plan = (bot_plan_t){ .rotations = r, .dx = dx, .soft_drops = 0, .score = score };
+        found = true;
+      }
+    }
+  }
+  if (!found) {
+    *plan = (bot_plan_t){ 0 };
+  }
+  return true;
+}
+
+// Plays one input at ms after the game start and appends it to the corpus file
+static bool bot_input(uint32_t *ms, char action, replay_result_t *result)
+{
+  *ms += GEN_MIN_GAP_MS + bot_random(GEN_GAP_SPREAD_MS);
+  advance_to(game_start_tick + ms_to_ticks(*ms), result);
+  if (tetris_get_game_state() != GAME_STATE_IN_GAME) {
+    return false;
+  }
+  fprintf(gen_out, "%u %c\n", *ms, action);
+  apply_action(action, result);
+  return tetris_get_game_state() == GAME_STATE_IN_GAME;
+}
+
+static int generate(const char *path, uint32_t seed, int level, bot_style_t style, uint32_t max_pieces)
+{
+  gen_out = fopen(path, "w");
+  if (gen_out == NULL) {
+    perror(path);
+    return 1;
+  }
+  bot_seed = seed * 2654435761u + 1u;
+  fprintf(gen_out, "# generated by replay_bench -g, player %s, at most %u pieces\n", style_names[style], max_pieces);
+  fprintf(gen_out, "seed %u\nlevel %d\n", seed, level);
+
+  replay_result_t result = { 0 };
+  uint32_t pieces_before = stats_get(STATS_PIECES_PLACED);
+  uint32_t ms = 0;
+  begin_game(seed, level);
+  bool playing = true;
+  while (playing && stats_get(STATS_PIECES_PLACED) - pieces_before < max_pieces) {
+    bot_plan_t plan = { 0 };
+    if (!bot_plan(style, &plan)) {
+      break;
+    }
+    if (bot_random(100) < GEN_PAUSE_PERCENT) {
+      ms += bot_random(GEN_PAUSE_MS);
+    }
+    for (int r = 0; playing && r < plan.rotations; r++) {
+      playing = bot_input(&ms, 'U', &result);
+    }
+    for (int moved = 0; playing && moved != plan.dx; moved += plan.dx < 0 ? -1 : 1) {
+      playing = bot_input(&ms, plan.dx < 0 ? 'L' : 'R', &result);
+    }
+    for (int d = 0; playing && d < plan.soft_drops; d++) {
+      playing = bot_input(&ms, 'D', &result);
+    }
+    if (playing) {
+      playing = bot_input(&ms, 'H', &result);
+    }
+  }
+  uint32_t pieces = stats_get(STATS_PIECES_PLACED) - pieces_before;
+  fprintf(gen_out, "hash 0x%08x\n", (unsigned)tetris_state_hash());
+  fclose(gen_out);
+  printf("%s: %u pieces, %u events, %s\n", path, pieces, (unsigned)result.events,
+         tetris_get_game_state() == GAME_STATE_GAME_OVER ? "topped out" : "piece limit");
+  end_game(NULL);
+  return 0;
+}
+
+// --- Report ---
+
+#if PROFILER_ENABLE
+static const struct {
+  profile_zone_t zone;
+  const char *name;
+} phases[] = {
+  { PROFILE_ZONE_COLLISION, "collision" },
+  { PROFILE_ZONE_CLEAR_LINES, "clear_lines" },
+  { PROFILE_ZONE_DRAW_BOARD, "draw_board" },
+  { PROFILE_ZONE_DISPLAY_UPDATE, "display_update" },
+  { PROFILE_ZONE_NVM3_READ, "nvm3_read" },
+  { PROFILE_ZONE_NVM3_WRITE, "nvm3_write" },
+  { PROFILE_ZONE_NVM3_REPACK, "nvm3_repack" },
+};
+#define PHASE_COUNT ((int)(sizeof(phases) / sizeof(phases[0])))
+
+static void phase_totals(uint64_t totals[PHASE_COUNT], uint32_t counts[PHASE_COUNT])
+{
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    profile_zone_stats_t stats;
+    profiler_get_zone(phases[i].zone, &stats);
+    totals[i] = stats.total;
+    counts[i] = stats.count;
+  }
+}
+#endif
+
+static void print_row(const char *name, const replay_result_t *r, const char *verdict)
+{
+  double seconds = r->wall_ns / 1e9;
+  printf("%-24s %7u %6u %8.3f %11.0f %10.2f %10.2f  %s\n", name, r->pieces, r->lines, r->wall_ns / 1e6,
+         seconds > 0 ? r->pieces / seconds : 0.0,
+         r->pieces > 0 ? r->wall_ns / 1e3 / r->pieces : 0.0,
+         r->peak_ns / 1e3, verdict);
+}
+
+int main(int argc, char **argv)
+{
+  glib_host_config_t render = { 0 };
+  recorder_config_t recording = { 0 };
+  const char *gen_path = NULL;
+  uint32_t gen_seed = 1;
+  int gen_level = 1;
+  bot_style_t gen_style = STYLE_GREEDY;
+  uint32_t gen_pieces = GEN_MAX_PIECES;
+  int first_file = argc;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-n") == 0) {
+      render.discard = true;
+    } else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc) {
+      recording.write = write_recording;
+      recording.context = argv[++i];
+      recording.buffer_bytes = RECORDING_BYTES;
+      recording.buffer = malloc(RECORDING_BYTES);
+    } else if (strcmp(argv[i], "-g") == 0 && i + 1 < argc) {
+      gen_path = argv[++i];
+    } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      gen_seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-L") == 0 && i + 1 < argc) {
+      gen_level = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+      gen_pieces = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+      const char *name = argv[++i];
+      for (gen_style = 0; gen_style < STYLE_COUNT && strcmp(style_names[gen_style], name) != 0; gen_style++) {
+      }
+      if (gen_style == STYLE_COUNT) {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (argv[i][0] != '-') {
+      first_file = i;
+      break;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (gen_path == NULL && first_file == argc) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  nvm3_host_config_t nvm;
+  nvm3_host_default_config(&nvm);
+  nvm3_host_configure(&nvm);
+  glib_host_configure(&render);
+  recorder_configure(&recording);
+  trace_init();
+  latency_init();
+  app_events_init();
+  diagnostics_init();
+  tetris_init();
+  profiler_init();
+
+  if (gen_path != NULL) {
+    int status = generate(gen_path, gen_seed, gen_level, gen_style, gen_pieces);
+    nvm3_host_close();
+    return status;
+  }
+
+#if PROFILER_ENABLE
+  uint64_t phase_start[PHASE_COUNT];
+  uint64_t phase_end[PHASE_COUNT];
+  uint32_t count_start[PHASE_COUNT];
+  uint32_t count_end[PHASE_COUNT];
+  phase_totals(phase_start, count_start);
+#endif
+
+  printf("%-24s %7s %6s %8s %11s %10s %10s\n", "game", "pieces", "lines", "ms", "pieces/s", "us/lock", "peak us");
+  replay_result_t total = { 0 };
+  int mismatches = 0;
+  for (int i = first_file; i < argc; i++) {
+    corpus_game_t game;
+    if (!load_corpus(argv[i], &game)) {
+      free(game.events);
+      nvm3_host_close();
+      return 1;
+    }
+    replay_result_t result;
+    replay_game(&game, &result);
+    const char *verdict = "no hash";
+    if (game.has_hash) {
+      verdict = result.hash == game.hash ? "ok" : "HASH MISMATCH";
+      mismatches += result.hash != game.hash;
+    }
+    const char *name = strrchr(game.path, '/');
+    print_row(name != NULL ? name + 1 : game.path, &result, verdict);
+    if (game.has_hash && result.hash != game.hash) {
+      printf("  expected 0x%08x, replay ended at 0x%08x\n", (unsigned)game.hash, (unsigned)result.hash);
+    }
+
+    total.pieces += result.pieces;
+    total.lines += result.lines;
+    total.events += result.events;
+    total.wall_ns += result.wall_ns;
+    if (result.peak_ns > total.peak_ns) {
+      total.peak_ns = result.peak_ns;
+    }
+    free(game.events);
+  }
+  print_row("total", &total, render.discard ? "(not rendered)" : "");
+
+#if PROFILER_ENABLE
+  phase_totals(phase_end, count_end);
+  printf("\n%-24s %10s %10s %7s\n", "phase", "calls", "ms", "share");
+  for (int i = 0; i < PHASE_COUNT; i++) {
+    uint64_t spent = phase_end[i] - phase_start[i];
+    printf("%-24s %10u %10.3f %6.1f%%\n", phases[i].name, count_end[i] - count_start[i], spent / 1e6,
+           total.wall_ns > 0 ? 100.0 * spent / total.wall_ns : 0.0);
+  }
+#else
+  printf("\nbuild with -DPROFILER_ENABLE=1 for the time spent per phase\n");
+#endif
+
+  free(recording.buffer);
+  nvm3_host_close();
+  if (mismatches > 0) {
+    fprintf(stderr, "%d game(s) did not replay to their recorded hash\n", mismatches);
+    return 1;
+  }
+  return 0;
+}
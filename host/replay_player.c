@@ -0,0 +1,718 @@
+// Plays game recordings (recorder.h) back through the engine on the virtual
+// sleeptimer clock and checks every state hash they carry. Inputs land on the
+// tick they were made on and each gravity step on the tick it ran on, worked
+// out from the engine's own gravity deadline and the logged lag, so a
+// recording made on target replays exactly as long as the engine has not
+// changed how it plays.
+//
+// Recordings come from files (soak -R writes them) or, with -i, from the
+// NVM3 ring in a flash image. The image is copied first: replaying saves
+// high scores and stats like any game does.
+//
+// -K turns a recording into a seekable file (seekable_replay.h), -S seeks
+// into one, and -B measures seek latency and file size against the keyframe
+// interval. Practice games replay their rewinds but are not made seekable.
+
+#include "tetris.h"
+#include "app_events.h"
+#include "gravity.h"
+#include "recorder.h"
+#include "stats.h"
+#include "trace.h"
+#include "latency.h"
+#include "diagnostics.h"
+#include "profiler.h"
+#include "sl_sleeptimer.h"
+#include "nvm3_host.h"
+#include "glib_host.h"
+#include "sleeptimer_host.h"
+#include "seekable_replay.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_SEEKS       200
+#define BENCH_SEED        0x9E3779B9u
+
+static const uint32_t bench_intervals[] = { 0, 10, 20, 50, 100, 200 };
+
+typedef struct {
+  char name[64];
+  recorder_header_t header;
+  uint8_t *events;
+} recording_t;
+
+typedef struct {
+  recorder_reader_t reader;
+  uint32_t pieces_base;   // stats counter value at piece 0 of this game
+  uint32_t run_left;      // on-time gravity steps still to play from a run
+  uint32_t events;
+  uint32_t hashes_checked;
+  bool ended;
+  bool diverged;
+  size_t diverged_at;     // event byte offset of the first hash that did not match
+  bool verbose;
+} player_t;
+
+typedef enum {
+  STEP_PLAYED,            // one engine call
+  STEP_HASH,              // a hash that matched; the state is at a lock boundary
+  STEP_END,               // end marker, divergence, or no events left
+} step_t;
+
+typedef struct {
+  void *base;
+  size_t size;
+  const seekable_header_t *header;
+  const seekable_index_t *index;
+  const uint8_t *events;
+} seekable_map_t;
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr,
+          "usage: %s [-v] recording-file...\n"
+          "       %s [-v] -i image\n"
+          "       %s -K interval -o out-file recording-file\n"
+          "       %s -S piece seekable-file\n"
+          "       %s -B recording-file...\n"
+          "  -i  replay the recordings kept in this NVM3 image, newest first\n"
+          "  -v  print every event\n"
+          "  -K  write a seekable file with a keyframe every interval pieces (a multiple of %d, 0 = none)\n"
+          "  -S  seek to just after this piece locked and print the state\n"
+          "  -B  measure seek latency and size overhead for keyframe intervals 0 to %u\n",
+          argv0, argv0, argv0, argv0, argv0, RECORDER_HASH_INTERVAL,
+          (unsigned)bench_intervals[sizeof(bench_intervals) / sizeof(bench_intervals[0]) - 1]);
+}
+
+static uint64_t wall_ns(void)
+{
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec;
+}
+
+// --- Engine driver ---
+
+// Timers still run, but a gravity event they post is not acted on: the
+// recording says when tetris_update() ran
+static void advance_to(uint64_t tick)
+{
+  uint64_t next;
+  while (sleeptimer_host_next_expiry(&next) && next <= tick) {
+    sleeptimer_host_run_until(next);
+    app_events_take();
+    tetris_process_action();
+  }
+  sleeptimer_host_run_until(tick);
+  if (app_events_pending()) {
+    app_events_take();
+    tetris_process_action();
+  }
+}
+
+// The 64-bit host tick of a 32-bit engine tick that lies at or after now,
+// or just before it for a gravity step logged with a negative lag
+static uint64_t host_tick(uint32_t tick)
+{
+  uint64_t now = sleeptimer_host_now();
+  return now + (int64_t)(int32_t)(tick - (uint32_t)now);
+}
+
+static void run_gravity(int32_t lag)
+{
+  uint64_t tick = host_tick(gravity_get_due_tick() + (uint32_t)lag * GRAVITY_TICK_STEP);
+  if (tick > sleeptimer_host_now()) {
+    advance_to(tick);
+  }
+  tetris_update();
+}
+
+static void apply_input(const recorder_event_t *event)
+{
+  advance_to(sleeptimer_host_now() + (uint64_t)event->delta * GRAVITY_TICK_STEP);
+  switch (event->type) {
+    case RECORDER_EVENT_LEFT: tetris_move_left(); break;
+    case RECORDER_EVENT_RIGHT: tetris_move_right(); break;
+    case RECORDER_EVENT_ROTATE: tetris_rotate(); break;
+    case RECORDER_EVENT_SOFT_DROP: tetris_move_down(); break;
+    case RECORDER_EVENT_HARD_DROP: tetris_hard_drop(); break;
+    case RECORDER_EVENT_SHIFT: tetris_shift(event->dx, event->max_cells); break;
+    case RECORDER_EVENT_PAUSE: tetris_pause_game(); break;
+    case RECORDER_EVENT_RESUME: tetris_resume_game(); break;
+    case RECORDER_EVENT_REWIND: tetris_rewind(); break;
+    default: break;
+  }
+}
+
+static void player_start(player_t *player, const recorder_header_t *header, const uint8_t *events, bool verbose)
+{
+  memset(player, 0, sizeof(*player));
+  player->reader.data = events;
+  player->reader.length = header->length;
+  player->verbose = verbose;
+  tetris_set_practice((header->flags & RECORDER_FLAG_PRACTICE) != 0);
+  tetris_start_seeded_game(header->level, header->seed);
+  player->pieces_base = stats_get(STATS_PIECES_PLACED);
+}
+
+static uint32_t player_pieces(const player_t *player)
+{
+  return stats_get(STATS_PIECES_PLACED) - player->pieces_base;
+}
+
+// Plays the recording one engine call at a time, so a seek can stop inside a
+// run of gravity steps
+static step_t player_step(player_t *player)
+{
+  if (player->run_left > 0) {
+    player->run_left--;
+    run_gravity(0);
+    return STEP_PLAYED;
+  }
+  if (player->ended || player->diverged) {
+    return STEP_END;
+  }
+  size_t offset = player->reader.offset;
+  recorder_event_t event;
+  if (!recorder_read_event(&player->reader, &event)) {
+    return STEP_END;
+  }
+  player->events++;
+  if (player->verbose) {
+    printf("  @%-5zu type=%d delta=%u lag=%d count=%u shift=%d/%u hash=0x%08x\n", offset, (int)event.type,
+           (unsigned)event.delta, (int)event.lag, (unsigned)event.count, event.dx, event.max_cells,
+           (unsigned)event.hash);
+  }
+  switch (event.type) {
+    case RECORDER_EVENT_GRAVITY:
+      run_gravity(event.lag);
+      return STEP_PLAYED;
+    case RECORDER_EVENT_GRAVITY_RUN:
+      player->run_left = event.count;
+      return player_step(player);
+    case RECORDER_EVENT_HASH:
+      player->hashes_checked++;
+      if (tetris_state_hash() != event.hash) {
+        player->diverged = true;
+        player->diverged_at = offset;
+        return STEP_END;
+      }
+      return STEP_HASH;
+    case RECORDER_EVENT_END:
+      player->ended = true;
+      return STEP_END;
+    default:
+      apply_input(&event);
+      return STEP_PLAYED;
+  }
+}
+
+// Leaves nothing of the last game behind that could act on the next one
+static void end_game(void)
+{
+  gravity_stop();
+  tetris_set_game_state(GAME_STATE_MAIN_MENU);
+  advance_to(sleeptimer_host_now());
+}
+
+// --- Recording sources ---
+
+static bool load_file(const char *path, recording_t *recording)
+{
+  memset(recording, 0, sizeof(*recording));
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    perror(path);
+    return false;
+  }
+  const char *base = strrchr(path, '/');
+  snprintf(recording->name, sizeof(recording->name), "%s", base != NULL ? base + 1 : path);
+  bool ok = fread(&recording->header, sizeof(recording->header), 1, file) == 1
+            && recording->header.magic == RECORDER_MAGIC
+            && recording->header.version == RECORDER_VERSION
+            && (recording->events = malloc(recording->header.length + 1u)) != NULL
+            && fread(recording->events, 1, recording->header.length, file) == recording->header.length;
+  fclose(file);
+  if (!ok) {
+    fprintf(stderr, "%s: not a version %d recording\n", path, RECORDER_VERSION);
+  }
+  return ok;
+}
+
+static bool copy_image(const char *from, char *to, size_t to_size)
+{
+  snprintf(to, to_size, "/tmp/replay_player_XXXXXX");
+  int fd = mkstemp(to);
+  FILE *in = fopen(from, "rb");
+  FILE *out = fd >= 0 ? fdopen(fd, "wb") : NULL;
+  bool ok = in != NULL && out != NULL;
+  char block[4096];
+  size_t bytes;
+  while (ok && (bytes = fread(block, 1, sizeof(block), in)) > 0) {
+    ok = fwrite(block, 1, bytes, out) == bytes;
+  }
+  if (in == NULL) {
+    perror(from);
+  }
+  if (in != NULL) {
+    fclose(in);
+  }
+  if (out != NULL) {
+    fclose(out);
+  }
+  return ok;
+}
+
+// --- Verifying replays ---
+
+static bool verify(const recording_t *recording, bool verbose)
+{
+  const recorder_header_t *header = &recording->header;
+  player_t player;
+  player_start(&player, header, recording->events, verbose);
+  while (player_step(&player) != STEP_END) {
+  }
+  uint32_t pieces = player_pieces(&player);
+  uint32_t final_hash = tetris_state_hash();
+  end_game();
+
+  uint64_t ms;
+  sl_sleeptimer_tick64_to_ms(header->ticks, &ms);
+  const char *verdict;
+  bool truncated = (header->flags & RECORDER_FLAG_TRUNCATED) != 0;
+  if (player.diverged) {
+    verdict = "DIVERGED";
+  } else if (!player.ended) {
+    verdict = "CORRUPT";     // the event bytes stop before the end marker
+  } else if (truncated) {
+    verdict = "truncated";   // every hash in the log matched; the game went on past it
+  } else if (final_hash != header->final_hash || pieces != header->pieces) {
+    verdict = "DIVERGED";
+  } else {
+    verdict = "ok";
+  }
+  printf("replay %s seed=0x%08x level=%u pieces=%u/%u events=%u bytes=%u seconds=%.1f bytes_per_min=%.0f hashes=%u %s",
+         recording->name, (unsigned)header->seed, header->level, pieces, (unsigned)header->pieces,
+         player.events, (unsigned)header->length, ms / 1000.0, ms > 0 ? header->length * 60000.0 / ms : 0.0,
+         player.hashes_checked, verdict);
+  if (player.diverged) {
+    printf(" at=%zu", player.diverged_at);
+  }
+  printf("\n");
+  return strcmp(verdict, "ok") == 0 || strcmp(verdict, "truncated") == 0;
+}
+
+// --- Seekable files ---
+
+// Replays the whole game and keeps a keyframe at every interval-th piece
+static bool write_seekable(const recording_t *recording, uint32_t interval, const char *path)
+{
+  const recorder_header_t *header = &recording->header;
+  if (header->flags & RECORDER_FLAG_PRACTICE) {
+    // A rewind needs the pieces before it, which no keyframe carries
+    fprintf(stderr, "%s: practice games cannot be made seekable\n", recording->name);
+    return false;
+  }
+  uint32_t capacity = interval > 0 ? header->pieces / interval + 1 : 0;
+  seekable_index_t *index = calloc(capacity + 1, sizeof(seekable_index_t));
+  seekable_keyframe_t *keyframes = calloc(capacity + 1, sizeof(seekable_keyframe_t));
+  uint32_t count = 0;
+
+  player_t player;
+  player_start(&player, header, recording->events, false);
+  uint64_t start_tick = sleeptimer_host_now();
+  step_t step;
+  while ((step = player_step(&player)) != STEP_END) {
+    uint32_t pieces = player_pieces(&player);
+    game_state_t state = tetris_get_game_state();
+    if (step != STEP_HASH || interval == 0 || pieces == 0 || pieces % interval != 0 || count == capacity
+        || (state != GAME_STATE_IN_GAME && state != GAME_STATE_PAUSED)) {
+      continue;
+    }
+    seekable_keyframe_t *keyframe = &keyframes[count];
+    tetris_snapshot_take(&keyframe->snapshot);
+    gravity_save(&keyframe->gravity);
+    keyframe->game_state = state;
+    keyframe->hash = tetris_state_hash();
+    index[count].pieces = pieces;
+    index[count].event_offset = (uint32_t)player.reader.offset;
+    index[count].ticks = (uint32_t)(sleeptimer_host_now() - start_tick);
+    count++;
+  }
+  end_game();
+  if (player.diverged) {
+    fprintf(stderr, "%s: diverged at byte %zu, no seekable file written\n", recording->name, player.diverged_at);
+    free(index);
+    free(keyframes);
+    return false;
+  }
+
+  seekable_header_t file_header = {
+    .magic = SEEKABLE_MAGIC,
+    .version = SEEKABLE_VERSION,
+    .recording = *header,
+    .interval = interval,
+    .keyframe_count = count,
+    .index_offset = sizeof(seekable_header_t),
+    .keyframes_offset = sizeof(seekable_header_t) + count * sizeof(seekable_index_t),
+    .keyframe_bytes = sizeof(seekable_keyframe_t),
+  };
+  file_header.events_offset = file_header.keyframes_offset + count * sizeof(seekable_keyframe_t);
+  for (uint32_t k = 0; k < count; k++) {
+    index[k].keyframe_offset = file_header.keyframes_offset + k * sizeof(seekable_keyframe_t);
+  }
+
+  FILE *file = fopen(path, "wb");
+  bool ok = file != NULL
+            && fwrite(&file_header, sizeof(file_header), 1, file) == 1
+            && fwrite(index, sizeof(seekable_index_t), count, file) == count
+            && fwrite(keyframes, sizeof(seekable_keyframe_t), count, file) == count
+            && fwrite(recording->events, 1, header->length, file) == header->length;
+  if (file == NULL || !ok) {
+    perror(path);
+  }
+  if (file != NULL) {
+    ok = fclose(file) == 0 && ok;
+  }
+  free(index);
+  free(keyframes);
+  return ok;
+}
+
+static bool map_seekable(const char *path, seekable_map_t *map)
+{
+  memset(map, 0, sizeof(*map));
+  int fd = open(path, O_RDONLY);
+  struct stat info;
+  if (fd < 0 || fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(seekable_header_t)) {
+    perror(path);
+    if (fd >= 0) {
+      close(fd);
+    }
+    return false;
+  }
+  map->size = (size_t)info.st_size;
+  map->base = mmap(NULL, map->size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map->base == MAP_FAILED) {
+    perror(path);
+    map->base = NULL;
+    return false;
+  }
+
+  const seekable_header_t *header = map->base;
+  uint64_t index_end = header->index_offset + (uint64_t)header->keyframe_count * sizeof(seekable_index_t);
+  uint64_t keyframes_end = header->keyframes_offset + (uint64_t)header->keyframe_count * sizeof(seekable_keyframe_t);
+  if (header->magic != SEEKABLE_MAGIC || header->version != SEEKABLE_VERSION
+      || header->keyframe_bytes != sizeof(seekable_keyframe_t)
+      || header->recording.version != RECORDER_VERSION
+      || index_end > map->size || keyframes_end > map->size
+      || header->events_offset + (uint64_t)header->recording.length > map->size
+      || header->index_offset % 8 != 0 || header->keyframes_offset % 8 != 0) {
+    fprintf(stderr, "%s: not a version %d seekable replay\n", path, SEEKABLE_VERSION);
+    munmap(map->base, map->size);
+    map->base = NULL;
+    return false;
+  }
+  map->header = header;
+  map->index = (const seekable_index_t *)((const uint8_t *)map->base + header->index_offset);
+  map->events = (const uint8_t *)map->base + header->events_offset;
+  return true;
+}
+
+// Puts the engine right after piece target locked: one index lookup for the
+// last keyframe at or before it, then the events since. Piece 0 is the start.
+static bool seek(const seekable_map_t *map, uint32_t target, player_t *player, uint32_t *keyframe_used)
+{
+  const seekable_header_t *header = map->header;
+  uint32_t k = header->interval > 0 ? target / header->interval : 0;
+  if (k > header->keyframe_count) {
+    k = header->keyframe_count;
+  }
+  player_start(player, &header->recording, map->events, false);
+  *keyframe_used = k;
+  if (k > 0) {
+    const seekable_index_t *entry = &map->index[k - 1];
+    const seekable_keyframe_t *keyframe = (const seekable_keyframe_t *)((const uint8_t *)map->base + entry->keyframe_offset);
+    if (entry->keyframe_offset + (uint64_t)sizeof(*keyframe) > map->size
+        || entry->event_offset > header->recording.length
+        || !tetris_snapshot_restore(&keyframe->snapshot)) {
+      return false;
+    }
+    tetris_set_game_state((game_state_t)keyframe->game_state);
+    gravity_restore(&keyframe->gravity, keyframe->snapshot.level);
+    player->reader.offset = entry->event_offset;
+    player->pieces_base -= entry->pieces;
+    if (tetris_state_hash() != keyframe->hash) {
+      return false;
+    }
+  }
+  while (player_pieces(player) < target) {
+    if (player_step(player) == STEP_END) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static int seek_command(const char *path, uint32_t target)
+{
+  seekable_map_t map;
+  if (!map_seekable(path, &map)) {
+    return 1;
+  }
+  player_t player;
+  uint32_t keyframe;
+  uint64_t start = wall_ns();
+  bool ok = seek(&map, target, &player, &keyframe);
+  uint64_t took = wall_ns() - start;
+  tetris_snapshot_t snap;
+  tetris_snapshot_take(&snap);
+  if (ok) {
+    printf("seek %s piece=%u keyframe=%u events=%u us=%.1f hash=0x%08x score=%ld lines=%u level=%u\n",
+           path, target, keyframe, player.events, took / 1000.0, (unsigned)tetris_state_hash(),
+           (long)snap.score, snap.lines_cleared, snap.level);
+  } else {
+    fprintf(stderr, "seek %s piece=%u: the recording %s\n", path, target,
+            player.diverged ? "diverged" : "has fewer pieces");
+  }
+  end_game();
+  munmap(map.base, map.size);
+  return ok ? 0 : 1;
+}
+
+// --- Seek benchmark ---
+
+static uint32_t bench_random(uint32_t *state, uint32_t bound)
+{
+  *state ^= *state << 13;
+  *state ^= *state >> 17;
+  *state ^= *state << 5;
+  return *state % bound;
+}
+
+// The state hash right after every lock, from one straight replay
+static uint32_t *reference_hashes(const recording_t *recording, uint32_t *pieces, uint64_t *took_ns)
+{
+  uint32_t *hashes = calloc(recording->header.pieces + 2u, sizeof(uint32_t));
+  player_t player;
+  uint64_t start = wall_ns();
+  player_start(&player, &recording->header, recording->events, false);
+  *pieces = 0;
+  hashes[0] = tetris_state_hash();
+  while (player_step(&player) != STEP_END) {
+    uint32_t now = player_pieces(&player);
+    if (now != *pieces && now <= recording->header.pieces) {
+      *pieces = now;
+      hashes[now] = tetris_state_hash();
+    }
+  }
+  *took_ns = wall_ns() - start;
+  end_game();
+  if (player.diverged) {
+    free(hashes);
+    return NULL;
+  }
+  return hashes;
+}
+
+static bool bench(const recording_t *recording)
+{
+  uint32_t pieces;
+  uint64_t straight_ns;
+  uint32_t *hashes = reference_hashes(recording, &pieces, &straight_ns);
+  if (hashes == NULL || pieces == 0) {
+    fprintf(stderr, "%s: %s\n", recording->name, hashes == NULL ? "diverged" : "no pieces");
+    free(hashes);
+    return false;
+  }
+  size_t recording_bytes = sizeof(recorder_header_t) + recording->header.length;
+  printf("bench %s pieces=%u bytes=%zu straight_replay_ms=%.2f\n",
+         recording->name, pieces, recording_bytes, straight_ns / 1e6);
+  printf("  interval keyframes      bytes overhead  seek_mean_us  seek_max_us  events_mean  mismatches\n");
+
+  bool ok = true;
+  for (size_t i = 0; i < sizeof(bench_intervals) / sizeof(bench_intervals[0]); i++) {
+    char path[] = "/tmp/replay_seek_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+      perror(path);
+      ok = false;
+      break;
+    }
+    close(fd);
+    seekable_map_t map;
+    if (!write_seekable(recording, bench_intervals[i], path) || !map_seekable(path, &map)) {
+      unlink(path);
+      ok = false;
+      break;
+    }
+
+    uint32_t rng = BENCH_SEED;
+    uint64_t total_ns = 0;
+    uint64_t max_ns = 0;
+    uint64_t events = 0;
+    uint32_t mismatches = 0;
+    for (int s = 0; s < BENCH_SEEKS; s++) {
+      uint32_t target = 1 + bench_random(&rng, pieces);
+      player_t player;
+      uint32_t keyframe;
+      uint64_t start = wall_ns();
+      bool reached = seek(&map, target, &player, &keyframe);
+      uint64_t took = wall_ns() - start;
+      if (!reached || tetris_state_hash() != hashes[target]) {
+        mismatches++;
+      }
+      end_game();
+      total_ns += took;
+      if (took > max_ns) {
+        max_ns = took;
+      }
+      events += player.events;
+    }
+    printf("  %8u %9u %10zu %7.1f%% %13.1f %12.1f %12.1f %11u\n",
+           (unsigned)bench_intervals[i], (unsigned)map.header->keyframe_count, map.size,
+           100.0 * ((double)map.size - recording_bytes) / recording_bytes,
+           total_ns / 1e3 / BENCH_SEEKS, max_ns / 1e3, (double)events / BENCH_SEEKS, (unsigned)mismatches);
+    ok = ok && mismatches == 0;
+    munmap(map.base, map.size);
+    unlink(path);
+  }
+  free(hashes);
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  const char *image_path = NULL;
+  const char *out_path = NULL;
+  bool verbose = false;
+  bool keyframes = false;
+  bool seeking = false;
+  bool benchmark = false;
+  uint32_t interval = 0;
+  uint32_t target = 0;
+  int first_file = argc;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+      image_path = argv[++i];
+    } else if (strcmp(argv[i], "-v") == 0) {
+      verbose = true;
+    } else if (strcmp(argv[i], "-K") == 0 && i + 1 < argc) {
+      keyframes = true;
+      interval = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      out_path = argv[++i];
+    } else if (strcmp(argv[i], "-S") == 0 && i + 1 < argc) {
+      seeking = true;
+      target = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-B") == 0) {
+      benchmark = true;
+    } else if (argv[i][0] != '-') {
+      first_file = i;
+      break;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  int files = argc - first_file;
+  if ((image_path == NULL) == (files == 0)
+      || (keyframes && (out_path == NULL || files != 1 || interval % RECORDER_HASH_INTERVAL != 0))
+      || (seeking && files != 1)
+      || (keyframes + seeking + benchmark > 1)
+      || ((keyframes || seeking || benchmark) && image_path != NULL)) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  nvm3_host_config_t nvm;
+  nvm3_host_default_config(&nvm);
+  char scratch[64] = "";
+  if (image_path != NULL) {
+    if (!copy_image(image_path, scratch, sizeof(scratch))) {
+      unlink(scratch);
+      return 1;
+    }
+    nvm.image_path = scratch;
+  }
+  nvm3_host_configure(&nvm);
+  glib_host_config_t render = { .discard = true };
+  glib_host_configure(&render);
+  recorder_config_t recording_off = { .disabled = true };
+  recorder_configure(&recording_off);
+  trace_init();
+  latency_init();
+  app_events_init();
+  diagnostics_init();
+  tetris_init();
+  profiler_init();
+
+  if (seeking) {
+    int status = seek_command(argv[first_file], target);
+    nvm3_host_close();
+    return status;
+  }
+
+  // Everything is read before the first replay writes to the store
+  int capacity = image_path != NULL ? RECORDER_GAMES : files;
+  recording_t *recordings = calloc((size_t)capacity, sizeof(recording_t));
+  int count = 0;
+  int status = 0;
+  if (image_path != NULL) {
+    for (int age = 0; age < RECORDER_GAMES; age++) {
+      recording_t *recording = &recordings[count];
+      recording->events = malloc(RECORDER_BUFFER_BYTES);
+      if (recorder_load(age, &recording->header, recording->events)) {
+        snprintf(recording->name, sizeof(recording->name), "nvm3#%u", (unsigned)recording->header.sequence);
+        count++;
+      } else {
+        free(recording->events);
+        recording->events = NULL;
+      }
+    }
+    if (count == 0) {
+      fprintf(stderr, "%s: no recordings\n", image_path);
+      status = 1;
+    }
+  } else {
+    for (int i = first_file; i < argc; i++) {
+      if (load_file(argv[i], &recordings[count])) {
+        count++;
+      } else {
+        free(recordings[count].events);
+        status = 1;
+      }
+    }
+  }
+
+  for (int i = 0; i < count; i++) {
+    bool ok;
+    if (keyframes) {
+      ok = write_seekable(&recordings[i], interval, out_path);
+    } else if (benchmark) {
+      ok = bench(&recordings[i]);
+    } else {
+      ok = verify(&recordings[i], verbose);
+    }
+    if (!ok) {
+      status = 1;
+    }
+    free(recordings[i].events);
+  }
+
+  free(recordings);
+  nvm3_host_close();
+  if (image_path != NULL) {
+    unlink(scratch);
+  }
+  return status;
+}
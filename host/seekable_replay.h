@@ -0,0 +1,55 @@
+#ifndef SEEKABLE_REPLAY_H
+#define SEEKABLE_REPLAY_H
+
+// Seekable replay files: a game recording (recorder.h) plus keyframes, full
+// engine and gravity state every few locked pieces, so a tool can jump into
+// the middle of a long game and replay only the events since the nearest
+// keyframe. Everything is fixed size and 8-byte aligned, so a reader maps the
+// file read-only and indexes it in place:
+//
+//   seekable_header_t
+//   seekable_index_t[keyframe_count]       at index_offset
+//   seekable_keyframe_t[keyframe_count]    at keyframes_offset
+//   event bytes, recording.length of them at events_offset
+//
+// Keyframe k is the state right after piece (k + 1) * interval locked, taken
+// where the recording carries its state hash for that piece, so the interval
+// is a multiple of RECORDER_HASH_INTERVAL. Keyframes stop where a truncated
+// recording does, and the game over state has none.
+
+#include <stdint.h>
+#include "recorder.h"
+#include "tetris.h"
+#include "gravity.h"
+
+#define SEEKABLE_MAGIC    0x4B535254 // "TRSK"
+#define SEEKABLE_VERSION  1
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  recorder_header_t recording;
+  uint32_t interval;          // locked pieces between keyframes
+  uint32_t keyframe_count;
+  uint32_t index_offset;      // byte offsets from the start of the file
+  uint32_t keyframes_offset;
+  uint32_t events_offset;
+  uint32_t keyframe_bytes;    // sizeof(seekable_keyframe_t) of the writer
+  uint32_t reserved;
+} seekable_header_t;
+
+typedef struct {
+  uint32_t pieces;            // locked before the keyframe: (k + 1) * interval
+  uint32_t event_offset;      // first event after the keyframe, from events_offset
+  uint32_t keyframe_offset;   // from the start of the file
+  uint32_t ticks;             // game time of the keyframe
+} seekable_index_t;
+
+typedef struct {
+  tetris_snapshot_t snapshot;
+  gravity_state_t gravity;
+  uint32_t game_state;        // in play or paused
+  uint32_t hash;              // tetris_state_hash() at the keyframe, to check a restore
+} seekable_keyframe_t;
+
+#endif // SEEKABLE_REPLAY_H
@@ -0,0 +1,217 @@
+// Host sleeptimer: a discrete-event virtual clock at the EFR32 sleeptimer
+// frequency. Time only moves when the host program advances it, and every
+// timer that expires on the way fires in expiry order, with the clock set to
+// its expiry, just as the RTC interrupt would run it on target. Nothing ever
+// waits on the wall clock, so the app runs as fast as the CPU allows.
+
+#include "sl_sleeptimer.h"
+#include "sleeptimer_host.h"
+
+#include <stddef.h>
+
+#define HOST_TIMER_FREQUENCY 32768u
+
+static uint64_t now_ticks = 0;
+static sl_sleeptimer_timer_handle_t *timers = NULL; // running timers, unordered
+static uint64_t fired = 0;
+
+// --- Local function prototypes ---
+static sl_status_t start(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout, uint32_t period,
+                         sl_sleeptimer_timer_callback_t callback, void *callback_data);
+static void unlink_timer(sl_sleeptimer_timer_handle_t *handle);
+static sl_sleeptimer_timer_handle_t *earliest_timer(void);
+
+// --- Host control ---
+
+void sleeptimer_host_advance_ticks(uint64_t ticks)
+{
+  sleeptimer_host_run_until(now_ticks + ticks);
+}
+
+void sleeptimer_host_advance_ms(uint32_t ms)
+{
+  sleeptimer_host_run_until(now_ticks + ((uint64_t)ms * HOST_TIMER_FREQUENCY) / 1000u);
+}
+
+// Fires every timer due up to and including the given tick, then leaves the
+// clock there. Callbacks may start and stop timers, including their own.
+void sleeptimer_host_run_until(uint64_t tick)
+{
+  sl_sleeptimer_timer_handle_t *timer;
+  while ((timer = earliest_timer()) != NULL && timer->expiry <= tick) {
+    if (timer->expiry > now_ticks) {
+      now_ticks = timer->expiry;
+    }
+    if (timer->timeout_periodic > 0) {
+      timer->expiry += timer->timeout_periodic;
+    } else {
+      unlink_timer(timer);
+    }
+    fired++;
+    timer->callback(timer, timer->callback_data);
+  }
+  if (tick > now_ticks) {
+    now_ticks = tick;
+  }
+}
+
+bool sleeptimer_host_next_expiry(uint64_t *tick)
+{
+  sl_sleeptimer_timer_handle_t *timer = earliest_timer();
+  if (timer == NULL) {
+    return false;
+  }
+  *tick = timer->expiry;
+  return true;
+}
+
+uint64_t sleeptimer_host_now(void)
+{
+  return now_ticks;
+}
+
+uint64_t sleeptimer_host_fired_count(void)
+{
+  return fired;
+}
+
+// --- Sleeptimer API ---
+
+uint32_t sl_sleeptimer_get_tick_count(void)
+{
+  return (uint32_t)now_ticks;
+}
+
+uint64_t sl_sleeptimer_get_tick_count64(void)
+{
+  return now_ticks;
+}
+
+uint32_t sl_sleeptimer_get_timer_frequency(void)
+{
+  return HOST_TIMER_FREQUENCY;
+}
+
+uint32_t sl_sleeptimer_ms_to_tick(uint16_t time_ms)
+{
+  return (uint32_t)(((uint64_t)time_ms * HOST_TIMER_FREQUENCY) / 1000u);
+}
+
+sl_status_t sl_sleeptimer_ms32_to_tick(uint32_t time_ms, uint32_t *tick)
+{
+  *tick = (uint32_t)(((uint64_t)time_ms * HOST_TIMER_FREQUENCY) / 1000u);
+  return SL_STATUS_OK;
+}
+
+uint32_t sl_sleeptimer_tick_to_ms(uint32_t tick)
+{
+  return (uint32_t)(((uint64_t)tick * 1000u) / HOST_TIMER_FREQUENCY);
+}
+
+sl_status_t sl_sleeptimer_tick64_to_ms(uint64_t tick, uint64_t *ms)
+{
+  *ms = (tick * 1000u) / HOST_TIMER_FREQUENCY;
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_start_timer(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout,
+                                      sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                      uint8_t priority, uint16_t option_flags)
+{
+  (void)priority;
+  (void)option_flags;
+  return start(handle, timeout, 0, callback, callback_data);
+}
+
+sl_status_t sl_sleeptimer_start_periodic_timer(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout,
+                                               sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                               uint8_t priority, uint16_t option_flags)
+{
+  (void)priority;
+  (void)option_flags;
+  return start(handle, timeout, timeout, callback, callback_data);
+}
+
+sl_status_t sl_sleeptimer_start_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                         sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                         uint8_t priority, uint16_t option_flags)
+{
+  uint32_t ticks;
+  sl_sleeptimer_ms32_to_tick(timeout_ms, &ticks);
+  return sl_sleeptimer_start_timer(handle, ticks, callback, callback_data, priority, option_flags);
+}
+
+sl_status_t sl_sleeptimer_start_periodic_timer_ms(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout_ms,
+                                                  sl_sleeptimer_timer_callback_t callback, void *callback_data,
+                                                  uint8_t priority, uint16_t option_flags)
+{
+  uint32_t ticks;
+  sl_sleeptimer_ms32_to_tick(timeout_ms, &ticks);
+  return sl_sleeptimer_start_periodic_timer(handle, ticks, callback, callback_data, priority, option_flags);
+}
+
+sl_status_t sl_sleeptimer_stop_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+  if (handle == NULL) {
+    return SL_STATUS_NULL_POINTER;
+  }
+  unlink_timer(handle);
+  return SL_STATUS_OK;
+}
+
+sl_status_t sl_sleeptimer_is_timer_running(sl_sleeptimer_timer_handle_t *handle, bool *running)
+{
+  if (handle == NULL || running == NULL) {
+    return SL_STATUS_NULL_POINTER;
+  }
+  *running = handle->running;
+  return SL_STATUS_OK;
+}
+
+// --- Internal Helper Functions ---
+
+static sl_status_t start(sl_sleeptimer_timer_handle_t *handle, uint32_t timeout, uint32_t period,
+                         sl_sleeptimer_timer_callback_t callback, void *callback_data)
+{
+  if (handle == NULL) {
+    return SL_STATUS_NULL_POINTER;
+  }
+  if (handle->running) {
+    return SL_STATUS_NOT_READY;
+  }
+  handle->callback = callback;
+  handle->callback_data = callback_data;
+  handle->timeout_periodic = period;
+  handle->expiry = now_ticks + timeout;
+  handle->running = true;
+  handle->next = timers;
+  timers = handle;
+  return SL_STATUS_OK;
+}
+
+static void unlink_timer(sl_sleeptimer_timer_handle_t *handle)
+{
+  if (!handle->running) {
+    return;
+  }
+  for (sl_sleeptimer_timer_handle_t **link = &timers; *link != NULL; link = &(*link)->next) {
+    if (*link == handle) {
+      *link = handle->next;
+      break;
+    }
+  }
+  handle->next = NULL;
+  handle->running = false;
+}
+
+// Ties go to the timer started first, which sits deeper in the list
+static sl_sleeptimer_timer_handle_t *earliest_timer(void)
+{
+  sl_sleeptimer_timer_handle_t *earliest = NULL;
+  for (sl_sleeptimer_timer_handle_t *timer = timers; timer != NULL; timer = timer->next) {
+    if (earliest == NULL || timer->expiry <= earliest->expiry) {
+      earliest = timer;
+    }
+  }
+  return earliest;
+}
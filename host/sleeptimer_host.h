@@ -0,0 +1,15 @@
+#ifndef SLEEPTIMER_HOST_H
+#define SLEEPTIMER_HOST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Virtual clock control. Advancing fires every timer that expires on the way.
+void sleeptimer_host_advance_ticks(uint64_t ticks);
+void sleeptimer_host_advance_ms(uint32_t ms);
+void sleeptimer_host_run_until(uint64_t tick);
+bool sleeptimer_host_next_expiry(uint64_t *tick);
+uint64_t sleeptimer_host_now(void);
+uint64_t sleeptimer_host_fired_count(void);
+
+#endif // SLEEPTIMER_HOST_H
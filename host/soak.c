@@ -0,0 +1,454 @@
+// Runs the unmodified app (app_init() and app_process_action()) on the host
+// against the virtual sleeptimer clock, fed by an input script or a seeded
+// random player. Between main loop passes the clock jumps straight to the
+// next timer expiry or scripted input, so hours of play take seconds.
+
+#include "app.h"
+#include "app_events.h"
+#include "tetris.h"
+#include "stats.h"
+#include "recorder.h"
+#include "joystick_input.h"
+#include "trace.h"
+#include "sl_sleeptimer.h"
+#include "nvm3_host.h"
+#include "glib_host.h"
+#include "sleeptimer_host.h"
+#include "input_host.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_SCRIPT_LINE   128
+#define BOT_MIN_HOLD_MS   10
+#define RECORDING_BYTES   (1u << 20)  // -R logs whole games, not what fits in the target's buffer
+
+typedef enum {
+  INPUT_JOYSTICK,
+  INPUT_BUTTON,
+} input_kind_t;
+
+typedef struct {
+  uint64_t tick;
+  input_kind_t kind;
+  int value;        // joystick position, or button index
+  bool pressed;     // buttons only
+} scripted_input_t;
+
+typedef struct {
+  scripted_input_t *inputs;
+  size_t count;
+  size_t next;
+} input_script_t;
+
+static const char *const state_names[] = {
+  [GAME_STATE_MAIN_MENU]      = "main_menu",
+  [GAME_STATE_IN_GAME]        = "in_game",
+  [GAME_STATE_PAUSED]         = "paused",
+  [GAME_STATE_GAME_OVER]      = "game_over",
+  [GAME_STATE_SLOT_SELECTION] = "slot_selection",
+  [GAME_STATE_SCOREBOARD]     = "scoreboard",
+  [GAME_STATE_STATS]          = "stats",
+  [GAME_STATE_HANDLING]       = "handling",
+  [GAME_STATE_DIAGNOSTICS]    = "diagnostics",
+};
+
+static uint32_t bot_seed;
+static uint64_t bot_next_tick;
+static int bot_button_held = -1;
+static uint32_t games_seen;
+static uint32_t recordings_written;
+static game_state_t last_state;
+
+static void usage(const char *argv0)
+{
+  fprintf(stderr,
+          "usage: %s [-s script | -r seed] [-t minutes] [-i image] [-d dir] [-l file] [-R dir] [-T file]\n"
+          "  -s  replay an input script: one '<ms> joy N|S|E|W|C|NONE' or\n"
+          "      '<ms> btn 0|1 down|up' per line, '#' starts a comment\n"
+          "  -r  play with a random bot seeded with this value (default 1)\n"
+          "  -t  virtual minutes to run (default 60; a script stops after its last input)\n"
+          "  -i  back the NVM3 store with this image file (default: anonymous memory)\n"
+          "  -d  write every frame pushed to the LCD into this directory as PBM\n"
+          "  -l  log the changed lines of every pushed frame to this file\n"
+          "  -R  write every finished game recording into this directory instead of NVM3\n"
+          "  -T  at the end of the run, write the trace ring to this file (host/trace_decode.c reads it)\n", argv0);
+}
+
+static int current_screen(void)
+{
+  return (int)tetris_get_game_state();
+}
+
+static uint64_t ms_to_ticks(uint64_t ms)
+{
+  return (ms * sl_sleeptimer_get_timer_frequency()) / 1000u;
+}
+
+static uint32_t bot_random(uint32_t bound)
+{
+  // xorshift32: the same seed gives the same session on every host
+  bot_seed ^= bot_seed << 13;
+  bot_seed ^= bot_seed >> 17;
+  bot_seed ^= bot_seed << 5;
+  return bot_seed % bound;
+}
+
+static bool parse_position(const char *name, sl_joystick_position_t *position)
+{
+  static const char *const names[] = { "NONE", "C", "N", "E", "S", "W" };
+  for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+    if (strcmp(name, names[i]) == 0) {
+      *position = (sl_joystick_position_t)i;
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool load_script(const char *path, input_script_t *script)
+{
+  FILE *file = fopen(path, "r");
+  if (file == NULL) {
+    perror(path);
+    return false;
+  }
+
+  char line[MAX_SCRIPT_LINE];
+  size_t capacity = 0;
+  int line_number = 0;
+  uint64_t last_ms = 0;
+  while (fgets(line, sizeof(line), file) != NULL) {
+    line_number++;
+    char *comment = strchr(line, '#');
+    if (comment != NULL) {
+      *comment = '\0';
+    }
+    unsigned long long ms;
+    char kind[8];
+    char arg1[8];
+    char arg2[8] = "";
+    int fields = sscanf(line, "%llu %7s %7s %7s", &ms, kind, arg1, arg2);
+    if (fields <= 0) {
+      continue; // blank or comment-only line
+    }
+
+    scripted_input_t input = { .tick = ms_to_ticks(ms) };
+    sl_joystick_position_t position;
+    if (fields == 3 && strcmp(kind, "joy") == 0 && parse_position(arg1, &position)) {
+      input.kind = INPUT_JOYSTICK;
+      input.value = position;
+    } else if (fields == 4 && strcmp(kind, "btn") == 0 && (arg1[0] == '0' || arg1[0] == '1') && arg1[1] == '\0'
+               && (strcmp(arg2, "down") == 0 || strcmp(arg2, "up") == 0)) {
+      input.kind = INPUT_BUTTON;
+      input.value = arg1[0] - '0';
+      input.pressed = strcmp(arg2, "down") == 0;
+    } else {
+      fprintf(stderr, "%s:%d: cannot parse input\n", path, line_number);
+      fclose(file);
+      return false;
+    }
+    if (ms < last_ms) {
+      fprintf(stderr, "%s:%d: inputs must be in time order\n", path, line_number);
+      fclose(file);
+      return false;
+    }
+    last_ms = ms;
+
+    if (script->count == capacity) {
+      capacity = capacity ? capacity * 2 : 64;
+      script->inputs = realloc(script->inputs, capacity * sizeof(scripted_input_t));
+      if (script->inputs == NULL) {
+        fclose(file);
+        return false;
+      }
+    }
+    script->inputs[script->count++] = input;
+  }
+  fclose(file);
+  return true;
+}
+
+static void apply_script(input_script_t *script, uint64_t now)
+{
+  while (script->next < script->count && script->inputs[script->next].tick <= now) {
+    const scripted_input_t *input = &script->inputs[script->next++];
+    if (input->kind == INPUT_JOYSTICK) {
+      input_host_set_joystick((sl_joystick_position_t)input->value);
+    } else {
+      input_host_set_button(input->value, input->pressed);
+    }
+  }
+}
+
+// One step of the random player: release whatever is held, otherwise pick an
+// input that makes sense for the current screen and hold it for a while
+static void bot_step(uint64_t now)
+{
+  static sl_joystick_position_t held = JOYSTICK_NONE;
+  uint32_t hold_ms;
+
+  if (bot_button_held >= 0) {
+    input_host_set_button(bot_button_held, false);
+    bot_button_held = -1;
+    hold_ms = BOT_MIN_HOLD_MS + bot_random(70);
+  } else if (held != JOYSTICK_NONE) {
+    input_host_set_joystick(JOYSTICK_NONE);
+    held = JOYSTICK_NONE;
+    hold_ms = BOT_MIN_HOLD_MS + bot_random(90);
+  } else {
+    game_state_t state = tetris_get_game_state();
+    int button = -1;
+    if (state == GAME_STATE_MAIN_MENU) {
+      held = JOYSTICK_C; // the menu opens on "Start Game"
+    } else if (state == GAME_STATE_IN_GAME) {
+      uint32_t pick = bot_random(100);
+      if (pick < 25) {
+        held = JOYSTICK_W;
+      } else if (pick < 50) {
+        held = JOYSTICK_E;
+      } else if (pick < 65) {
+        held = JOYSTICK_N;
+      } else if (pick < 80) {
+        held = JOYSTICK_S;
+      } else if (pick < 98) {
+        held = JOYSTICK_C;
+      } else if (pick < 99) {
+        button = 0; // save
+      } else {
+        button = 1; // pause
+      }
+    } else {
+      button = 1; // resume, leave game over, or back out of any other screen
+    }
+    if (button >= 0) {
+      input_host_set_button(button, true);
+      bot_button_held = button;
+    } else {
+      input_host_set_joystick(held);
+    }
+    hold_ms = BOT_MIN_HOLD_MS + bot_random(held == JOYSTICK_W || held == JOYSTICK_E ? 400 : 120);
+  }
+  bot_next_tick = now + ms_to_ticks(hold_ms);
+}
+
+// Same layout as in flash: the header, then the event bytes
+static void write_recording(const recorder_header_t *header, const uint8_t *events, void *context)
+{
+  char path[PATH_MAX];
+  snprintf(path, sizeof(path), "%s/game_%04u.rec", (const char *)context, (unsigned)recordings_written++);
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    perror(path);
+    return;
+  }
+  if (fwrite(header, sizeof(*header), 1, file) != 1
+      || fwrite(events, 1, header->length, file) != header->length) {
+    perror(path);
+  }
+  fclose(file);
+}
+
+static void write_trace(const void *data, size_t len, void *context)
+{
+  fwrite(data, 1, len, (FILE *)context);
+}
+
+// The same dump the target sends over SWO, minus the ITM packet framing
+static bool write_trace_file(const char *path)
+{
+  FILE *file = fopen(path, "wb");
+  if (file == NULL) {
+    perror(path);
+    return false;
+  }
+  trace_dump(write_trace, file);
+  bool ok = !ferror(file);
+  if (fclose(file) != 0 || !ok) {
+    perror(path);
+    return false;
+  }
+  return true;
+}
+
+static void print_summary(uint64_t passes, double wall_seconds)
+{
+  uint64_t virtual_ms;
+  sl_sleeptimer_tick64_to_ms(sleeptimer_host_now(), &virtual_ms);
+  double virtual_seconds = virtual_ms / 1000.0;
+
+  printf("soak virtual=%.1fs wall=%.3fs speedup=%.0fx\n",
+         virtual_seconds, wall_seconds, wall_seconds > 0 ? virtual_seconds / wall_seconds : 0.0);
+  printf("soak passes=%llu timers_fired=%llu final_state=%s\n",
+         (unsigned long long)passes, (unsigned long long)sleeptimer_host_fired_count(),
+         state_names[tetris_get_game_state()]);
+  printf("soak games=%u pieces=%lu lines=%lu t_spins=%lu play_seconds=%lu\n",
+         games_seen,
+         (unsigned long)stats_get(STATS_PIECES_PLACED),
+         (unsigned long)stats_get(STATS_LINES_CLEARED),
+         (unsigned long)stats_get(STATS_T_SPINS),
+         (unsigned long)stats_get(STATS_PLAY_SECONDS));
+
+  uint32_t scores[5];
+  tetris_get_high_scores(scores);
+  printf("soak high_scores=%lu,%lu,%lu,%lu,%lu\n",
+         (unsigned long)scores[0], (unsigned long)scores[1], (unsigned long)scores[2],
+         (unsigned long)scores[3], (unsigned long)scores[4]);
+
+  recorder_stats_t recorder;
+  recorder_get_stats(&recorder);
+  uint64_t recorded_ms;
+  sl_sleeptimer_tick64_to_ms(recorder.ticks_recorded, &recorded_ms);
+  printf("soak recorder games=%u truncated=%u bytes=%u bytes_per_min=%.0f chunk_writes=%u errors=%u\n",
+         recorder.games_recorded, recorder.games_truncated, recorder.bytes_recorded,
+         recorded_ms > 0 ? recorder.bytes_recorded * 60000.0 / recorded_ms : 0.0,
+         recorder.chunk_writes, recorder.write_errors);
+
+  // Each sample stands for the interval before it
+  joystick_input_stats_t joystick;
+  joystick_input_get_stats(&joystick);
+  double active_seconds = (joystick.samples - joystick.idle_samples) * JOYSTICK_INPUT_SAMPLE_MS / 1000.0;
+  double idle_seconds = joystick.idle_samples * JOYSTICK_INPUT_IDLE_SAMPLE_MS / 1000.0;
+  printf("soak joystick samples=%u idle_samples=%u active_seconds=%.1f idle_seconds=%.1f samples_per_s=%.1f\n",
+         joystick.samples, joystick.idle_samples, active_seconds, idle_seconds,
+         virtual_seconds > 0 ? joystick.samples / virtual_seconds : 0.0);
+
+  nvm3_host_stats_t flash;
+  nvm3_host_get_stats(&flash);
+  printf("soak nvm3 writes=%u failed=%u bytes=%llu repacks=%u erases=%u\n",
+         flash.writes, flash.failed_writes, (unsigned long long)flash.bytes_programmed,
+         flash.repacks, flash.page_erases);
+
+  glib_host_print_report(stdout);
+}
+
+int main(int argc, char **argv)
+{
+  nvm3_host_config_t config;
+  nvm3_host_default_config(&config);
+  glib_host_config_t render = {
+    .screen = current_screen,
+    .screen_names = state_names,
+    .screen_count = sizeof(state_names) / sizeof(state_names[0]),
+  };
+  const char *frame_log_path = NULL;
+  const char *trace_path = NULL;
+  recorder_config_t recording = { 0 };
+  const char *script_path = NULL;
+  uint32_t minutes = 0;
+  bot_seed = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      script_path = argv[++i];
+    } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      bot_seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      minutes = (uint32_t)strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-i") == 0 && i + 1 < argc) {
+      config.image_path = argv[++i];
+    } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+      render.dump_dir = argv[++i];
+    } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+      frame_log_path = argv[++i];
+    } else if (strcmp(argv[i], "-R") == 0 && i + 1 < argc) {
+      recording.write = write_recording;
+      recording.context = argv[++i];
+      recording.buffer_bytes = RECORDING_BYTES;
+      recording.buffer = malloc(RECORDING_BYTES);
+    } else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc) {
+      trace_path = argv[++i];
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+  if (bot_seed == 0) {
+    bot_seed = 1; // xorshift never leaves zero
+  }
+
+  input_script_t script = { 0 };
+  if (script_path != NULL && !load_script(script_path, &script)) {
+    return 1;
+  }
+  uint64_t end_tick;
+  if (minutes > 0 || script_path == NULL) {
+    end_tick = ms_to_ticks((uint64_t)(minutes > 0 ? minutes : 60) * 60000u);
+  } else {
+    // A script runs one second past its last input so that input plays out
+    end_tick = (script.count ? script.inputs[script.count - 1].tick : 0) + ms_to_ticks(1000);
+  }
+
+  if (frame_log_path != NULL && (render.frame_log = fopen(frame_log_path, "w")) == NULL) {
+    perror(frame_log_path);
+    return 1;
+  }
+  nvm3_host_configure(&config);
+  glib_host_configure(&render);
+  recorder_configure(&recording);
+  struct timespec wall_start, wall_end;
+  clock_gettime(CLOCK_MONOTONIC, &wall_start);
+
+  app_init();
+  last_state = tetris_get_game_state();
+  uint64_t passes = 0;
+  int result = 0;
+
+  for (;;) {
+    if (app_events_pending()) {
+      app_process_action();
+      passes++;
+      game_state_t state = tetris_get_game_state();
+      if (state == GAME_STATE_IN_GAME && last_state == GAME_STATE_MAIN_MENU) {
+        games_seen++;
+      }
+      last_state = state;
+      continue;
+    }
+
+    // Idle: the core would sleep until the next interrupt, so jump there
+    uint64_t next;
+    bool have_timer = sleeptimer_host_next_expiry(&next);
+    uint64_t next_input = script_path != NULL
+                          ? (script.next < script.count ? script.inputs[script.next].tick : UINT64_MAX)
+                          : bot_next_tick;
+    if (!have_timer || next_input < next) {
+      next = next_input;
+    }
+    if (next == UINT64_MAX) {
+      fprintf(stderr, "soak: no timer running and no input left in state %s\n",
+              state_names[tetris_get_game_state()]);
+      result = 1;
+      break;
+    }
+    if (next > end_tick) {
+      sleeptimer_host_run_until(end_tick);
+      break;
+    }
+
+    sleeptimer_host_run_until(next);
+    if (script_path != NULL) {
+      apply_script(&script, next);
+    } else if (next >= bot_next_tick) {
+      bot_step(next);
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &wall_end);
+  double wall_seconds = (wall_end.tv_sec - wall_start.tv_sec) + (wall_end.tv_nsec - wall_start.tv_nsec) / 1e9;
+  print_summary(passes, wall_seconds);
+
+  if (trace_path != NULL && !write_trace_file(trace_path)) {
+    result = 1;
+  }
+  if (render.frame_log != NULL) {
+    fclose(render.frame_log);
+  }
+  free(script.inputs);
+  free(recording.buffer);
+  nvm3_host_close();
+  return result;
+}
@@ -0,0 +1,300 @@
+// Event trace decoder. Reads trace dumps (trace.h) from a file or from a raw
+// SWO capture of ITM packets, and writes them as a Chrome trace JSON timeline
+// that chrome://tracing and ui.perfetto.dev open directly. Each dump in the
+// input becomes its own process in the timeline.
+
+#include "trace.h"
+#include "game_state.h"
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Timeline rows
+#define TID_STATE    1
+#define TID_GAME     2
+#define TID_INPUT    3
+#define TID_NVM3     4
+#define TID_DISPLAY  5
+
+static const char *const state_names[] = {
+  [GAME_STATE_MAIN_MENU] = "main menu",
+  [GAME_STATE_IN_GAME] = "in game",
+  [GAME_STATE_PAUSED] = "paused",
+  [GAME_STATE_GAME_OVER] = "game over",
+  [GAME_STATE_SLOT_SELECTION] = "slot selection",
+  [GAME_STATE_SCOREBOARD] = "scoreboard",
+  [GAME_STATE_STATS] = "statistics",
+  [GAME_STATE_HANDLING] = "handling",
+  [GAME_STATE_DIAGNOSTICS] = "diagnostics",
+};
+#define STATE_NAME_COUNT ((int)(sizeof(state_names) / sizeof(state_names[0])))
+
+static const char *const joystick_event_names[] = { "press", "hold", "release" };
+
+typedef struct {
+  FILE *out;
+  bool first;
+} json_writer_t;
+
+// --- Local function prototypes ---
+static uint8_t *read_input(const char *path, size_t *len);
+static size_t extract_itm_channel(const uint8_t *in, size_t len, uint8_t *out, unsigned channel);
+static size_t decode_dump(const uint8_t *data, size_t len, int pid, json_writer_t *json);
+static void emit(json_writer_t *json, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+static const char *state_name(unsigned state);
+
+int main(int argc, char **argv)
+{
+  const char *input = NULL;
+  const char *output = NULL;
+  bool itm = false;
+  unsigned channel = TRACE_SWO_CHANNEL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      output = argv[++i];
+    } else if (strcmp(argv[i], "-s") == 0) {
+      itm = true;
+    } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      channel = (unsigned)strtoul(argv[++i], NULL, 0);
+      itm = true;
+    } else if (argv[i][0] == '-' && argv[i][1] != '\0') {
+      fprintf(stderr, "usage: %s [-s] [-c channel] [-o out.json] dump|-\n", argv[0]);
+      return 2;
+    } else {
+      input = argv[i];
+    }
+  }
+  if (input == NULL) {
+    fprintf(stderr, "no input given\n");
+    return 2;
+  }
+
+  size_t len;
+  uint8_t *data = read_input(input, &len);
+  if (data == NULL) {
+    perror(input);
+    return 1;
+  }
+  if (itm) {
+    len = extract_itm_channel(data, len, data, channel);
+  }
+
+  json_writer_t json = { .out = stdout, .first = true };
+  if (output != NULL && (json.out = fopen(output, "w")) == NULL) {
+    perror(output);
+    return 1;
+  }
+
+  fprintf(json.out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  int dumps = 0;
+  size_t pos = 0;
+  while (pos + sizeof(trace_dump_header_t) <= len) {
+    uint32_t magic;
+    memcpy(&magic, data + pos, sizeof(magic));
+    if (magic != TRACE_DUMP_MAGIC) {
+      pos++; // resynchronise on the next header
+      continue;
+    }
+    size_t used = decode_dump(data + pos, len - pos, dumps + 1, &json);
+    if (used == 0) {
+      pos++;
+      continue;
+    }
+    dumps++;
+    pos += used;
+  }
+  fprintf(json.out, "\n]}\n");
+
+  if (json.out != stdout) {
+    fclose(json.out);
+  }
+  free(data);
+  if (dumps == 0) {
+    fprintf(stderr, "no trace dump found in %s\n", input);
+    return 1;
+  }
+  fprintf(stderr, "%d dump(s) decoded\n", dumps);
+  return 0;
+}
+
+// --- Internal Helper Functions ---
+
+static uint8_t *read_input(const char *path, size_t *len)
+{
+  FILE *f = strcmp(path, "-") == 0 ? stdin : fopen(path, "rb");
+  if (f == NULL) {
+    return NULL;
+  }
+  size_t capacity = 1 << 16;
+  uint8_t *data = malloc(capacity);
+  *len = 0;
+  size_t n;
+  while (data != NULL && (n = fread(data + *len, 1, capacity - *len, f)) > 0) {
+    *len += n;
+    if (*len == capacity) {
+      capacity *= 2;
+      data = realloc(data, capacity);
+    }
+  }
+  if (f != stdin) {
+    fclose(f);
+  }
+  return data;
+}
+
+// Keeps the payload of software source packets on one stimulus port. Header
+// bits 1:0 give the payload size (1, 2 or 4 bytes), bit 2 marks hardware
+// source packets and bits 7:3 the port. Sync, overflow and timestamp packets
+// carry no stimulus data; multi-byte ones set bit 7 on every byte but the last.
+static size_t extract_itm_channel(const uint8_t *in, size_t len, uint8_t *out, unsigned channel)
+{
+  static const size_t payload_sizes[] = { 0, 1, 2, 4 };
+  size_t written = 0;
+  size_t i = 0;
+
+  while (i < len) {
+    uint8_t header = in[i++];
+    size_t size = payload_sizes[header & 0x3];
+    if (size == 0) {
+      if (header != 0x00 && (header & 0x80)) {
+        while (i < len && (in[i++] & 0x80)) {
+        }
+      }
+      continue;
+    }
+    if (i + size > len) {
+      break;
+    }
+    if ((header & 0x4) == 0 && (unsigned)(header >> 3) == channel) {
+      memmove(out + written, in + i, size); // out trails in, so this never overtakes unread input
+      written += size;
+    }
+    i += size;
+  }
+  return written;
+}
+
+// Returns the bytes consumed, or 0 when the header does not hold up
+static size_t decode_dump(const uint8_t *data, size_t len, int pid, json_writer_t *json)
+{
+  trace_dump_header_t header;
+  memcpy(&header, data, sizeof(header));
+  if (header.version != TRACE_DUMP_VERSION
+      || header.record_size != sizeof(trace_record_t)
+      || header.tick_hz == 0
+      || header.count > (len - sizeof(header)) / sizeof(trace_record_t)) {
+    return 0;
+  }
+
+  emit(json, "{\"ph\":\"M\",\"pid\":%d,\"name\":\"process_name\",\"args\":{\"name\":\"dump %d (%u records, %u lost)\"}}",
+       pid, pid, header.count, header.overwritten);
+  static const struct { int tid; const char *name; } rows[] = {
+    { TID_STATE, "state" }, { TID_GAME, "game" }, { TID_INPUT, "input" },
+    { TID_NVM3, "nvm3" }, { TID_DISPLAY, "display" },
+  };
+  for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+    emit(json, "{\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"name\":\"thread_name\",\"args\":{\"name\":\"%s\"}}",
+         pid, rows[i].tid, rows[i].name);
+  }
+
+  const uint8_t *records = data + sizeof(header);
+  uint64_t ticks = 0;
+  uint32_t previous_tick = 0;
+  int open_state = -1;
+  double ts = 0;
+
+  for (uint32_t i = 0; i < header.count; i++) {
+    trace_record_t r;
+    memcpy(&r, records + (size_t)i * sizeof(r), sizeof(r));
+
+    // Ticks are 32 bits and wrap; records are in order, so accumulate the differences
+    if (i > 0) {
+      ticks += (uint32_t)(r.tick - previous_tick);
+    }
+    previous_tick = r.tick;
+    ts = (double)ticks * 1e6 / header.tick_hz;
+
+    switch (r.type) {
+      case TRACE_STATE:
+        if (open_state >= 0) {
+          emit(json, "{\"ph\":\"E\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}", pid, TID_STATE, ts);
+        }
+        emit(json, "{\"ph\":\"B\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"%s\",\"args\":{\"from\":\"%s\"}}",
+             pid, TID_STATE, ts, state_name(r.arg8), state_name(r.arg16));
+        open_state = r.arg8;
+        break;
+      case TRACE_JOYSTICK:
+        emit(json, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"joystick %s\",\"args\":{\"position\":%u}}",
+             pid, TID_INPUT, ts, r.arg8 < 3 ? joystick_event_names[r.arg8] : "?", r.arg16);
+        break;
+      case TRACE_BUTTON:
+        emit(json, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"btn%u\"}",
+             pid, TID_INPUT, ts, r.arg8);
+        break;
+      case TRACE_SPAWN:
+        emit(json, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"spawn\",\"args\":{\"color\":%u}}",
+             pid, TID_GAME, ts, r.arg8);
+        break;
+      case TRACE_LOCK:
+        emit(json, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"lock\",\"args\":{\"t_spin\":%u,\"lines\":%u}}",
+             pid, TID_GAME, ts, r.arg8, r.arg16);
+        break;
+      case TRACE_LINE_CLEAR:
+        emit(json, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"line clear\",\"args\":{\"lines\":%u,\"level\":%u}}",
+             pid, TID_GAME, ts, r.arg8, r.arg16);
+        break;
+      case TRACE_NVM3_WRITE_BEGIN:
+        emit(json, "{\"ph\":\"B\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"write\",\"args\":{\"key\":%u}}",
+             pid, TID_NVM3, ts, r.arg16);
+        break;
+      case TRACE_NVM3_WRITE_END:
+        emit(json, "{\"ph\":\"E\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"args\":{\"error\":%u}}",
+             pid, TID_NVM3, ts, r.arg8);
+        break;
+      case TRACE_NVM3_REPACK_BEGIN:
+        emit(json, "{\"ph\":\"B\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"repack\"}", pid, TID_NVM3, ts);
+        break;
+      case TRACE_NVM3_REPACK_END:
+        emit(json, "{\"ph\":\"E\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}", pid, TID_NVM3, ts);
+        break;
+      case TRACE_DISPLAY_BEGIN:
+        emit(json, "{\"ph\":\"B\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"lcd transfer\"}", pid, TID_DISPLAY, ts);
+        break;
+      case TRACE_DISPLAY_END:
+        emit(json, "{\"ph\":\"E\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}", pid, TID_DISPLAY, ts);
+        break;
+      case TRACE_DUMP:
+        emit(json, "{\"ph\":\"i\",\"s\":\"g\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"dump\"}", pid, TID_GAME, ts);
+        break;
+      default:
+        emit(json, "{\"ph\":\"i\",\"s\":\"t\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"name\":\"type %u\",\"args\":{\"arg8\":%u,\"arg16\":%u}}",
+             pid, TID_GAME, ts, r.type, r.arg8, r.arg16);
+        break;
+    }
+  }
+  if (open_state >= 0) {
+    emit(json, "{\"ph\":\"E\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f}", pid, TID_STATE, ts);
+  }
+  return sizeof(header) + (size_t)header.count * sizeof(trace_record_t);
+}
+
+static void emit(json_writer_t *json, const char *fmt, ...)
+{
+  va_list args;
+  if (!json->first) {
+    fputs(",\n", json->out);
+  }
+  json->first = false;
+  va_start(args, fmt);
+  vfprintf(json->out, fmt, args);
+  va_end(args);
+}
+
+static const char *state_name(unsigned state)
+{
+  return state < STATE_NAME_COUNT && state_names[state] != NULL ? state_names[state] : "?";
+}
@@ -0,0 +1,160 @@
+#include "joystick_input.h"
+#include "app_events.h"
+#include "trace.h"
+#include "memory_monitor.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include <string.h>
+
+static sl_joystick_t joystick_handle = JOYSTICK_HANDLE_DEFAULT;
+static sl_sleeptimer_timer_handle_t sample_timer;
+
+// Sampler state, owned by the timer callback
+static sl_joystick_position_t stable_position = JOYSTICK_NONE;
+static sl_joystick_position_t candidate_position = JOYSTICK_NONE;
+static uint32_t candidate_count = 0;
+static uint32_t next_hold_tick = 0;
+static uint32_t last_active_tick = 0; // last sample that was not centred and settled
+static bool sampling_idle = false;
+
+static joystick_input_event_t queue[JOYSTICK_INPUT_QUEUE_SIZE];
+static volatile uint32_t queue_head = 0; // next slot to write
+static volatile uint32_t queue_tail = 0; // next slot to read
+static joystick_input_stats_t stats;
+
+// --- Local function prototypes ---
+static void sample_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+static void sample_position(uint32_t now);
+static void accept_position(sl_joystick_position_t position, uint32_t now);
+static void queue_event(joystick_input_event_type_t type, sl_joystick_position_t position, uint32_t now);
+
+// --- Public functions ---
+
+void joystick_input_init(void)
+{
+  memory_monitor_account("joystick", sizeof(queue));
+  stable_position = JOYSTICK_NONE;
+  candidate_count = 0;
+  last_active_tick = sl_sleeptimer_get_tick_count();
+  sampling_idle = false;
+  queue_head = 0;
+  queue_tail = 0;
+  memset(&stats, 0, sizeof(stats));
+
+  sl_joystick_init(&joystick_handle);
+  sl_joystick_start(&joystick_handle);
+  sl_sleeptimer_start_timer_ms(&sample_timer, JOYSTICK_INPUT_SAMPLE_MS,
+                               sample_timer_callback, NULL, 0, 0);
+}
+
+bool joystick_input_get_event(joystick_input_event_t *event)
+{
+  bool available = false;
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (queue_tail != queue_head) {
+    *event = queue[queue_tail % JOYSTICK_INPUT_QUEUE_SIZE];
+    queue_tail++;
+    available = true;
+  }
+  CORE_EXIT_ATOMIC();
+  return available;
+}
+
+sl_joystick_position_t joystick_input_get_position(void)
+{
+  return stable_position;
+}
+
+void joystick_input_get_stats(joystick_input_stats_t *out)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  *out = stats;
+  CORE_EXIT_ATOMIC();
+}
+
+// --- Internal Helper Functions ---
+
+// Timer context. Only wakes the main loop when an event was queued, and
+// picks the next sample's interval.
+static void sample_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  stats.samples++;
+  if (sampling_idle) {
+    stats.idle_samples++;
+  }
+  sample_position(now);
+
+  if (stable_position != JOYSTICK_NONE || candidate_count > 0) {
+    last_active_tick = now;
+  }
+  sampling_idle = now - last_active_tick >= sl_sleeptimer_ms_to_tick(JOYSTICK_INPUT_IDLE_AFTER_MS);
+  sl_sleeptimer_start_timer_ms(&sample_timer,
+                               sampling_idle ? JOYSTICK_INPUT_IDLE_SAMPLE_MS : JOYSTICK_INPUT_SAMPLE_MS,
+                               sample_timer_callback, NULL, 0, 0);
+}
+
+static void sample_position(uint32_t now)
+{
+  sl_joystick_position_t position = JOYSTICK_NONE;
+  sl_joystick_get_position(&joystick_handle, &position);
+
+  if (position != stable_position) {
+    if (candidate_count > 0 && position == candidate_position) {
+      candidate_count++;
+    } else {
+      if (candidate_count > 0) {
+        stats.glitches++;
+      }
+      candidate_position = position;
+      candidate_count = 1;
+    }
+    if (candidate_count >= JOYSTICK_INPUT_STABLE_SAMPLES) {
+      accept_position(position, now);
+    }
+    return;
+  }
+
+  if (candidate_count > 0) {
+    stats.glitches++; // bounced back to the stable position
+    candidate_count = 0;
+  }
+  if (stable_position != JOYSTICK_NONE && (int32_t)(now - next_hold_tick) >= 0) {
+    queue_event(JOYSTICK_INPUT_HOLD, stable_position, now);
+    next_hold_tick += sl_sleeptimer_ms_to_tick(JOYSTICK_INPUT_HOLD_REPEAT_MS);
+  }
+}
+
+static void accept_position(sl_joystick_position_t position, uint32_t now)
+{
+  if (stable_position != JOYSTICK_NONE) {
+    queue_event(JOYSTICK_INPUT_RELEASE, stable_position, now);
+  }
+  if (position != JOYSTICK_NONE) {
+    queue_event(JOYSTICK_INPUT_PRESS, position, now);
+    next_hold_tick = now + sl_sleeptimer_ms_to_tick(JOYSTICK_INPUT_HOLD_DELAY_MS);
+  }
+  stable_position = position;
+  candidate_count = 0;
+}
+
+static void queue_event(joystick_input_event_type_t type, sl_joystick_position_t position, uint32_t now)
+{
+  trace_event(TRACE_JOYSTICK, (uint8_t)type, (uint16_t)position);
+  if (queue_head - queue_tail >= JOYSTICK_INPUT_QUEUE_SIZE) {
+    stats.events_dropped++;
+    return;
+  }
+  joystick_input_event_t *event = &queue[queue_head % JOYSTICK_INPUT_QUEUE_SIZE];
+  event->type = type;
+  event->position = position;
+  event->tick = now;
+  queue_head++;
+  stats.events++;
+  app_events_post(APP_EVENT_JOYSTICK);
+}
@@ -0,0 +1,50 @@
+#ifndef JOYSTICK_INPUT_H
+#define JOYSTICK_INPUT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sl_joystick.h"
+
+// Joystick front end. A sleeptimer samples the joystick position every
+// JOYSTICK_INPUT_SAMPLE_MS; a position must be seen on
+// JOYSTICK_INPUT_STABLE_SAMPLES consecutive samples before it is accepted, and
+// accepted changes are queued as timestamped press, hold and release events.
+// Once the stick has been centred and settled for JOYSTICK_INPUT_IDLE_AFTER_MS
+// it is only sampled every JOYSTICK_INPUT_IDLE_SAMPLE_MS, until it moves again.
+// Diagonals are reported as their own positions when the joystick driver is
+// built with ENABLE_SECONDARY_DIRECTIONS.
+#define JOYSTICK_INPUT_SAMPLE_MS        5
+#define JOYSTICK_INPUT_IDLE_SAMPLE_MS   50
+#define JOYSTICK_INPUT_IDLE_AFTER_MS    500 // keeps the fast rate between the taps of a game
+#define JOYSTICK_INPUT_STABLE_SAMPLES   2
+#define JOYSTICK_INPUT_HOLD_DELAY_MS    150 // first hold event after the press
+#define JOYSTICK_INPUT_HOLD_REPEAT_MS   150 // further hold events while held
+#define JOYSTICK_INPUT_QUEUE_SIZE       8   // power of two
+
+typedef enum {
+  JOYSTICK_INPUT_PRESS,
+  JOYSTICK_INPUT_HOLD,
+  JOYSTICK_INPUT_RELEASE
+} joystick_input_event_type_t;
+
+typedef struct {
+  joystick_input_event_type_t type;
+  sl_joystick_position_t position;
+  uint32_t tick; // sleeptimer tick of the sample that confirmed the event
+} joystick_input_event_t;
+
+typedef struct {
+  uint32_t samples;
+  uint32_t idle_samples;   // of which at the idle rate
+  uint32_t glitches;       // candidate positions dropped before they became stable
+  uint32_t events;
+  uint32_t events_dropped; // queue overflow
+} joystick_input_stats_t;
+
+void joystick_input_init(void);
+bool joystick_input_get_event(joystick_input_event_t *event);
+sl_joystick_position_t joystick_input_get_position(void);
+void joystick_input_get_stats(joystick_input_stats_t *stats);
+
+#endif // JOYSTICK_INPUT_H
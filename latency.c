@@ -0,0 +1,146 @@
+#include "latency.h"
+#include "sl_debug_swo.h"
+#include "sl_sleeptimer.h"
+#include "memory_monitor.h"
+#include <stdio.h>
+#include <string.h>
+
+#define SWO_CHANNEL   0
+#define LINE_LENGTH   128
+
+typedef struct {
+  latency_input_t type;
+  uint32_t tick;
+} open_measurement_t;
+
+static const char *const input_names[LATENCY_INPUT_COUNT] = {
+  [LATENCY_INPUT_PRESS]  = "press",
+  [LATENCY_INPUT_REPEAT] = "repeat",
+  [LATENCY_INPUT_BUTTON] = "button",
+};
+
+static latency_stats_t stats[LATENCY_INPUT_COUNT];
+static open_measurement_t open_measurements[LATENCY_MAX_OPEN];
+static int open_count = 0;
+
+// --- Local function prototypes ---
+static void record(latency_input_t type, uint32_t latency_us);
+
+// --- Public functions ---
+
+void latency_init(void)
+{
+  memory_monitor_account("latency", sizeof(stats) + sizeof(open_measurements));
+  memset(stats, 0, sizeof(stats));
+  for (int i = 0; i < LATENCY_INPUT_COUNT; i++) {
+    stats[i].min_us = UINT32_MAX;
+  }
+  open_count = 0;
+}
+
+void latency_input(latency_input_t type, uint32_t source_tick)
+{
+  if (open_count == LATENCY_MAX_OPEN) {
+    stats[type].dropped++;
+    return;
+  }
+  open_measurements[open_count].type = type;
+  open_measurements[open_count].tick = source_tick;
+  open_count++;
+}
+
+// Called once DMD_updateDisplay() has returned, i.e. the frame is on the glass
+void latency_frame_done(void)
+{
+  if (open_count == 0) {
+    return;
+  }
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  uint32_t frequency = sl_sleeptimer_get_timer_frequency();
+  for (int i = 0; i < open_count; i++) {
+    uint64_t ticks = now - open_measurements[i].tick;
+    record(open_measurements[i].type, (uint32_t)((ticks * 1000000u) / frequency));
+  }
+  open_count = 0;
+}
+
+// End of a main loop pass: whatever is still open never reached the screen
+void latency_end_pass(void)
+{
+  for (int i = 0; i < open_count; i++) {
+    stats[open_measurements[i].type].dropped++;
+  }
+  open_count = 0;
+}
+
+void latency_get_stats(latency_input_t type, latency_stats_t *out)
+{
+  *out = stats[type];
+}
+
+// Upper edge of the bucket holding the given percentile
+uint32_t latency_percentile_ms(const latency_stats_t *s, uint32_t percent)
+{
+  if (s->count == 0) {
+    return 0;
+  }
+  uint32_t target = (s->count * percent + 99) / 100;
+  uint32_t seen = 0;
+  for (int b = 0; b < LATENCY_BUCKETS - 1; b++) {
+    seen += s->histogram[b];
+    if (seen >= target) {
+      return (uint32_t)(b + 1) * LATENCY_BUCKET_MS;
+    }
+  }
+  return s->max_us / 1000;
+}
+
+const char *latency_input_name(latency_input_t type)
+{
+  return input_names[type];
+}
+
+void latency_export_swo(void)
+{
+  char line[LINE_LENGTH];
+  for (int i = 0; i < LATENCY_INPUT_COUNT; i++) {
+    const latency_stats_t *s = &stats[i];
+    int len = snprintf(line, sizeof(line), "lat %s n=%lu drop=%lu avg_us=%lu min_us=%lu max_us=%lu hist%dms=",
+                       input_names[i],
+                       (unsigned long)s->count,
+                       (unsigned long)s->dropped,
+                       (unsigned long)(s->count ? s->total_us / s->count : 0),
+                       (unsigned long)(s->count ? s->min_us : 0),
+                       (unsigned long)s->max_us,
+                       LATENCY_BUCKET_MS);
+    for (int b = 0; b < LATENCY_BUCKETS && len > 0 && len < (int)sizeof(line); b++) {
+      len += snprintf(line + len, sizeof(line) - len, b == 0 ? "%lu" : ",%lu",
+                      (unsigned long)s->histogram[b]);
+    }
+    if (len > 0 && len < (int)sizeof(line) - 1) {
+      line[len] = '\n';
+      line[len + 1] = '\0';
+    }
+    for (const char *c = line; *c; c++) {
+      sl_debug_swo_write_u8(SWO_CHANNEL, (uint8_t)*c);
+    }
+  }
+}
+
+// --- Internal Helper Functions ---
+
+static void record(latency_input_t type, uint32_t latency_us)
+{
+  latency_stats_t *s = &stats[type];
+  uint32_t bucket = latency_us / (LATENCY_BUCKET_MS * 1000u);
+
+  s->count++;
+  s->total_us += latency_us;
+  if (latency_us < s->min_us) {
+    s->min_us = latency_us;
+  }
+  if (latency_us > s->max_us) {
+    s->max_us = latency_us;
+  }
+  s->histogram[bucket < LATENCY_BUCKETS ? bucket : LATENCY_BUCKETS - 1]++;
+}
@@ -0,0 +1,40 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdint.h>
+
+// Input-to-photon latency. An input opens a measurement with the sleeptimer
+// tick of its source (joystick sample, button interrupt or repeat deadline);
+// the next LCD transfer to finish closes every open measurement. Inputs whose
+// main loop pass ends without drawing a frame changed nothing on screen and
+// are dropped, so they do not borrow a later, unrelated frame.
+#define LATENCY_MAX_OPEN     4
+#define LATENCY_BUCKET_MS    4
+#define LATENCY_BUCKETS      16  // the last bucket collects everything above
+
+typedef enum {
+  LATENCY_INPUT_PRESS,   // joystick press
+  LATENCY_INPUT_REPEAT,  // joystick hold event or DAS/ARR repeat
+  LATENCY_INPUT_BUTTON,
+  LATENCY_INPUT_COUNT
+} latency_input_t;
+
+typedef struct {
+  uint32_t count;
+  uint32_t dropped;      // inputs that produced no frame
+  uint64_t total_us;
+  uint32_t min_us;
+  uint32_t max_us;
+  uint32_t histogram[LATENCY_BUCKETS];
+} latency_stats_t;
+
+void latency_init(void);
+void latency_input(latency_input_t type, uint32_t source_tick);
+void latency_frame_done(void);
+void latency_end_pass(void);
+void latency_get_stats(latency_input_t type, latency_stats_t *out);
+uint32_t latency_percentile_ms(const latency_stats_t *stats, uint32_t percent);
+const char *latency_input_name(latency_input_t type);
+void latency_export_swo(void);
+
+#endif // LATENCY_H
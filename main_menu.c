@@ -1,23 +1,35 @@
 #include "main_menu.h"
 #include "tetris.h"
+#include "autosave.h"
+#include "stats.h"
+#include "storage_telemetry.h"
+#include "app_events.h"
+#include "auto_repeat.h"
+#include "trace.h"
+#include "latency.h"
+#include "diagnostics.h"
+#include "memory_monitor.h"
 #include "glib.h"
 #include "sl_simple_button_instances.h"
+#include "sl_sleeptimer.h"
 #include <stdio.h>
 #include <string.h>
 
 // --- Module state ---
 static int selected_option = 0;
 static int start_level = 1;
+static bool practice_mode = false; // left/right on the first option
 
-static const char* menu_options_no_load[] = {"Start Game", "Adjust Level", "Scoreboard"};
-static const char* menu_options_with_load[] = {"Start Game", "Adjust Level", "Load Game", "Scoreboard"};
-static const char** menu_options;
+#define MAX_MENU_OPTIONS 7
+
+static const char* menu_options[MAX_MENU_OPTIONS];
 static int num_menu_options;
 
 
 // --- Local Functions ---
 static void draw_title(GLIB_Context_t *pGlib);
 static void draw_background_blocks(GLIB_Context_t *pGlib);
+static void build_menu_options(void);
 
 // --- Public Functions ---
 
@@ -25,13 +37,8 @@ void main_menu_init(void)
 {
   selected_option = 0;
   start_level = 1;
-  if (tetris_has_saved_game()) {
-    menu_options = menu_options_with_load;
-    num_menu_options = 4;
-  } else {
-    menu_options = menu_options_no_load;
-    num_menu_options = 3;
-  }
+  practice_mode = false;
+  build_menu_options();
 }
 
 int main_menu_get_start_level(void)
@@ -44,9 +51,15 @@ void main_menu_draw(void)
   GLIB_Context_t *pGlib = tetris_get_glib_context();
   GLIB_clear(pGlib);
 
+  // Saves and the autosave checkpoint come and go while the app runs
+  build_menu_options();
+
   // 1. Draw the decorative background
   // draw_background_blocks(pGlib);
   draw_title(pGlib);
+  if (memory_monitor_headroom_low()) {
+    GLIB_drawString(pGlib, "RAM LOW", 7, 0, 0, 0);
+  }
 
   // 2. Draw a semi-transparent overlay for the menu options
   GLIB_Rectangle_t rect = { .xMin = 10, .yMin = 55, .xMax = 118, .yMax = 125 };
@@ -56,8 +69,9 @@ void main_menu_draw(void)
   pGlib->backgroundColor = White;
 
   // 3. Draw Menu Options
+  int option_spacing = (num_menu_options > 6) ? 10 : (num_menu_options > 5) ? 11 : 15;
   for (int i = 0; i < num_menu_options; i++) {
-    int option_y = 60 + (i * 15);
+    int option_y = 60 + (i * option_spacing);
     const char* option_text = menu_options[i];
     int text_x = (pGlib->pDisplayGeometry->xSize - (strlen(option_text) * 6)) / 2;
 
@@ -73,7 +87,7 @@ void main_menu_draw(void)
     }
   }
 
-  DMD_updateDisplay();
+  tetris_update_display();
   pGlib->backgroundColor = White; // Reset for other parts of the app
 }
 
@@ -85,6 +99,10 @@ void main_menu_handle_input(sl_joystick_position_t joystick_pos, const sl_button
     selected_option = (selected_option - 1 + num_menu_options) % num_menu_options;
   }
 
+  if (selected_option == 0 && (joystick_pos == JOYSTICK_E || joystick_pos == JOYSTICK_W)) {
+    practice_mode = !practice_mode;
+  }
+
   if (selected_option == 1) { // Adjust Level
     if (joystick_pos == JOYSTICK_E) { // Right
       start_level++;
@@ -100,18 +118,45 @@ void main_menu_handle_input(sl_joystick_position_t joystick_pos, const sl_button
   }
 
   if (joystick_pos == JOYSTICK_C) { // Center click
-    if (selected_option == 0) { // Start Game
+    if (selected_option == 0) { // Start Game or Practice
+      tetris_set_practice(practice_mode);
       tetris_start_new_game(start_level);
+    } else if (strcmp(menu_options[selected_option], "Handling") == 0) {
+      tetris_set_game_state(GAME_STATE_HANDLING);
+    } else if (strcmp(menu_options[selected_option], "Resume") == 0) {
+      autosave_resume();
     } else if (strcmp(menu_options[selected_option], "Load Game") == 0) {
       tetris_set_game_state(GAME_STATE_SLOT_SELECTION);
     } else if (strcmp(menu_options[selected_option], "Scoreboard") == 0) {
         tetris_set_game_state(GAME_STATE_SCOREBOARD);
+    } else if (strcmp(menu_options[selected_option], "Statistics") == 0) {
+        tetris_set_game_state(GAME_STATE_STATS);
     }
   }
 
   (void)button_handle; // Suppress unused parameter warning
 }
 
+static void build_menu_options(void)
+{
+  num_menu_options = 0;
+  menu_options[num_menu_options++] = practice_mode ? "Practice" : "Start Game";
+  menu_options[num_menu_options++] = "Adjust Level"; // must stay at index 1
+  menu_options[num_menu_options++] = "Handling";
+  if (autosave_has_checkpoint()) {
+    menu_options[num_menu_options++] = "Resume";
+  }
+  if (tetris_has_saved_game()) {
+    menu_options[num_menu_options++] = "Load Game";
+  }
+  menu_options[num_menu_options++] = "Scoreboard";
+  menu_options[num_menu_options++] = "Statistics";
+
+  if (selected_option >= num_menu_options) {
+    selected_option = num_menu_options - 1;
+  }
+}
+
 // --- Pixel Art Title (Bitmap-based) ---
 #define FONT_BLOCK_SIZE 4
 #define FONT_LETTER_HEIGHT 5
@@ -181,11 +226,61 @@ static void draw_background_blocks(GLIB_Context_t *pGlib)
 
 // --- Slot Menu ---
 
+// How long the cursor has to rest on a slot before it is prefetched
+#define SLOT_PREFETCH_DWELL_MS 200
+
 static int selected_slot = 0;
+static uint32_t selected_slot_tick = 0;
+static sl_sleeptimer_timer_handle_t slot_dwell_timer;
+
+static void slot_dwell_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  app_events_post(APP_EVENT_JOYSTICK); // delivers an idle sample to slot_menu_handle_input()
+}
+
+static void slot_menu_select(int slot_index)
+{
+  selected_slot = slot_index;
+  selected_slot_tick = sl_sleeptimer_get_tick_count();
+  sl_sleeptimer_stop_timer(&slot_dwell_timer);
+  sl_sleeptimer_start_timer_ms(&slot_dwell_timer, SLOT_PREFETCH_DWELL_MS, slot_dwell_timer_callback, NULL, 0, 0);
+}
+
+// Mini board preview drawn to the right of each slot name
+#define SLOT_PREVIEW_X          104
+#define SLOT_PREVIEW_COL_WIDTH  2
+#define SLOT_PREVIEW_MAX_HEIGHT 11
+
+static void draw_slot_preview(GLIB_Context_t *pGlib, int slot_index, int option_y)
+{
+  uint8_t heights[BOARD_WIDTH];
+  if (!tetris_get_slot_silhouette(slot_index, heights)) {
+    return;
+  }
+
+  int base_y = option_y + SLOT_PREVIEW_MAX_HEIGHT - 3;
+  GLIB_Rectangle_t rect = { .xMin = SLOT_PREVIEW_X - 1, .yMin = base_y - SLOT_PREVIEW_MAX_HEIGHT,
+                            .xMax = SLOT_PREVIEW_X + BOARD_WIDTH * SLOT_PREVIEW_COL_WIDTH, .yMax = base_y + 1 };
+  GLIB_drawRect(pGlib, &rect);
+
+  for (int x = 0; x < BOARD_WIDTH; x++) {
+    if (heights[x] == 0) {
+      continue;
+    }
+    rect.xMin = SLOT_PREVIEW_X + x * SLOT_PREVIEW_COL_WIDTH;
+    rect.xMax = rect.xMin + SLOT_PREVIEW_COL_WIDTH - 1;
+    rect.yMax = base_y;
+    rect.yMin = base_y - heights[x] + 1;
+    GLIB_drawRectFilled(pGlib, &rect);
+  }
+}
 
 void slot_menu_init(void)
 {
   selected_slot = 0;
+  selected_slot_tick = sl_sleeptimer_get_tick_count();
 }
 
 void slot_menu_draw(void)
@@ -208,6 +303,7 @@ void slot_menu_draw(void)
       GLIB_drawString(pGlib, ">", 1, 10, option_y, 0);
     }
     GLIB_drawString(pGlib, slot_name, strlen(slot_name), 20, option_y, 0);
+    draw_slot_preview(pGlib, i, option_y);
   }
 
   // Button hints
@@ -215,15 +311,21 @@ void slot_menu_draw(void)
   text_x = (pGlib->pDisplayGeometry->xSize - (strlen(hint_text) * 6)) / 2;
   GLIB_drawString(pGlib, hint_text, strlen(hint_text), text_x, 120, 0);
 
-  DMD_updateDisplay();
+  tetris_update_display();
 }
 
 void slot_menu_handle_input(sl_joystick_position_t joystick_pos, const sl_button_t *button_handle)
 {
   if (joystick_pos == JOYSTICK_S) { // Down
-    selected_slot = (selected_slot + 1) % 5;
+    slot_menu_select((selected_slot + 1) % 5);
   } else if (joystick_pos == JOYSTICK_N) { // Up
-    selected_slot = (selected_slot - 1 + 5) % 5;
+    slot_menu_select((selected_slot - 1 + 5) % 5);
+  }
+
+  // Warm the load cache once the cursor rests on a slot
+  if (button_handle == NULL
+      && sl_sleeptimer_get_tick_count() - selected_slot_tick >= sl_sleeptimer_ms_to_tick(SLOT_PREFETCH_DWELL_MS)) {
+    tetris_prefetch_slot(selected_slot);
   }
 
   if (joystick_pos == JOYSTICK_C) { // Center click to load
@@ -266,7 +368,7 @@ void scoreboard_draw(void)
     text_x = (pGlib->pDisplayGeometry->xSize - (strlen(hint_text) * 6)) / 2;
     GLIB_drawString(pGlib, hint_text, strlen(hint_text), text_x, 110, 0);
 
-    DMD_updateDisplay();
+    tetris_update_display();
 }
 
 void scoreboard_handle_input(sl_joystick_position_t joystick_pos, const sl_button_t *button_handle)
@@ -275,4 +377,405 @@ void scoreboard_handle_input(sl_joystick_position_t joystick_pos, const sl_butto
     if (button_handle == &sl_button_btn1) { // Back to main menu
         tetris_set_game_state(GAME_STATE_MAIN_MENU);
     }
-}
\ No newline at end of file
+}
+
+// --- Statistics ---
+
+// Hidden diagnostics pages, cycled with BTN0 on the statistics screen
+typedef enum {
+    STATS_VIEW_TOTALS,
+    STATS_VIEW_STORAGE,
+    STATS_VIEW_POWER,
+    STATS_VIEW_LATENCY,
+    STATS_VIEW_COUNT
+} stats_view_t;
+
+static stats_view_t stats_view = STATS_VIEW_TOTALS;
+
+// A label with two full 32-bit counters; the LCD shows 21 columns and clips the rest
+#define STATS_LINE_BYTES 40
+
+static void draw_storage_view(GLIB_Context_t *pGlib)
+{
+    storage_telemetry_t telemetry;
+    storage_telemetry_get(&telemetry);
+
+    char* title_text = "Storage";
+    int text_x = (pGlib->pDisplayGeometry->xSize - (strlen(title_text) * 6)) / 2;
+    GLIB_drawString(pGlib, title_text, strlen(title_text), text_x, 10, 0);
+
+    uint32_t min_erases = 0xFFFFFFFF;
+    uint32_t max_erases = 0;
+    for (uint32_t i = 0; i < telemetry.page_count; i++) {
+        if (telemetry.page_erase_estimate[i] < min_erases) {
+            min_erases = telemetry.page_erase_estimate[i];
+        }
+        if (telemetry.page_erase_estimate[i] > max_erases) {
+            max_erases = telemetry.page_erase_estimate[i];
+        }
+    }
+    if (telemetry.page_count == 0) {
+        min_erases = 0;
+    }
+
+    storage_key_stats_t top_key = { 0 };
+    storage_key_stats_t key_stats;
+    for (int i = 0; storage_telemetry_get_key(i, &key_stats); i++) {
+        if (key_stats.writes > top_key.writes) {
+            top_key = key_stats;
+        }
+    }
+
+    char line_buffer[STATS_LINE_BYTES];
+    int y = 24;
+    snprintf(line_buffer, sizeof(line_buffer), "Writes: %lu", (unsigned long)telemetry.writes);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Bytes: %lu", (unsigned long)telemetry.bytes_written);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Free: %lu/%lu",
+             (unsigned long)telemetry.free_bytes_estimate, (unsigned long)telemetry.nvm_size);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Min free: %lu", (unsigned long)telemetry.min_free_bytes_estimate);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Repacks: %lu %lums",
+             (unsigned long)telemetry.repacks, (unsigned long)telemetry.max_repack_ms);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Erases: %lu-%lu", (unsigned long)min_erases, (unsigned long)max_erases);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Top: key %lu x%lu",
+             (unsigned long)top_key.key, (unsigned long)top_key.writes);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+
+    // Slot load time, to compare loads the slot menu prefetched with cold ones
+    uint32_t load_ticks;
+    bool prefetched;
+    if (tetris_get_last_load_ticks(&load_ticks, &prefetched)) {
+        uint32_t load_us = (uint32_t)(((uint64_t)load_ticks * 1000000u) / sl_sleeptimer_get_timer_frequency());
+        snprintf(line_buffer, sizeof(line_buffer), "Load: %luus %s", (unsigned long)load_us, prefetched ? "pre" : "cold");
+    } else {
+        snprintf(line_buffer, sizeof(line_buffer), "Load: -");
+    }
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0);
+}
+
+static void draw_power_view(GLIB_Context_t *pGlib)
+{
+    app_duty_cycle_t duty;
+    app_events_get_duty_cycle(&duty);
+
+    char* title_text = "Power";
+    int text_x = (pGlib->pDisplayGeometry->xSize - (strlen(title_text) * 6)) / 2;
+    GLIB_drawString(pGlib, title_text, strlen(title_text), text_x, 10, 0);
+
+    // Tenths of a percent, without pulling float formatting into the build
+    uint32_t awake_permille = 1000;
+    if (duty.total_ticks > 0) {
+        awake_permille = (uint32_t)(((duty.total_ticks - duty.sleep_ticks) * 1000) / duty.total_ticks);
+    }
+    uint32_t seconds = (uint32_t)(duty.total_ticks / sl_sleeptimer_get_timer_frequency());
+
+    char line_buffer[24];
+    int y = 24;
+    snprintf(line_buffer, sizeof(line_buffer), "Awake: %lu.%lu%%",
+             (unsigned long)(awake_permille / 10), (unsigned long)(awake_permille % 10));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "EM2: %lu.%lu%%",
+             (unsigned long)((1000 - awake_permille) / 10), (unsigned long)((1000 - awake_permille) % 10));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Wakeups: %lu", (unsigned long)duty.wakeups);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Per sec: %lu", (unsigned long)(seconds ? duty.wakeups / seconds : 0));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Events: %lu", (unsigned long)duty.events_handled);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Up: %lu:%02lu:%02lu",
+             (unsigned long)(seconds / 3600), (unsigned long)((seconds / 60) % 60), (unsigned long)(seconds % 60));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    if (!duty.sleep_supported) {
+        GLIB_drawString(pGlib, "Sleep disabled", 14, 4, y, 0);
+    }
+}
+
+// Input-to-photon latency per input type, with the joystick press histogram below
+static void draw_latency_view(GLIB_Context_t *pGlib)
+{
+    char* title_text = "Latency";
+    int text_x = (pGlib->pDisplayGeometry->xSize - (strlen(title_text) * 6)) / 2;
+    GLIB_drawString(pGlib, title_text, strlen(title_text), text_x, 10, 0);
+
+    char line_buffer[STATS_LINE_BYTES];
+    int y = 24;
+    for (int i = 0; i < LATENCY_INPUT_COUNT; i++) {
+        latency_stats_t s;
+        latency_get_stats((latency_input_t)i, &s);
+        snprintf(line_buffer, sizeof(line_buffer), "%s n%lu p95 %lu",
+                 latency_input_name((latency_input_t)i), (unsigned long)s.count,
+                 (unsigned long)latency_percentile_ms(&s, 95));
+        GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 10;
+        uint32_t avg_ms = (uint32_t)(s.count ? s.total_us / s.count / 1000 : 0); // the average fits where the max does
+        snprintf(line_buffer, sizeof(line_buffer), " avg %lu max %lu ms",
+                 (unsigned long)avg_ms, (unsigned long)(s.max_us / 1000));
+        GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    }
+
+    latency_stats_t press;
+    latency_get_stats(LATENCY_INPUT_PRESS, &press);
+    uint32_t tallest = 1;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        if (press.histogram[b] > tallest) {
+            tallest = press.histogram[b];
+        }
+    }
+    int bar_width = pGlib->pDisplayGeometry->xSize / LATENCY_BUCKETS;
+    int baseline = pGlib->pDisplayGeometry->ySize - 2;
+    for (int b = 0; b < LATENCY_BUCKETS; b++) {
+        int height = (int)((press.histogram[b] * 28) / tallest);
+        if (height == 0) {
+            continue;
+        }
+        GLIB_Rectangle_t bar = {
+            .xMin = b * bar_width, .yMin = baseline - height,
+            .xMax = b * bar_width + bar_width - 2, .yMax = baseline
+        };
+        GLIB_drawRectFilled(pGlib, &bar);
+    }
+}
+
+void stats_screen_draw(void)
+{
+    GLIB_Context_t *pGlib = tetris_get_glib_context();
+    GLIB_clear(pGlib);
+
+    if (stats_view == STATS_VIEW_STORAGE) {
+        draw_storage_view(pGlib);
+        tetris_update_display();
+        return;
+    }
+    if (stats_view == STATS_VIEW_POWER) {
+        draw_power_view(pGlib);
+        tetris_update_display();
+        return;
+    }
+    if (stats_view == STATS_VIEW_LATENCY) {
+        draw_latency_view(pGlib);
+        tetris_update_display();
+        return;
+    }
+
+    // Title
+    char* title_text = "Statistics";
+    int text_x = (pGlib->pDisplayGeometry->xSize - (strlen(title_text) * 6)) / 2;
+    GLIB_drawString(pGlib, title_text, strlen(title_text), text_x, 10, 0);
+
+    char line_buffer[24];
+    uint32_t play_seconds = stats_get(STATS_PLAY_SECONDS);
+
+    snprintf(line_buffer, sizeof(line_buffer), "Games:  %lu", (unsigned long)stats_get(STATS_GAMES_PLAYED));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 10, 30, 0);
+    snprintf(line_buffer, sizeof(line_buffer), "Pieces: %lu", (unsigned long)stats_get(STATS_PIECES_PLACED));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 10, 45, 0);
+    snprintf(line_buffer, sizeof(line_buffer), "Lines:  %lu", (unsigned long)stats_get(STATS_LINES_CLEARED));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 10, 60, 0);
+    snprintf(line_buffer, sizeof(line_buffer), "T-Spins: %lu", (unsigned long)stats_get(STATS_T_SPINS));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 10, 75, 0);
+    snprintf(line_buffer, sizeof(line_buffer), "Time:   %lu:%02lu:%02lu",
+             (unsigned long)(play_seconds / 3600), (unsigned long)((play_seconds / 60) % 60), (unsigned long)(play_seconds % 60));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 10, 90, 0);
+
+    // Button hints
+    char* hint_text = "BTN1: BACK";
+    text_x = (pGlib->pDisplayGeometry->xSize - (strlen(hint_text) * 6)) / 2;
+    GLIB_drawString(pGlib, hint_text, strlen(hint_text), text_x, 110, 0);
+
+    tetris_update_display();
+}
+
+void stats_screen_handle_input(sl_joystick_position_t joystick_pos, const sl_button_t *button_handle)
+{
+    if (button_handle == &sl_button_btn1) { // Back to main menu
+        stats_view = STATS_VIEW_TOTALS;
+        tetris_set_game_state(GAME_STATE_MAIN_MENU);
+    }
+    if (button_handle == &sl_button_btn0) { // Not advertised: storage and power diagnostics
+        stats_view = (stats_view + 1) % STATS_VIEW_COUNT;
+    }
+    if (joystick_pos == JOYSTICK_C) { // Not advertised: dump the event trace and latency histograms to SWO
+        trace_dump_swo();
+        latency_export_swo();
+    }
+}
+
+// --- Handling ---
+
+#define HANDLING_ROWS 3
+
+static const uint16_t soft_drop_factors[] = { 1, 2, 5, 10, 20, AUTO_REPEAT_SOFT_DROP_MAX };
+#define SOFT_DROP_FACTOR_COUNT ((int)(sizeof(soft_drop_factors) / sizeof(soft_drop_factors[0])))
+
+static int selected_handling_row = 0;
+
+void handling_screen_draw(void)
+{
+    GLIB_Context_t *pGlib = tetris_get_glib_context();
+    GLIB_clear(pGlib);
+
+    auto_repeat_settings_t settings;
+    auto_repeat_get_settings(&settings);
+
+    // Title
+    char* title_text = "Handling";
+    int text_x = (pGlib->pDisplayGeometry->xSize - (strlen(title_text) * 6)) / 2;
+    GLIB_drawString(pGlib, title_text, strlen(title_text), text_x, 10, 0);
+
+    char line_buffer[24];
+    for (int i = 0; i < HANDLING_ROWS; i++) {
+        int option_y = 35 + (i * 15);
+        if (i == 0) {
+            snprintf(line_buffer, sizeof(line_buffer), "DAS  <%u ms>", (unsigned)settings.das_ms);
+        } else if (i == 1 && settings.arr_ms == 0) {
+            snprintf(line_buffer, sizeof(line_buffer), "ARR  <instant>");
+        } else if (i == 1) {
+            snprintf(line_buffer, sizeof(line_buffer), "ARR  <%u ms>", (unsigned)settings.arr_ms);
+        } else {
+            snprintf(line_buffer, sizeof(line_buffer), "Soft <%ux>", (unsigned)settings.soft_drop_factor);
+        }
+        if (i == selected_handling_row) {
+            GLIB_drawString(pGlib, ">", 1, 10, option_y, 0);
+        }
+        GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 20, option_y, 0);
+    }
+
+    // Button hints
+    char* hint_text = "BTN1: BACK";
+    text_x = (pGlib->pDisplayGeometry->xSize - (strlen(hint_text) * 6)) / 2;
+    GLIB_drawString(pGlib, hint_text, strlen(hint_text), text_x, 110, 0);
+
+    tetris_update_display();
+}
+
+void handling_screen_handle_input(sl_joystick_position_t joystick_pos, const sl_button_t *button_handle)
+{
+    if (joystick_pos == JOYSTICK_S) { // Down
+        selected_handling_row = (selected_handling_row + 1) % HANDLING_ROWS;
+    } else if (joystick_pos == JOYSTICK_N) { // Up
+        selected_handling_row = (selected_handling_row - 1 + HANDLING_ROWS) % HANDLING_ROWS;
+    }
+
+    int step = 0;
+    if (joystick_pos == JOYSTICK_E) { // Right
+        step = 1;
+    } else if (joystick_pos == JOYSTICK_W) { // Left
+        step = -1;
+    }
+    if (step != 0) {
+        auto_repeat_settings_t settings;
+        auto_repeat_get_settings(&settings);
+        if (selected_handling_row == 0) {
+            int das = settings.das_ms + step * AUTO_REPEAT_DAS_STEP_MS;
+            if (das >= AUTO_REPEAT_DAS_MIN_MS && das <= AUTO_REPEAT_DAS_MAX_MS) {
+                settings.das_ms = (uint16_t)das;
+            }
+        } else if (selected_handling_row == 1) {
+            int arr = settings.arr_ms + step * AUTO_REPEAT_ARR_STEP_MS;
+            if (arr >= 0 && arr <= AUTO_REPEAT_ARR_MAX_MS) {
+                settings.arr_ms = (uint16_t)arr;
+            }
+        } else {
+            int index = 0;
+            while (index < SOFT_DROP_FACTOR_COUNT - 1 && soft_drop_factors[index] < settings.soft_drop_factor) {
+                index++;
+            }
+            index += step;
+            if (index >= 0 && index < SOFT_DROP_FACTOR_COUNT) {
+                settings.soft_drop_factor = soft_drop_factors[index];
+            }
+        }
+        auto_repeat_set_settings(&settings);
+    }
+
+    if (button_handle == &sl_button_btn1) { // Back to main menu
+        selected_handling_row = 0;
+        tetris_set_game_state(GAME_STATE_MAIN_MENU);
+    }
+}
+
+// --- Diagnostics ---
+
+static sl_sleeptimer_timer_handle_t diagnostics_timer;
+
+static void diagnostics_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  app_events_post(APP_EVENT_REDRAW);
+}
+
+// Hidden screen for field checks. It redraws once per refresh period, so its
+// own frames barely show up in the numbers it reports.
+void diagnostics_screen_enter(void)
+{
+    diagnostics_window_t discard;
+    diagnostics_sample(&discard); // the first window starts now
+    tetris_set_game_state(GAME_STATE_DIAGNOSTICS);
+    sl_sleeptimer_start_periodic_timer_ms(&diagnostics_timer, DIAGNOSTICS_REFRESH_MS,
+                                          diagnostics_timer_callback, NULL, 0, 0);
+}
+
+void diagnostics_screen_draw(void)
+{
+    GLIB_Context_t *pGlib = tetris_get_glib_context();
+    GLIB_clear(pGlib);
+
+    diagnostics_window_t window;
+    diagnostics_sample(&window);
+    storage_telemetry_t telemetry;
+    storage_telemetry_get(&telemetry);
+    latency_stats_t press;
+    latency_get_stats(LATENCY_INPUT_PRESS, &press);
+
+    char* title_text = "Diagnostics";
+    int text_x = (pGlib->pDisplayGeometry->xSize - (strlen(title_text) * 6)) / 2;
+    GLIB_drawString(pGlib, title_text, strlen(title_text), text_x, 4, 0);
+
+    char line_buffer[STATS_LINE_BYTES];
+    int y = 18;
+    snprintf(line_buffer, sizeof(line_buffer), "Frame %lu.%lu/%lu.%lums",
+             (unsigned long)(window.frame_avg_us / 1000), (unsigned long)((window.frame_avg_us / 100) % 10),
+             (unsigned long)(window.frame_worst_us / 1000), (unsigned long)((window.frame_worst_us / 100) % 10));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Frames/s %lu", (unsigned long)window.frames_per_second);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Loops/s %lu", (unsigned long)window.loops_per_second);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Sleep %lu.%lu%%",
+             (unsigned long)(window.sleep_permille / 10), (unsigned long)(window.sleep_permille % 10));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "NVM free %lu B", (unsigned long)telemetry.free_bytes_estimate);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Repacks %lu", (unsigned long)telemetry.repacks);
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    uint32_t stack_size = memory_monitor_stack_size();
+    uint32_t stack_used = memory_monitor_stack_high_water();
+    snprintf(line_buffer, sizeof(line_buffer), "Stack %lu/%lu B%s",
+             (unsigned long)stack_used, (unsigned long)stack_size,
+             stack_size - stack_used < MEMORY_MONITOR_MIN_STACK_HEADROOM && stack_size > 0 ? " !" : "");
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0); y += 11;
+    snprintf(line_buffer, sizeof(line_buffer), "Lat p50 %lu p95 %lums",
+             (unsigned long)latency_percentile_ms(&press, 50), (unsigned long)latency_percentile_ms(&press, 95));
+    GLIB_drawString(pGlib, line_buffer, strlen(line_buffer), 4, y, 0);
+
+    char* hint_text = "BTN1: Back";
+    text_x = (pGlib->pDisplayGeometry->xSize - (strlen(hint_text) * 6)) / 2;
+    GLIB_drawString(pGlib, hint_text, strlen(hint_text), text_x, 116, 0);
+
+    tetris_update_display();
+}
+
+void diagnostics_screen_handle_input(sl_joystick_position_t joystick_pos, const sl_button_t *button_handle)
+{
+    (void)joystick_pos;
+    if (button_handle == &sl_button_btn1) { // Back to main menu
+        sl_sleeptimer_stop_timer(&diagnostics_timer);
+        tetris_set_game_state(GAME_STATE_MAIN_MENU);
+    }
+}
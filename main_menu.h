@@ -16,4 +16,14 @@ void slot_menu_handle_input(sl_joystick_position_t joystick_pos, const sl_button
 void scoreboard_draw(void);
 void scoreboard_handle_input(sl_joystick_position_t joystick_pos, const sl_button_t *button_handle);
 
+void stats_screen_draw(void);
+void stats_screen_handle_input(sl_joystick_position_t joystick_pos, const sl_button_t *button_handle);
+
+void handling_screen_draw(void);
+void handling_screen_handle_input(sl_joystick_position_t joystick_pos, const sl_button_t *button_handle);
+
+void diagnostics_screen_enter(void);
+void diagnostics_screen_draw(void);
+void diagnostics_screen_handle_input(sl_joystick_position_t joystick_pos, const sl_button_t *button_handle);
+
 #endif // MAIN_MENU_H
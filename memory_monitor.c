@@ -0,0 +1,179 @@
+#include "memory_monitor.h"
+#include "em_device.h"
+#include "sl_component_catalog.h"
+#include "sl_debug_swo.h"
+#include <stdio.h>
+#include <string.h>
+#if defined(SL_CATALOG_MEMORY_MANAGER_PRESENT)
+#include "sl_memory_manager.h"
+#endif
+
+#define SWO_CHANNEL   0
+#define LINE_LENGTH   128
+
+#if defined(__CORTEX_M)
+// Provided by the GCC linker script
+extern uint32_t __data_start__;
+extern uint32_t __bss_end__;
+extern uint32_t __StackLimit;
+extern uint32_t __StackTop;
+#endif
+
+static memory_account_t accounts[MEMORY_MONITOR_MAX_ACCOUNTS];
+static int account_count = 0;
+static bool headroom_low = false;
+static bool budget_printed = false;
+static uint32_t printed_high_water;  // stack high-water mark in the last budget line
+static uint32_t printed_heap_free;
+
+// --- Local function prototypes ---
+static void print_budget_line(const memory_budget_t *budget);
+static void swo_write_line(const char *line);
+
+// --- Public functions ---
+
+// Call as early as possible; stack used before this point is not seen
+void memory_monitor_paint_stack(void)
+{
+#if defined(__CORTEX_M)
+  uint32_t *word = &__StackLimit;
+  uint32_t *end = (uint32_t *)(__get_MSP() - MEMORY_MONITOR_PAINT_GUARD);
+  while (word < end) {
+    *word++ = MEMORY_MONITOR_STACK_PATTERN;
+  }
+#endif
+}
+
+uint32_t memory_monitor_stack_size(void)
+{
+#if defined(__CORTEX_M)
+  return (uint32_t)((uintptr_t)&__StackTop - (uintptr_t)&__StackLimit);
+#else
+  return 0;
+#endif
+}
+
+// Bytes of stack used at the deepest point since the paint
+uint32_t memory_monitor_stack_high_water(void)
+{
+#if defined(__CORTEX_M)
+  const uint32_t *word = &__StackLimit;
+  while (word < &__StackTop && *word == MEMORY_MONITOR_STACK_PATTERN) {
+    word++;
+  }
+  return (uint32_t)((uintptr_t)&__StackTop - (uintptr_t)word);
+#else
+  return 0;
+#endif
+}
+
+// One call per module with all its large statics; calling again replaces the entry
+void memory_monitor_account(const char *module, uint32_t bytes)
+{
+  for (int i = 0; i < account_count; i++) {
+    if (strcmp(accounts[i].module, module) == 0) {
+      accounts[i].bytes = bytes;
+      return;
+    }
+  }
+  if (account_count < MEMORY_MONITOR_MAX_ACCOUNTS) {
+    accounts[account_count].module = module;
+    accounts[account_count].bytes = bytes;
+    account_count++;
+  }
+}
+
+int memory_monitor_get_account_count(void)
+{
+  return account_count;
+}
+
+bool memory_monitor_get_account(int index, memory_account_t *out)
+{
+  if (index < 0 || index >= account_count) {
+    return false;
+  }
+  *out = accounts[index];
+  return true;
+}
+
+void memory_monitor_get_budget(memory_budget_t *out)
+{
+  memset(out, 0, sizeof(*out));
+  for (int i = 0; i < account_count; i++) {
+    out->accounted_bytes += accounts[i].bytes;
+  }
+#if defined(__CORTEX_M)
+  out->static_bytes = (uint32_t)((uintptr_t)&__bss_end__ - (uintptr_t)&__data_start__);
+  out->stack_size = memory_monitor_stack_size();
+  out->stack_high_water = memory_monitor_stack_high_water();
+#endif
+#if defined(SRAM_SIZE)
+  out->ram_size = SRAM_SIZE;
+#endif
+#if defined(SL_CATALOG_MEMORY_MANAGER_PRESENT)
+  out->heap_size = (uint32_t)sl_memory_get_total_heap_size();
+  out->heap_free = (uint32_t)sl_memory_get_free_heap_size();
+#endif
+}
+
+// Run once init is done and again after every game. The first call prints the
+// whole budget to SWO; later calls print the budget line only when the stack
+// high-water mark has grown or free heap has shrunk. Warns when the stack or
+// the heap is short of its threshold, and returns false in that case.
+bool memory_monitor_check(void)
+{
+  memory_budget_t budget;
+  char line[LINE_LENGTH];
+  memory_monitor_get_budget(&budget);
+
+  if (!budget_printed) {
+    print_budget_line(&budget);
+    for (int i = 0; i < account_count; i++) {
+      snprintf(line, sizeof(line), "mem %s=%lu\n", accounts[i].module, (unsigned long)accounts[i].bytes);
+      swo_write_line(line);
+    }
+    budget_printed = true;
+  } else if (budget.stack_high_water > printed_high_water || budget.heap_free < printed_heap_free) {
+    print_budget_line(&budget);
+  }
+
+  headroom_low = false;
+  if (budget.stack_size > 0
+      && budget.stack_size - budget.stack_high_water < MEMORY_MONITOR_MIN_STACK_HEADROOM) {
+    swo_write_line("mem WARNING: stack headroom below threshold\n");
+    headroom_low = true;
+  }
+  if (budget.heap_size > 0 && budget.heap_free < MEMORY_MONITOR_MIN_HEAP_FREE) {
+    swo_write_line("mem WARNING: free RAM below threshold\n");
+    headroom_low = true;
+  }
+  return !headroom_low;
+}
+
+bool memory_monitor_headroom_low(void)
+{
+  return headroom_low;
+}
+
+// --- Internal Helper Functions ---
+
+static void print_budget_line(const memory_budget_t *budget)
+{
+  char line[LINE_LENGTH];
+  snprintf(line, sizeof(line), "mem ram=%lu static=%lu accounted=%lu stack=%lu/%lu heap_free=%lu/%lu\n",
+           (unsigned long)budget->ram_size, (unsigned long)budget->static_bytes,
+           (unsigned long)budget->accounted_bytes, (unsigned long)budget->stack_high_water,
+           (unsigned long)budget->stack_size, (unsigned long)budget->heap_free,
+           (unsigned long)budget->heap_size);
+  swo_write_line(line);
+  printed_high_water = budget->stack_high_water;
+  printed_heap_free = budget->heap_free;
+}
+
+static void swo_write_line(const char *line)
+{
+  while (*line) {
+    sl_debug_swo_write_u8(SWO_CHANNEL, (uint8_t)*line++);
+  }
+}
@@ -0,0 +1,49 @@
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Stack and RAM headroom. At boot the unused part of the main stack (between
+// the linker's __StackLimit and the current stack pointer) is painted with a
+// known pattern; the deepest word no longer holding it marks the most stack
+// ever used. Interrupts share the main stack on this bare-metal build, so
+// their usage is included.
+//
+// Modules report their large statics with memory_monitor_account() from their
+// init functions; the rest of .data/.bss belongs to the SDK and small
+// variables. Whatever RAM is left after statics and the stack goes to the
+// memory manager heap. Host builds have no linker symbols and report zeros.
+#define MEMORY_MONITOR_STACK_PATTERN       0xC5C5C5C5u
+#define MEMORY_MONITOR_PAINT_GUARD         64    // bytes below the stack pointer left unpainted
+#define MEMORY_MONITOR_MAX_ACCOUNTS        16
+#define MEMORY_MONITOR_MIN_STACK_HEADROOM  1024  // stack bytes never reached
+#define MEMORY_MONITOR_MIN_HEAP_FREE       2048  // RAM not claimed by statics, stack or allocations
+
+typedef struct {
+  const char *module;
+  uint32_t bytes;
+} memory_account_t;
+
+typedef struct {
+  uint32_t ram_size;
+  uint32_t static_bytes;      // .data + .bss
+  uint32_t accounted_bytes;   // reported by modules, part of static_bytes
+  uint32_t stack_size;
+  uint32_t stack_high_water;
+  uint32_t heap_size;
+  uint32_t heap_free;
+} memory_budget_t;
+
+void memory_monitor_paint_stack(void);
+uint32_t memory_monitor_stack_size(void);
+uint32_t memory_monitor_stack_high_water(void);
+
+void memory_monitor_account(const char *module, uint32_t bytes);
+int memory_monitor_get_account_count(void);
+bool memory_monitor_get_account(int index, memory_account_t *account);
+void memory_monitor_get_budget(memory_budget_t *budget);
+bool memory_monitor_check(void);
+bool memory_monitor_headroom_low(void);
+
+#endif // MEMORY_MONITOR_H
@@ -0,0 +1,233 @@
+#include "nvm_cache.h"
+#include "nvm3_default.h"
+#include "storage_telemetry.h"
+#include "em_core.h"
+#include "sl_sleeptimer.h"
+#include "app_events.h"
+#include "memory_monitor.h"
+#include "profiler.h"
+#include <string.h>
+
+typedef struct {
+  bool in_use;
+  bool dirty;
+  bool in_flash; // flash_copy mirrors what is stored in NVM3
+  nvm3_ObjectKey_t key;
+  size_t len;
+  uint8_t data[NVM_CACHE_MAX_OBJECT_SIZE];
+  uint8_t flash_copy[NVM_CACHE_MAX_OBJECT_SIZE];
+} nvm_cache_entry_t;
+
+static nvm_cache_entry_t entries[NVM_CACHE_ENTRIES];
+static nvm_cache_stats_t stats;
+static sl_sleeptimer_timer_handle_t flush_timer;
+static volatile bool flush_due = false;
+
+// --- Local function prototypes ---
+static nvm_cache_entry_t *find_entry(nvm3_ObjectKey_t key);
+static nvm_cache_entry_t *load_entry(nvm3_ObjectKey_t key, size_t len);
+static void flush_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+// --- Public functions ---
+
+void nvm_cache_init(void)
+{
+  memory_monitor_account("nvm_cache", sizeof(entries) + sizeof(stats));
+  memset(entries, 0, sizeof(entries));
+  memset(&stats, 0, sizeof(stats));
+  flush_due = false;
+}
+
+Ecode_t nvm_cache_read(nvm3_ObjectKey_t key, void *data, size_t len)
+{
+  nvm_cache_entry_t *entry = find_entry(key);
+  if (entry == NULL) {
+    entry = load_entry(key, len);
+    if (entry == NULL) {
+      Ecode_t err;
+      PROFILE_CALL(PROFILE_ZONE_NVM3_READ, err = nvm3_readData(nvm3_defaultHandle, key, data, len));
+      return err;
+    }
+  }
+  if (!entry->in_flash && !entry->dirty) {
+    return ECODE_NVM3_ERR_KEY_NOT_FOUND;
+  }
+  if (entry->len != len) {
+    return ECODE_NVM3_ERR_READ_DATA_SIZE;
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  memcpy(data, entry->data, len);
+  CORE_EXIT_ATOMIC();
+  return ECODE_NVM3_OK;
+}
+
+// May be called from timer callbacks; only touches RAM.
+Ecode_t nvm_cache_write(nvm3_ObjectKey_t key, const void *data, size_t len)
+{
+  if (len > NVM_CACHE_MAX_OBJECT_SIZE) {
+    return storage_write(key, data, len);
+  }
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  stats.writes_requested++;
+
+  nvm_cache_entry_t *entry = find_entry(key);
+  if (entry == NULL) {
+    for (int i = 0; i < NVM_CACHE_ENTRIES; i++) {
+      if (!entries[i].in_use) {
+        entry = &entries[i];
+        memset(entry, 0, sizeof(*entry));
+        entry->in_use = true;
+        entry->key = key;
+        break;
+      }
+    }
+  }
+  if (entry == NULL) {
+    CORE_EXIT_ATOMIC();
+    return storage_write(key, data, len);
+  }
+
+  bool same_as_cached = (entry->in_flash || entry->dirty)
+                        && entry->len == len
+                        && memcmp(entry->data, data, len) == 0;
+  if (same_as_cached) {
+    stats.writes_suppressed++;
+  } else {
+    if (entry->dirty) {
+      stats.writes_coalesced++;
+    }
+    memcpy(entry->data, data, len);
+    entry->len = len;
+    entry->dirty = true;
+  }
+  bool start_timer = entry->dirty && !flush_due;
+  CORE_EXIT_ATOMIC();
+
+  if (start_timer) {
+    bool running = false;
+    sl_sleeptimer_is_timer_running(&flush_timer, &running);
+    if (!running) {
+      sl_sleeptimer_start_timer_ms(&flush_timer, NVM_CACHE_FLUSH_DELAY_MS, flush_timer_callback, NULL, 0, 0);
+    }
+  }
+  return ECODE_NVM3_OK;
+}
+
+// Must run from the main loop: this is where the flash writes happen.
+void nvm_cache_flush(void)
+{
+  uint8_t buffer[NVM_CACHE_MAX_OBJECT_SIZE];
+
+  sl_sleeptimer_stop_timer(&flush_timer);
+  flush_due = false;
+
+  for (int i = 0; i < NVM_CACHE_ENTRIES; i++) {
+    nvm_cache_entry_t *entry = &entries[i];
+    size_t len;
+
+    CORE_DECLARE_IRQ_STATE;
+    CORE_ENTER_ATOMIC();
+    bool dirty = entry->in_use && entry->dirty;
+    if (dirty) {
+      len = entry->len;
+      memcpy(buffer, entry->data, len);
+      entry->dirty = false;
+    }
+    CORE_EXIT_ATOMIC();
+    if (!dirty) {
+      continue;
+    }
+
+    // The object may have been written back to its flash content before flushing
+    if (entry->in_flash && memcmp(buffer, entry->flash_copy, len) == 0) {
+      stats.writes_suppressed++;
+      continue;
+    }
+
+    Ecode_t err = storage_write(entry->key, buffer, len);
+    if (err == ECODE_NVM3_OK) {
+      stats.writes_issued++;
+      memcpy(entry->flash_copy, buffer, len);
+      entry->in_flash = true;
+    } else {
+      stats.write_errors++;
+      CORE_ENTER_ATOMIC();
+      entry->dirty = true; // retry at the next flush point
+      CORE_EXIT_ATOMIC();
+    }
+  }
+}
+
+void nvm_cache_process_action(void)
+{
+  if (flush_due) {
+    nvm_cache_flush();
+  }
+}
+
+bool nvm_cache_is_dirty(void)
+{
+  for (int i = 0; i < NVM_CACHE_ENTRIES; i++) {
+    if (entries[i].in_use && entries[i].dirty) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void nvm_cache_get_stats(nvm_cache_stats_t *out)
+{
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  *out = stats;
+  CORE_EXIT_ATOMIC();
+}
+
+// --- Internal Helper Functions ---
+
+static nvm_cache_entry_t *find_entry(nvm3_ObjectKey_t key)
+{
+  for (int i = 0; i < NVM_CACHE_ENTRIES; i++) {
+    if (entries[i].in_use && entries[i].key == key) {
+      return &entries[i];
+    }
+  }
+  return NULL;
+}
+
+static nvm_cache_entry_t *load_entry(nvm3_ObjectKey_t key, size_t len)
+{
+  if (len > NVM_CACHE_MAX_OBJECT_SIZE) {
+    return NULL;
+  }
+  for (int i = 0; i < NVM_CACHE_ENTRIES; i++) {
+    nvm_cache_entry_t *entry = &entries[i];
+    if (entry->in_use) {
+      continue;
+    }
+    memset(entry, 0, sizeof(*entry));
+    entry->key = key;
+    entry->len = len;
+    Ecode_t err;
+    PROFILE_CALL(PROFILE_ZONE_NVM3_READ, err = nvm3_readData(nvm3_defaultHandle, key, entry->flash_copy, len));
+    if (err == ECODE_NVM3_OK) {
+      memcpy(entry->data, entry->flash_copy, len);
+      entry->in_flash = true;
+    }
+    entry->in_use = true;
+    return entry;
+  }
+  return NULL;
+}
+
+static void flush_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  flush_due = true;
+  app_events_post(APP_EVENT_STORAGE);
+}
@@ -0,0 +1,37 @@
+#ifndef NVM_CACHE_H
+#define NVM_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nvm3.h"
+
+// Write-behind cache for small, frequently rewritten NVM3 objects (high scores,
+// save counter). Writes land in RAM and reach flash at the next flush point:
+// entering the main menu, or NVM_CACHE_FLUSH_DELAY_MS after the first dirty
+// write. There is no flush before sleep: the app only sleeps in EM2, which
+// keeps RAM and the sleeptimer running, so dirty entries survive it and the
+// flush timer still wakes the core. Flushing on every sleep would write after
+// every input and leave nothing to coalesce.
+#define NVM_CACHE_ENTRIES          4
+#define NVM_CACHE_MAX_OBJECT_SIZE  32
+#define NVM_CACHE_FLUSH_DELAY_MS   5000
+
+typedef struct {
+  uint32_t writes_requested;  // nvm_cache_write() calls
+  uint32_t writes_issued;     // nvm3_writeData() calls made by flushes
+  uint32_t writes_coalesced;  // requests absorbed by a later write before flushing
+  uint32_t writes_suppressed; // requests or flushes skipped because flash already held the data
+  uint32_t write_errors;
+} nvm_cache_stats_t;
+
+void nvm_cache_init(void);
+Ecode_t nvm_cache_read(nvm3_ObjectKey_t key, void *data, size_t len);
+Ecode_t nvm_cache_write(nvm3_ObjectKey_t key, const void *data, size_t len);
+void nvm_cache_flush(void);
+void nvm_cache_process_action(void);
+bool nvm_cache_is_dirty(void);
+void nvm_cache_get_stats(nvm_cache_stats_t *stats);
+
+#endif // NVM_CACHE_H
@@ -0,0 +1,161 @@
+#include "profiler.h"
+
+#if PROFILER_ENABLE
+
+#include "app_events.h"
+#include "em_device.h"
+#include "sl_debug_swo.h"
+#include "sl_sleeptimer.h"
+#include "memory_monitor.h"
+#include <stdio.h>
+#include <string.h>
+#if !defined(DWT)
+#include <time.h>
+#endif
+
+#define SWO_CHANNEL   0   // ITM stimulus port 0, the one SWO viewers print
+#define LINE_LENGTH   128
+
+#if defined(DWT)
+#define UNIT_NAME     "cyc"
+#else
+#define UNIT_NAME     "ns"
+#endif
+
+static const char *const zone_names[PROFILE_ZONE_COUNT] = {
+  [PROFILE_ZONE_COLLISION]      = "collision",
+  [PROFILE_ZONE_CLEAR_LINES]    = "clear_lines",
+  [PROFILE_ZONE_DRAW_BOARD]     = "draw_board",
+  [PROFILE_ZONE_DISPLAY_UPDATE] = "dmd_update",
+  [PROFILE_ZONE_MENU_DRAW]      = "menu_draw",
+  [PROFILE_ZONE_NVM3_READ]      = "nvm3_read",
+  [PROFILE_ZONE_NVM3_WRITE]     = "nvm3_write",
+  [PROFILE_ZONE_NVM3_REPACK]    = "nvm3_repack",
+};
+
+static profile_zone_stats_t zones[PROFILE_ZONE_COUNT];
+static uint32_t interval_start_tick;
+static sl_sleeptimer_timer_handle_t report_timer;
+
+// --- Local function prototypes ---
+static void reset_zones(void);
+static int histogram_bucket(uint32_t duration);
+static void swo_write_line(const char *line);
+static void report_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
+
+// --- Public functions ---
+
+void profiler_init(void)
+{
+  memory_monitor_account("profiler", sizeof(zones));
+#if defined(DWT)
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+  reset_zones();
+  sl_sleeptimer_start_periodic_timer_ms(&report_timer, PROFILER_REPORT_MS,
+                                        report_timer_callback, NULL, 0, 0);
+}
+
+uint32_t profiler_now(void)
+{
+#if defined(DWT)
+  return DWT->CYCCNT;
+#else
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint32_t)((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+#endif
+}
+
+// Unsigned subtraction keeps durations right across a counter wrap
+void profiler_record(profile_zone_t zone, uint32_t start)
+{
+  uint32_t duration = profiler_now() - start;
+  profile_zone_stats_t *stats = &zones[zone];
+
+  stats->count++;
+  stats->total += duration;
+  if (duration < stats->min) {
+    stats->min = duration;
+  }
+  if (duration > stats->max) {
+    stats->max = duration;
+  }
+  stats->histogram[histogram_bucket(duration)]++;
+}
+
+// Writes one line per zone that ran during the interval, then starts a new interval
+void profiler_report(void)
+{
+  char line[LINE_LENGTH];
+  uint32_t interval_ms = sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - interval_start_tick);
+
+  snprintf(line, sizeof(line), "prof interval=%lums unit=" UNIT_NAME "\n", (unsigned long)interval_ms);
+  swo_write_line(line);
+
+  for (int i = 0; i < PROFILE_ZONE_COUNT; i++) {
+    const profile_zone_stats_t *stats = &zones[i];
+    if (stats->count == 0) {
+      continue;
+    }
+    int len = snprintf(line, sizeof(line), "prof %s n=%lu avg=%lu min=%lu max=%lu hist=",
+                       zone_names[i],
+                       (unsigned long)stats->count,
+                       (unsigned long)(stats->total / stats->count),
+                       (unsigned long)stats->min,
+                       (unsigned long)stats->max);
+    for (int b = 0; b < PROFILER_HISTOGRAM_BUCKETS && len > 0 && len < (int)sizeof(line); b++) {
+      len += snprintf(line + len, sizeof(line) - len, b == 0 ? "%lu" : ",%lu",
+                      (unsigned long)stats->histogram[b]);
+    }
+    if (len > 0 && len < (int)sizeof(line) - 1) {
+      line[len] = '\n';
+      line[len + 1] = '\0';
+    }
+    swo_write_line(line);
+  }
+
+  reset_zones();
+}
+
+void profiler_get_zone(profile_zone_t zone, profile_zone_stats_t *out)
+{
+  *out = zones[zone];
+}
+
+// --- Internal Helper Functions ---
+
+static void reset_zones(void)
+{
+  memset(zones, 0, sizeof(zones));
+  for (int i = 0; i < PROFILE_ZONE_COUNT; i++) {
+    zones[i].min = UINT32_MAX;
+  }
+  interval_start_tick = sl_sleeptimer_get_tick_count();
+}
+
+// Powers of four from 256: < 2^8, < 2^10, ... < 2^20, then everything longer
+static int histogram_bucket(uint32_t duration)
+{
+  int bits = duration == 0 ? 0 : 32 - __builtin_clz(duration);
+  int bucket = bits <= 8 ? 0 : (bits - 7) / 2;
+  return bucket < PROFILER_HISTOGRAM_BUCKETS ? bucket : PROFILER_HISTOGRAM_BUCKETS - 1;
+}
+
+static void swo_write_line(const char *line)
+{
+  while (*line) {
+    sl_debug_swo_write_u8(SWO_CHANNEL, (uint8_t)*line++);
+  }
+}
+
+static void report_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+{
+  (void)handle;
+  (void)data;
+  app_events_post(APP_EVENT_DIAGNOSTICS);
+}
+
+#endif // PROFILER_ENABLE
@@ -0,0 +1,71 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+
+// Hot-path profiling zones. On target a zone is timed with the DWT cycle
+// counter, on the host with clock_gettime (nanoseconds). Each zone keeps a
+// count, total, min, max and a coarse histogram; the summary is written to
+// SWO (ITM stimulus port 0, stdout on the host) every PROFILER_REPORT_MS and
+// then cleared, so each report covers one interval.
+//
+// Zones are only entered from the main loop, never from interrupts. Debug
+// builds (DEBUG_EFM without NDEBUG) enable the profiler by default; anything
+// else compiles every PROFILE_* macro and profiler call to nothing.
+#ifndef PROFILER_ENABLE
+#if defined(DEBUG_EFM) && !defined(NDEBUG)
+#define PROFILER_ENABLE 1
+#else
+#define PROFILER_ENABLE 0
+#endif
+#endif
+
+#define PROFILER_REPORT_MS          5000
+#define PROFILER_HISTOGRAM_BUCKETS  8   // bucket n holds durations below 2^(8 + 2n), the last one the rest
+
+typedef enum {
+  PROFILE_ZONE_COLLISION,
+  PROFILE_ZONE_CLEAR_LINES,
+  PROFILE_ZONE_DRAW_BOARD,
+  PROFILE_ZONE_DISPLAY_UPDATE,
+  PROFILE_ZONE_MENU_DRAW,
+  PROFILE_ZONE_NVM3_READ,
+  PROFILE_ZONE_NVM3_WRITE,
+  PROFILE_ZONE_NVM3_REPACK,
+  PROFILE_ZONE_COUNT
+} profile_zone_t;
+
+typedef struct {
+  uint32_t count;
+  uint64_t total;
+  uint32_t min;
+  uint32_t max;
+  uint32_t histogram[PROFILER_HISTOGRAM_BUCKETS];
+} profile_zone_stats_t;
+
+#if PROFILER_ENABLE
+
+uint32_t profiler_now(void);
+void profiler_record(profile_zone_t zone, uint32_t start);
+void profiler_init(void);
+void profiler_report(void);
+void profiler_get_zone(profile_zone_t zone, profile_zone_stats_t *out);
+
+// BEGIN/END bracket a block within one function; every exit between them needs its END
+#define PROFILE_BEGIN(zone)       uint32_t profile_start_##zone = profiler_now()
+#define PROFILE_END(zone)         profiler_record((zone), profile_start_##zone)
+#define PROFILE_CALL(zone, call)  do { uint32_t profile_start = profiler_now(); call; \
+                                       profiler_record((zone), profile_start); } while (0)
+
+#else
+
+#define PROFILE_BEGIN(zone)       ((void)0)
+#define PROFILE_END(zone)         ((void)0)
+#define PROFILE_CALL(zone, call)  do { call; } while (0)
+
+static inline void profiler_init(void) {}
+static inline void profiler_report(void) {}
+
+#endif // PROFILER_ENABLE
+
+#endif // PROFILER_H
@@ -0,0 +1,478 @@
+#include "recorder.h"
+#include "memory_monitor.h"
+#include "tetris.h"
+#include "gravity.h"
+#include "nvm3_default.h"
+#include "storage_telemetry.h"
+#include "app_events.h"
+#include <string.h>
+
+#define CODE_BITS       3
+#define CODE_MASK       ((1u << CODE_BITS) - 1u)
+#define CODE_GRAVITY    5
+#define CODE_RUN        6
+#define CODE_EXTENDED   7
+#define MAX_EVENT_BYTES 8   // a 5-byte varint, the extended type and up to 2 payload bytes
+
+// Extended event types
+#define EXT_SHIFT   0
+#define EXT_PAUSE   1
+#define EXT_RESUME  2
+#define EXT_HASH    3
+#define EXT_END     4
+#define EXT_REWIND  5
+
+// Room always kept free for the last gravity run, the final hash and the end marker
+#define TAIL_BYTES  (5 + 10 + 2)
+
+typedef enum {
+  STATE_IDLE,
+  STATE_RECORDING,
+  STATE_FLUSHING,    // chunks going to flash, one per storage pass
+} recorder_state_t;
+
+static uint8_t builtin_buffer[RECORDER_BUFFER_BYTES];
+static uint8_t *buffer = builtin_buffer;
+static size_t buffer_bytes = RECORDER_BUFFER_BYTES;
+static recorder_header_t header;
+static size_t length;
+static recorder_state_t state = STATE_IDLE;
+static uint32_t start_tick;
+static uint32_t last_tick;
+static uint32_t pending_run;     // on-time gravity steps not yet written
+static bool hash_due;
+static int flush_step;           // 0 drops the old header, then chunks, then the new header
+static uint32_t next_sequence;
+static recorder_config_t config;
+static recorder_stats_t stats;
+
+// --- Local function prototypes ---
+static void emit_event(uint32_t code, uint32_t value, const uint8_t *payload, size_t payload_length, bool tail);
+static void before_event(bool extends_run);
+static void flush_run(bool tail);
+static void emit_hash(bool tail);
+static void finish(void);
+static void flush_next_chunk(void);
+static int chunk_count(void);
+static nvm3_ObjectKey_t header_key(uint32_t sequence);
+static bool read_header(int slot, recorder_header_t *out);
+static bool read_varint(recorder_reader_t *reader, uint32_t *value);
+
+// --- Public functions ---
+
+void recorder_init(void)
+{
+  memory_monitor_account("recorder", sizeof(builtin_buffer) + sizeof(header) + sizeof(stats));
+  memset(&stats, 0, sizeof(stats));
+  state = STATE_IDLE;
+  next_sequence = 0;
+  for (int slot = 0; slot < RECORDER_GAMES; slot++) {
+    recorder_header_t stored;
+    if (read_header(slot, &stored) && stored.sequence + 1 > next_sequence) {
+      next_sequence = stored.sequence + 1;
+    }
+  }
+}
+
+void recorder_configure(const recorder_config_t *new_config)
+{
+  config = *new_config;
+  if (config.disabled && state == STATE_RECORDING) {
+    state = STATE_IDLE;
+  }
+}
+
+void recorder_process_action(void)
+{
+  if (state == STATE_FLUSHING) {
+    flush_next_chunk();
+    if (state == STATE_FLUSHING) {
+      app_events_post(APP_EVENT_STORAGE);
+    }
+  }
+}
+
+void recorder_get_stats(recorder_stats_t *out)
+{
+  *out = stats;
+}
+
+void recorder_on_game_start(uint32_t seed, int level)
+{
+  // The previous game is still going to flash: finish that first
+  while (state == STATE_FLUSHING) {
+    flush_next_chunk();
+  }
+  if (config.disabled) {
+    state = STATE_IDLE;
+    return;
+  }
+  // Only a sink can take more than the NVM3 ring holds
+  bool own_buffer = config.write != NULL && config.buffer != NULL && config.buffer_bytes > TAIL_BYTES;
+  buffer = own_buffer ? config.buffer : builtin_buffer;
+  buffer_bytes = own_buffer ? config.buffer_bytes : RECORDER_BUFFER_BYTES;
+  memset(&header, 0, sizeof(header));
+  header.magic = RECORDER_MAGIC;
+  header.version = RECORDER_VERSION;
+  header.seed = seed;
+  header.level = (uint16_t)level;
+  header.flags = tetris_is_practice() ? RECORDER_FLAG_PRACTICE : 0;
+  length = 0;
+  pending_run = 0;
+  hash_due = false;
+  start_tick = gravity_now();
+  last_tick = start_tick;
+  state = STATE_RECORDING;
+}
+
+void recorder_on_untracked_game(void)
+{
+  if (state == STATE_RECORDING) {
+    state = STATE_IDLE;
+  }
+}
+
+void recorder_on_shift(int dx, int max_cells)
+{
+  if (state != STATE_RECORDING) {
+    return;
+  }
+  before_event(false);
+  uint32_t now = gravity_now();
+  uint32_t delta = (now - last_tick) / GRAVITY_TICK_STEP;
+  last_tick = now;
+  if (max_cells == 1) {
+    emit_event(dx < 0 ? RECORDER_EVENT_LEFT : RECORDER_EVENT_RIGHT, delta, NULL, 0, false);
+  } else {
+    const uint8_t payload[] = { EXT_SHIFT, (uint8_t)((max_cells << 1) | (dx < 0)) };
+    emit_event(CODE_EXTENDED, delta, payload, sizeof(payload), false);
+  }
+}
+
+void recorder_on_input(recorder_event_type_t type)
+{
+  if (state != STATE_RECORDING) {
+    return;
+  }
+  before_event(false);
+  uint32_t now = gravity_now();
+  uint32_t delta = (now - last_tick) / GRAVITY_TICK_STEP;
+  last_tick = now;
+  if (type == RECORDER_EVENT_PAUSE || type == RECORDER_EVENT_RESUME || type == RECORDER_EVENT_REWIND) {
+    const uint8_t payload[] = { type == RECORDER_EVENT_PAUSE ? EXT_PAUSE
+                                : type == RECORDER_EVENT_RESUME ? EXT_RESUME : EXT_REWIND };
+    emit_event(CODE_EXTENDED, delta, payload, sizeof(payload), false);
+  } else {
+    emit_event((uint32_t)type, delta, NULL, 0, false);
+  }
+}
+
+// Called before tetris_update() touches anything, while the gravity deadline
+// that woke it is still the scheduled one
+void recorder_on_gravity(void)
+{
+  if (state != STATE_RECORDING) {
+    return;
+  }
+  uint32_t now = gravity_now();
+  int32_t lag = (int32_t)(now - gravity_get_due_tick()) / GRAVITY_TICK_STEP;
+  before_event(lag == 0);
+  last_tick = now;
+  if (lag == 0) {
+    pending_run++;
+  } else {
+    uint32_t zigzag = ((uint32_t)lag << 1) ^ (uint32_t)(lag >> 31);
+    emit_event(CODE_GRAVITY, zigzag, NULL, 0, false);
+  }
+}
+
+void recorder_on_lock(void)
+{
+  if (state != STATE_RECORDING) {
+    return;
+  }
+  header.pieces++;
+  if (header.pieces % RECORDER_HASH_INTERVAL == 0) {
+    hash_due = true;
+  }
+}
+
+// Called once the engine is in its game over state, which is the final
+// state a replay has to reach. Only encodes; the flash writes come later.
+void recorder_on_game_over(void)
+{
+  if (state == STATE_RECORDING) {
+    finish();
+    app_events_post(APP_EVENT_STORAGE);
+  }
+}
+
+// Called while the game is still in play, before the state leaves it
+void recorder_on_game_quit(void)
+{
+  recorder_on_game_over();
+}
+
+bool recorder_load(int age, recorder_header_t *out, uint8_t *events)
+{
+  // Newest first: order the ring by sequence number
+  recorder_header_t headers[RECORDER_GAMES];
+  bool present[RECORDER_GAMES];
+  for (int slot = 0; slot < RECORDER_GAMES; slot++) {
+    present[slot] = read_header(slot, &headers[slot]);
+  }
+  int found = -1;
+  for (int rank = 0; rank <= age; rank++) {
+    found = -1;
+    for (int slot = 0; slot < RECORDER_GAMES; slot++) {
+      if (present[slot] && (found < 0 || headers[slot].sequence > headers[found].sequence)) {
+        found = slot;
+      }
+    }
+    if (found < 0) {
+      return false;
+    }
+    if (rank < age) {
+      present[found] = false;
+    }
+  }
+
+  *out = headers[found];
+  nvm3_ObjectKey_t key = header_key(out->sequence);
+  for (size_t offset = 0; offset < out->length; offset += RECORDER_CHUNK_BYTES) {
+    size_t bytes = out->length - offset < RECORDER_CHUNK_BYTES ? out->length - offset : RECORDER_CHUNK_BYTES;
+    key++;
+    if (nvm3_readData(nvm3_defaultHandle, key, events + offset, bytes) != ECODE_NVM3_OK) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool recorder_read_event(recorder_reader_t *reader, recorder_event_t *event)
+{
+  uint32_t word;
+  if (!read_varint(reader, &word)) {
+    return false;
+  }
+  memset(event, 0, sizeof(*event));
+  uint32_t value = word >> CODE_BITS;
+  switch (word & CODE_MASK) {
+    case CODE_GRAVITY:
+      event->type = RECORDER_EVENT_GRAVITY;
+      event->lag = (int32_t)(value >> 1) ^ -(int32_t)(value & 1u);
+      return true;
+    case CODE_RUN:
+      event->type = RECORDER_EVENT_GRAVITY_RUN;
+      event->count = value;
+      return true;
+    case CODE_EXTENDED:
+      break;
+    default:
+      event->type = (recorder_event_type_t)(word & CODE_MASK);
+      event->delta = value;
+      return true;
+  }
+
+  event->delta = value;
+  if (reader->offset >= reader->length) {
+    return false;
+  }
+  switch (reader->data[reader->offset++]) {
+    case EXT_SHIFT:
+      if (reader->offset >= reader->length) {
+        return false;
+      }
+      event->type = RECORDER_EVENT_SHIFT;
+      event->dx = (reader->data[reader->offset] & 1u) ? -1 : 1;
+      event->max_cells = reader->data[reader->offset++] >> 1;
+      return true;
+    case EXT_PAUSE:
+      event->type = RECORDER_EVENT_PAUSE;
+      return true;
+    case EXT_RESUME:
+      event->type = RECORDER_EVENT_RESUME;
+      return true;
+    case EXT_HASH:
+      if (reader->length - reader->offset < 4) {
+        return false;
+      }
+      event->type = RECORDER_EVENT_HASH;
+      memcpy(&event->hash, reader->data + reader->offset, 4);
+      reader->offset += 4;
+      return true;
+    case EXT_END:
+      event->type = RECORDER_EVENT_END;
+      return true;
+    case EXT_REWIND:
+      event->type = RECORDER_EVENT_REWIND;
+      return true;
+    default:
+      return false;
+  }
+}
+
+// --- Internal Helper Functions ---
+
+// Appends a whole event or, once the buffer is full, nothing more at all; only
+// the tail of the recording may use the reserved bytes
+static void emit_event(uint32_t code, uint32_t value, const uint8_t *payload, size_t payload_length, bool tail)
+{
+  if ((header.flags & RECORDER_FLAG_TRUNCATED) && !tail) {
+    return;
+  }
+  uint8_t bytes[MAX_EVENT_BYTES];
+  size_t count = 0;
+  uint32_t word = (value << CODE_BITS) | code;
+  if (value > (UINT32_MAX >> CODE_BITS)) {
+    word = UINT32_MAX; // a delta of over 36 hours: clamp rather than wrap
+  }
+  do {
+    bytes[count++] = (uint8_t)((word & 0x7F) | (word > 0x7F ? 0x80 : 0));
+    word >>= 7;
+  } while (word != 0);
+  memcpy(bytes + count, payload, payload_length);
+  count += payload_length;
+
+  size_t limit = tail ? buffer_bytes : buffer_bytes - TAIL_BYTES;
+  if (length + count > limit) {
+    header.flags |= RECORDER_FLAG_TRUNCATED;
+    return;
+  }
+  memcpy(buffer + length, bytes, count);
+  length += count;
+}
+
+// A lock during the previous event leaves a hash due: it goes in right after
+// that event, i.e. after the gravity run the event may have joined
+static void before_event(bool extends_run)
+{
+  if (hash_due) {
+    flush_run(false);
+    emit_hash(false);
+    hash_due = false;
+  }
+  if (!extends_run) {
+    flush_run(false);
+  }
+}
+
+static void flush_run(bool tail)
+{
+  if (pending_run > 0) {
+    emit_event(CODE_RUN, pending_run, NULL, 0, tail);
+    pending_run = 0;
+  }
+}
+
+static void emit_hash(bool tail)
+{
+  uint32_t hash = tetris_state_hash();
+  uint8_t payload[5] = { EXT_HASH };
+  memcpy(payload + 1, &hash, sizeof(hash));
+  emit_event(CODE_EXTENDED, 0, payload, sizeof(payload), tail);
+}
+
+static void finish(void)
+{
+  flush_run(true);
+  hash_due = false;
+  if (!(header.flags & RECORDER_FLAG_TRUNCATED)) {
+    emit_hash(true); // a cut-short log cannot reach the final state
+  }
+  const uint8_t end[] = { EXT_END };
+  emit_event(CODE_EXTENDED, 0, end, sizeof(end), true);
+
+  header.flags |= RECORDER_FLAG_GAME_OVER;
+  header.length = (uint32_t)length;
+  header.ticks = last_tick - start_tick;
+  header.final_hash = tetris_state_hash();
+  header.sequence = next_sequence++;
+  stats.games_recorded++;
+  stats.bytes_recorded += (uint32_t)length;
+  stats.ticks_recorded += header.ticks;
+  if (header.flags & RECORDER_FLAG_TRUNCATED) {
+    stats.games_truncated++;
+  }
+
+  if (config.write != NULL) {
+    config.write(&header, buffer, config.context);
+    state = STATE_IDLE;
+    return;
+  }
+  flush_step = 0;
+  state = STATE_FLUSHING;
+}
+
+// The header goes last, so a reset part way through leaves no header that
+// points at chunks of another game
+static void flush_next_chunk(void)
+{
+  nvm3_ObjectKey_t key = header_key(header.sequence);
+  int chunks = chunk_count();
+  uint32_t type;
+  size_t object_length;
+
+  if (flush_step == 0) {
+    if (nvm3_getObjectInfo(nvm3_defaultHandle, key, &type, &object_length) == ECODE_NVM3_OK) {
+      storage_delete(key);
+    }
+  } else if (flush_step <= chunks) {
+    size_t offset = (size_t)(flush_step - 1) * RECORDER_CHUNK_BYTES;
+    size_t bytes = length - offset < RECORDER_CHUNK_BYTES ? length - offset : RECORDER_CHUNK_BYTES;
+    if (storage_write(key + flush_step, buffer + offset, bytes) == ECODE_NVM3_OK) {
+      stats.chunk_writes++;
+    } else {
+      stats.write_errors++;
+    }
+  } else {
+    if (storage_write(key, &header, sizeof(header)) != ECODE_NVM3_OK) {
+      stats.write_errors++;
+    }
+    // Chunks a longer recording left in this slot are dead weight now
+    for (int chunk = chunks + 1; chunk <= RECORDER_MAX_CHUNKS; chunk++) {
+      if (nvm3_getObjectInfo(nvm3_defaultHandle, key + chunk, &type, &object_length) == ECODE_NVM3_OK) {
+        storage_delete(key + chunk);
+      }
+    }
+    state = STATE_IDLE;
+    return;
+  }
+  flush_step++;
+}
+
+static int chunk_count(void)
+{
+  return (int)((length + RECORDER_CHUNK_BYTES - 1) / RECORDER_CHUNK_BYTES);
+}
+
+static nvm3_ObjectKey_t header_key(uint32_t sequence)
+{
+  return RECORDER_KEY_BASE + (sequence % RECORDER_GAMES) * RECORDER_KEY_STRIDE;
+}
+
+static bool read_header(int slot, recorder_header_t *out)
+{
+  nvm3_ObjectKey_t key = RECORDER_KEY_BASE + slot * RECORDER_KEY_STRIDE;
+  uint32_t type;
+  size_t object_length;
+  return nvm3_getObjectInfo(nvm3_defaultHandle, key, &type, &object_length) == ECODE_NVM3_OK
+         && object_length == sizeof(*out)
+         && nvm3_readData(nvm3_defaultHandle, key, out, sizeof(*out)) == ECODE_NVM3_OK
+         && out->magic == RECORDER_MAGIC
+         && out->version == RECORDER_VERSION
+         && out->length <= RECORDER_BUFFER_BYTES;
+}
+
+static bool read_varint(recorder_reader_t *reader, uint32_t *value)
+{
+  *value = 0;
+  for (int shift = 0; shift < 35 && reader->offset < reader->length; shift += 7) {
+    uint8_t byte = reader->data[reader->offset++];
+    *value |= (uint32_t)(byte & 0x7F) << shift;
+    if (!(byte & 0x80)) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,129 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Always-on game recorder. A new game is logged from its seed and starting
+// level as the engine calls that changed it, each stamped with the steps of
+// the game clock (gravity_now()) since the previous one, so replaying the log against a virtual clock reproduces the game
+// exactly. Gravity steps are logged by their lag behind the gravity timer's
+// deadline, so the usual on-time step costs nothing but a run count. Every
+// RECORDER_HASH_INTERVAL locks a tetris_state_hash() goes into the log for
+// the replay to check against.
+//
+// The log lives in a bounded RAM buffer while the game runs; a game that
+// outgrows it keeps playing but its recording is cut short and flagged. At
+// game over, or when the player quits to the menu, the recording is written
+// to NVM3, one chunk per storage pass, into a ring of the last RECORDER_GAMES
+// games. Games loaded from a slot or a checkpoint are not recorded.
+#define RECORDER_KEY_BASE       500
+#define RECORDER_KEY_STRIDE     16   // per game: the header, then up to RECORDER_MAX_CHUNKS chunks
+#define RECORDER_GAMES          3
+#define RECORDER_CHUNK_BYTES    240  // below NVM3_DEFAULT_MAX_OBJECT_SIZE
+#define RECORDER_MAX_CHUNKS     (RECORDER_KEY_STRIDE - 1)
+#ifndef RECORDER_BUFFER_BYTES
+#define RECORDER_BUFFER_BYTES   (RECORDER_MAX_CHUNKS * RECORDER_CHUNK_BYTES) // all a game's keys can hold
+#endif
+#define RECORDER_HASH_INTERVAL  10
+#define RECORDER_MAGIC          0x54524543 // "TREC"
+#define RECORDER_VERSION        3
+
+#define RECORDER_FLAG_TRUNCATED (1u << 0)  // the buffer filled up: the log stops before the game did
+#define RECORDER_FLAG_GAME_OVER (1u << 1)
+#define RECORDER_FLAG_PRACTICE  (1u << 2)  // a practice game: rewinds replay from the pieces since its start
+
+// Stored in front of the event bytes, in flash and in host files
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t flags;
+  uint32_t sequence;      // games recorded since the store was created
+  uint32_t seed;
+  uint16_t level;
+  uint16_t reserved;
+  uint32_t length;        // event bytes that follow
+  uint32_t ticks;         // from the start of the game to the last event
+  uint32_t pieces;
+  uint32_t final_hash;    // tetris_state_hash() after the last event
+} recorder_header_t;
+
+// Event stream: each event starts with a LEB128 varint (value << 3 | code).
+// Codes 0-4 are the inputs below with value = steps since the previous event;
+// 5 is a gravity step with value = its lag behind the deadline in steps,
+// zigzag encoded; 6 is value on-time gravity steps; 7 is an extended event
+// with value = steps since the previous event, then a type byte and its
+// payload. A step is GRAVITY_TICK_STEP sleeptimer ticks.
+typedef enum {
+  RECORDER_EVENT_LEFT,
+  RECORDER_EVENT_RIGHT,
+  RECORDER_EVENT_ROTATE,
+  RECORDER_EVENT_SOFT_DROP,
+  RECORDER_EVENT_HARD_DROP,
+  RECORDER_EVENT_GRAVITY,       // tetris_update(), lag steps after the gravity deadline
+  RECORDER_EVENT_GRAVITY_RUN,   // count gravity steps, each right at its deadline
+  RECORDER_EVENT_SHIFT,         // tetris_shift(dx, max_cells) other than a single step
+  RECORDER_EVENT_PAUSE,
+  RECORDER_EVENT_RESUME,
+  RECORDER_EVENT_HASH,
+  RECORDER_EVENT_END,
+  RECORDER_EVENT_REWIND,       // tetris_rewind() in a practice game
+} recorder_event_type_t;
+
+typedef struct {
+  recorder_event_type_t type;
+  uint32_t delta;         // steps since the previous event; inputs, shift, pause, resume and rewind
+  int32_t lag;            // gravity
+  uint32_t count;         // gravity run
+  int8_t dx;              // shift
+  uint8_t max_cells;      // shift
+  uint32_t hash;          // hash
+} recorder_event_t;
+
+typedef struct {
+  const uint8_t *data;
+  size_t length;
+  size_t offset;
+} recorder_reader_t;
+
+typedef void (*recorder_write_fn)(const recorder_header_t *header, const uint8_t *events, void *context);
+
+typedef struct {
+  bool disabled;              // record nothing, e.g. while a replay drives the engine
+  recorder_write_fn write;    // NULL = the NVM3 ring
+  void *context;
+  uint8_t *buffer;            // with a write sink: log into this instead, from the next game on
+  size_t buffer_bytes;
+} recorder_config_t;
+
+typedef struct {
+  uint32_t games_recorded;
+  uint32_t games_truncated;
+  uint32_t bytes_recorded;    // event bytes of finished recordings
+  uint64_t ticks_recorded;
+  uint32_t chunk_writes;
+  uint32_t write_errors;
+} recorder_stats_t;
+
+void recorder_init(void);
+void recorder_configure(const recorder_config_t *config);
+void recorder_process_action(void);
+void recorder_get_stats(recorder_stats_t *stats);
+
+// Engine hooks (tetris.c)
+void recorder_on_game_start(uint32_t seed, int level);
+void recorder_on_untracked_game(void);
+void recorder_on_shift(int dx, int max_cells);
+void recorder_on_input(recorder_event_type_t type);
+void recorder_on_gravity(void);
+void recorder_on_lock(void);
+void recorder_on_game_over(void);
+void recorder_on_game_quit(void);   // back to the menu before game over
+
+// Recordings in the NVM3 ring, 0 being the most recent; events holds
+// RECORDER_BUFFER_BYTES
+bool recorder_load(int age, recorder_header_t *header, uint8_t *events);
+bool recorder_read_event(recorder_reader_t *reader, recorder_event_t *event);
+
+#endif // RECORDER_H
@@ -0,0 +1,62 @@
+#include "rewind.h"
+#include "memory_monitor.h"
+#include <string.h>
+
+// One more entry than REWIND_DEPTH: the piece in play plus the ones behind it
+#define RING_SIZE (REWIND_DEPTH + 1)
+
+static rewind_snapshot_t ring[RING_SIZE];
+static uint8_t newest;
+static uint8_t count;
+static rewind_stats_t stats;
+
+// --- Public functions ---
+
+void rewind_init(void)
+{
+  memory_monitor_account("rewind", sizeof(ring) + sizeof(stats));
+  memset(&stats, 0, sizeof(stats));
+  rewind_clear();
+}
+
+void rewind_clear(void)
+{
+  newest = RING_SIZE - 1;
+  count = 0;
+}
+
+// Called from the lock path: hands out a slot, the caller fills it in place
+rewind_snapshot_t *rewind_push(void)
+{
+  newest = (uint8_t)((newest + 1) % RING_SIZE);
+  if (count < RING_SIZE) {
+    count++;
+  } else {
+    stats.snapshots_dropped++;
+  }
+  stats.snapshots_taken++;
+  return &ring[newest];
+}
+
+const rewind_snapshot_t *rewind_step_back(bool drop_newest)
+{
+  if (count < (drop_newest ? 2 : 1)) {
+    return NULL;
+  }
+  if (drop_newest) {
+    newest = (uint8_t)((newest + RING_SIZE - 1) % RING_SIZE);
+    count--;
+  }
+  stats.rewinds++;
+  return &ring[newest];
+}
+
+int rewind_depth(void)
+{
+  return count > 0 ? count - 1 : 0;
+}
+
+void rewind_get_stats(rewind_stats_t *out)
+{
+  *out = stats;
+}
@@ -0,0 +1,42 @@
+#ifndef REWIND_H
+#define REWIND_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "tetris.h"
+
+// Practice-mode rewind: a RAM ring of the game state at the last piece-lock
+// boundaries. The newest entry is the piece now in play; each one below it is
+// a piece further back, so a game can step back REWIND_DEPTH pieces. Boards
+// are kept as one row mask per line, as the display draws every filled cell
+// alike, which keeps a full ring under 2 KB.
+#define REWIND_DEPTH 32
+
+typedef struct {
+  int32_t score;
+  uint32_t rng_state;
+  uint16_t rows[BOARD_HEIGHT];  // bit x set for every filled cell of line y
+  uint16_t lines_cleared;
+  uint8_t level;
+  uint8_t current_piece;        // tetromino color, 1..7
+  uint8_t next_piece;
+  uint8_t flags;                // TETRIS_SNAPSHOT_ROTATED
+} rewind_snapshot_t;
+
+typedef struct {
+  uint32_t snapshots_taken;
+  uint32_t rewinds;
+  uint32_t snapshots_dropped;   // pushed out of the ring by newer pieces
+} rewind_stats_t;
+
+void rewind_init(void);
+void rewind_clear(void);
+// The entry to fill for the piece just spawned; the oldest drops out when full
+rewind_snapshot_t *rewind_push(void);
+// With drop_newest, discards the piece in play and returns the one before it;
+// otherwise returns the newest. NULL when there is nothing to go back to.
+const rewind_snapshot_t *rewind_step_back(bool drop_newest);
+int rewind_depth(void);         // pieces that can still be taken back
+void rewind_get_stats(rewind_stats_t *stats);
+
+#endif // REWIND_H
@@ -0,0 +1,51 @@
+#ifndef SAVE_FORMAT_H
+#define SAVE_FORMAT_H
+
+// NVM3 key map and on-flash records of the save system. Shared with the host
+// tools that decode flash images.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "tetris.h"
+
+#define NUM_SLOTS 5
+#define SLOT_META_KEY_BASE 10
+#define SLOT_DATA_KEY_BASE 100
+#define SLOT_DATA_KEY_STRIDE 10
+#define SLOT_DATA_KEYS 7 // the header, then the board in 6 chunks
+#define SAVE_COUNTER_KEY 200
+#define HIGH_SCORES_KEY 300
+
+#define BOARD_CHUNK_SIZE (BOARD_WIDTH * BOARD_HEIGHT / 6)
+
+#define SLOT_SILHOUETTE_SIZE (BOARD_WIDTH / 2)
+
+// Compact slot index entry. The silhouette holds one nibble per column with the
+// stack height in half rows, so the slot menu can preview a save without reading it.
+// Words first, so the entry is 16 bytes with no padding in the middle.
+typedef struct {
+    uint32_t timestamp;
+    int32_t score;
+    uint8_t silhouette[SLOT_SILHOUETTE_SIZE];
+    bool is_occupied;
+} game_slot_t;
+
+// Slot index entry as written by earlier firmware
+typedef struct {
+    bool is_occupied;
+    uint32_t timestamp;
+    char name[20];
+} legacy_game_slot_t;
+
+// Save data header; the board follows in 6 chunks at the next keys
+typedef struct {
+    Tetromino current_tetromino;
+    Tetromino next_tetromino;
+    Point current_position;
+    int lines_cleared;
+    int level;
+    int score;
+} saved_game_meta_t;
+
+#endif // SAVE_FORMAT_H
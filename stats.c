@@ -0,0 +1,118 @@
+#include "stats.h"
+#include "em_core.h"
+#include "nvm3_default.h"
+#include "storage_telemetry.h"
+#include "sl_sleeptimer.h"
+#include <string.h>
+
+static uint32_t persisted[STATS_COUNT]; // last value written to the NVM3 counter
+static uint32_t pending[STATS_COUNT];   // accumulated since the last flush
+static uint32_t play_start_tick = 0;
+static uint32_t play_ticks = 0;         // play time not yet converted to seconds
+static bool playing = false;
+static volatile bool flush_requested = false;
+
+// --- Local function prototypes ---
+static void stop_play_clock(void);
+
+// --- Public functions ---
+
+void stats_init(void)
+{
+  memset(pending, 0, sizeof(pending));
+  for (int i = 0; i < STATS_COUNT; i++) {
+    if (nvm3_readCounter(nvm3_defaultHandle, STATS_KEY_BASE + i, &persisted[i]) != ECODE_NVM3_OK) {
+      persisted[i] = 0;
+    }
+  }
+  play_ticks = 0;
+  playing = false;
+  flush_requested = false;
+}
+
+void stats_on_game_start(void)
+{
+  pending[STATS_GAMES_PLAYED]++;
+  stats_on_play_start();
+}
+
+void stats_on_play_start(void)
+{
+  play_start_tick = sl_sleeptimer_get_tick_count();
+  playing = true;
+}
+
+// Pause and game over: good moments for a batched flash update.
+void stats_on_play_stop(void)
+{
+  stop_play_clock();
+  flush_requested = true;
+}
+
+// Lock path: a couple of increments, no flash access.
+void stats_on_lock(int lines, bool is_t_spin)
+{
+  pending[STATS_PIECES_PLACED]++;
+  pending[STATS_LINES_CLEARED] += (uint32_t)lines;
+  if (is_t_spin) {
+    pending[STATS_T_SPINS]++;
+  }
+}
+
+void stats_process_action(void)
+{
+  if (!flush_requested) {
+    return;
+  }
+  flush_requested = false;
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  uint32_t seconds = sl_sleeptimer_tick_to_ms(play_ticks) / 1000;
+  play_ticks -= sl_sleeptimer_ms_to_tick(1000) * seconds;
+  pending[STATS_PLAY_SECONDS] += seconds;
+  CORE_EXIT_ATOMIC();
+
+  for (int i = 0; i < STATS_COUNT; i++) {
+    CORE_ENTER_ATOMIC();
+    uint32_t delta = pending[i];
+    pending[i] = 0;
+    CORE_EXIT_ATOMIC();
+    if (delta == 0) {
+      continue;
+    }
+    if (storage_write_counter(STATS_KEY_BASE + i, persisted[i] + delta) == ECODE_NVM3_OK) {
+      persisted[i] += delta;
+    } else {
+      CORE_ENTER_ATOMIC();
+      pending[i] += delta; // retry at the next flush
+      CORE_EXIT_ATOMIC();
+    }
+  }
+}
+
+uint32_t stats_get(stats_counter_t counter)
+{
+  if (counter >= STATS_COUNT) {
+    return 0;
+  }
+  uint32_t value = persisted[counter] + pending[counter];
+  if (counter == STATS_PLAY_SECONDS) {
+    uint32_t ticks = play_ticks;
+    if (playing) {
+      ticks += sl_sleeptimer_get_tick_count() - play_start_tick;
+    }
+    value += sl_sleeptimer_tick_to_ms(ticks) / 1000;
+  }
+  return value;
+}
+
+// --- Internal Helper Functions ---
+
+static void stop_play_clock(void)
+{
+  if (playing) {
+    play_ticks += sl_sleeptimer_get_tick_count() - play_start_tick;
+    playing = false;
+  }
+}
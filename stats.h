@@ -0,0 +1,28 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Lifetime statistics. Play updates RAM accumulators only; totals reach the
+// NVM3 counter objects in one batch at game over or pause.
+#define STATS_KEY_BASE 400
+
+typedef enum {
+  STATS_PIECES_PLACED,
+  STATS_LINES_CLEARED,
+  STATS_T_SPINS,
+  STATS_PLAY_SECONDS,
+  STATS_GAMES_PLAYED,
+  STATS_COUNT
+} stats_counter_t;
+
+void stats_init(void);
+void stats_on_game_start(void);
+void stats_on_play_start(void);
+void stats_on_play_stop(void);
+void stats_on_lock(int lines, bool is_t_spin);
+void stats_process_action(void);
+uint32_t stats_get(stats_counter_t counter);
+
+#endif // STATS_H
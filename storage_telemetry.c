@@ -0,0 +1,207 @@
+#include "storage_telemetry.h"
+#include "nvm3_default.h"
+#include "nvm3_default_config.h"
+#include "em_device.h"
+#include "sl_sleeptimer.h"
+#include "profiler.h"
+#include "trace.h"
+#include "memory_monitor.h"
+#include "save_format.h"
+#include "stats.h"
+#include "autosave.h"
+#include "auto_repeat.h"
+#include "recorder.h"
+#include <string.h>
+
+// NVM3 does not report free space, so it is modelled as a log: every write
+// appends the object plus a header, a repack compacts back to the live set.
+#define OBJECT_HEADER_BYTES 8
+#define PAGE_HEADER_BYTES   20
+#define COUNTER_BYTES       4
+#define ENUM_WINDOW_KEYS    64 // keys per nvm3_enumObjects() call: a window never holds more objects
+
+// Every key the app writes, from the key maps of the modules that own them
+#define APP_KEY_COUNT       (NUM_SLOTS * (1 + SLOT_DATA_KEYS)                       \
+                             + 4 /* save counter, high scores, handling, autosave */ \
+                             + STATS_COUNT + RECORDER_GAMES * RECORDER_KEY_STRIDE)
+
+static storage_telemetry_t telemetry;
+static storage_key_stats_t key_stats[APP_KEY_COUNT];
+static int key_count = 0;
+static uint32_t usable_bytes;
+static uint32_t used_bytes_estimate;
+static uint32_t next_page_to_erase = 0;
+
+// --- Local function prototypes ---
+static uint32_t live_bytes(void);
+static void account_write(nvm3_ObjectKey_t key, size_t len, Ecode_t err);
+static void update_free_estimate(void);
+
+// --- Public functions ---
+
+void storage_telemetry_init(void)
+{
+  memory_monitor_account("storage", sizeof(telemetry) + sizeof(key_stats));
+  memset(&telemetry, 0, sizeof(telemetry));
+  memset(key_stats, 0, sizeof(key_stats));
+  key_count = 0;
+  next_page_to_erase = 0;
+
+  telemetry.nvm_size = NVM3_DEFAULT_NVM_SIZE;
+  telemetry.page_count = NVM3_DEFAULT_NVM_SIZE / FLASH_PAGE_SIZE;
+  if (telemetry.page_count > STORAGE_TELEMETRY_MAX_PAGES) {
+    telemetry.page_count = STORAGE_TELEMETRY_MAX_PAGES;
+  }
+  // One page is always kept free for repacking
+  usable_bytes = (telemetry.page_count - 1) * (FLASH_PAGE_SIZE - PAGE_HEADER_BYTES);
+
+  if (nvm3_getEraseCount(nvm3_defaultHandle, &telemetry.erase_count) != ECODE_NVM3_OK) {
+    telemetry.erase_count = 0;
+  }
+  for (uint32_t i = 0; i < telemetry.page_count; i++) {
+    telemetry.page_erase_estimate[i] = telemetry.erase_count;
+  }
+
+  used_bytes_estimate = live_bytes();
+  update_free_estimate();
+  telemetry.min_free_bytes_estimate = telemetry.free_bytes_estimate;
+}
+
+Ecode_t storage_write(nvm3_ObjectKey_t key, const void *data, size_t len)
+{
+  Ecode_t err;
+  trace_event(TRACE_NVM3_WRITE_BEGIN, 0, (uint16_t)key);
+  PROFILE_CALL(PROFILE_ZONE_NVM3_WRITE, err = nvm3_writeData(nvm3_defaultHandle, key, data, len));
+  trace_event(TRACE_NVM3_WRITE_END, err != ECODE_NVM3_OK, (uint16_t)key);
+  account_write(key, len, err);
+  return err;
+}
+
+Ecode_t storage_write_counter(nvm3_ObjectKey_t key, uint32_t value)
+{
+  Ecode_t err;
+  trace_event(TRACE_NVM3_WRITE_BEGIN, 0, (uint16_t)key);
+  PROFILE_CALL(PROFILE_ZONE_NVM3_WRITE, err = nvm3_writeCounter(nvm3_defaultHandle, key, value));
+  trace_event(TRACE_NVM3_WRITE_END, err != ECODE_NVM3_OK, (uint16_t)key);
+  account_write(key, COUNTER_BYTES, err);
+  return err;
+}
+
+Ecode_t storage_delete(nvm3_ObjectKey_t key)
+{
+  Ecode_t err;
+  trace_event(TRACE_NVM3_WRITE_BEGIN, 0, (uint16_t)key);
+  PROFILE_CALL(PROFILE_ZONE_NVM3_WRITE, err = nvm3_deleteObject(nvm3_defaultHandle, key));
+  trace_event(TRACE_NVM3_WRITE_END, err != ECODE_NVM3_OK, (uint16_t)key);
+  if (err == ECODE_NVM3_OK) {
+    // A delete is a header-only record in the log
+    telemetry.deletes++;
+    used_bytes_estimate += OBJECT_HEADER_BYTES;
+    update_free_estimate();
+  }
+  return err;
+}
+
+void storage_repack_if_needed(void)
+{
+  while (nvm3_repackNeeded(nvm3_defaultHandle)) {
+    uint32_t start = sl_sleeptimer_get_tick_count();
+    trace_event(TRACE_NVM3_REPACK_BEGIN, 0, 0);
+    PROFILE_CALL(PROFILE_ZONE_NVM3_REPACK, nvm3_repack(nvm3_defaultHandle));
+    trace_event(TRACE_NVM3_REPACK_END, 0, 0);
+    uint32_t duration_ms = sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count() - start);
+
+    telemetry.repacks++;
+    telemetry.last_repack_ms = duration_ms;
+    telemetry.total_repack_ms += duration_ms;
+    if (duration_ms > telemetry.max_repack_ms) {
+      telemetry.max_repack_ms = duration_ms;
+    }
+
+    // Each repack step erases the oldest page; NVM3 walks its pages in order
+    if (telemetry.page_count > 0) {
+      telemetry.page_erase_estimate[next_page_to_erase]++;
+      next_page_to_erase = (next_page_to_erase + 1) % telemetry.page_count;
+    }
+    used_bytes_estimate = live_bytes();
+    update_free_estimate();
+  }
+}
+
+void storage_telemetry_get(storage_telemetry_t *out)
+{
+  *out = telemetry;
+}
+
+int storage_telemetry_get_key_count(void)
+{
+  return key_count;
+}
+
+bool storage_telemetry_get_key(int index, storage_key_stats_t *out)
+{
+  if (index < 0 || index >= key_count) {
+    return false;
+  }
+  *out = key_stats[index];
+  return true;
+}
+
+// --- Internal Helper Functions ---
+
+// Walks the key space a window at a time until every live object is found,
+// so the key buffer stays small however many objects the store holds
+static uint32_t live_bytes(void)
+{
+  nvm3_ObjectKey_t keys[ENUM_WINDOW_KEYS];
+  size_t remaining = nvm3_countObjects(nvm3_defaultHandle);
+  uint32_t total = 0;
+  for (uint32_t first = NVM3_KEY_MIN; remaining > 0 && first <= NVM3_KEY_MAX; first += ENUM_WINDOW_KEYS) {
+    size_t count = nvm3_enumObjects(nvm3_defaultHandle, keys, ENUM_WINDOW_KEYS,
+                                    first, first + ENUM_WINDOW_KEYS - 1);
+    remaining -= count < remaining ? count : remaining;
+    for (size_t i = 0; i < count; i++) {
+      uint32_t type;
+      size_t len;
+      if (nvm3_getObjectInfo(nvm3_defaultHandle, keys[i], &type, &len) == ECODE_NVM3_OK) {
+        total += OBJECT_HEADER_BYTES + ((len + 3) & ~3u);
+      }
+    }
+  }
+  return total;
+}
+
+static void account_write(nvm3_ObjectKey_t key, size_t len, Ecode_t err)
+{
+  if (err != ECODE_NVM3_OK) {
+    telemetry.write_errors++;
+    return;
+  }
+  uint32_t bytes = OBJECT_HEADER_BYTES + ((len + 3) & ~3u);
+  telemetry.writes++;
+  telemetry.bytes_written += bytes;
+  used_bytes_estimate += bytes;
+  update_free_estimate();
+
+  for (int i = 0; i < key_count; i++) {
+    if (key_stats[i].key == key) {
+      key_stats[i].writes++;
+      key_stats[i].bytes += bytes;
+      return;
+    }
+  }
+  if (key_count < APP_KEY_COUNT) {
+    key_stats[key_count].key = key;
+    key_stats[key_count].writes = 1;
+    key_stats[key_count].bytes = bytes;
+    key_count++;
+  }
+}
+
+static void update_free_estimate(void)
+{
+  telemetry.free_bytes_estimate = (used_bytes_estimate < usable_bytes) ? usable_bytes - used_bytes_estimate : 0;
+  if (telemetry.free_bytes_estimate < telemetry.min_free_bytes_estimate) {
+    telemetry.min_free_bytes_estimate = telemetry.free_bytes_estimate;
+  }
+}
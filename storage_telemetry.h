@@ -0,0 +1,47 @@
+#ifndef STORAGE_TELEMETRY_H
+#define STORAGE_TELEMETRY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nvm3.h"
+
+// NVM3 health and wear telemetry. All app writes, deletes and repacks go
+// through the storage_* wrappers below so they can be accounted for.
+#define STORAGE_TELEMETRY_MAX_PAGES 8
+
+typedef struct {
+  nvm3_ObjectKey_t key;
+  uint32_t writes;
+  uint32_t bytes;
+} storage_key_stats_t;
+
+typedef struct {
+  uint32_t writes;
+  uint32_t bytes_written;
+  uint32_t deletes;
+  uint32_t write_errors;
+  uint32_t repacks;
+  uint32_t last_repack_ms;
+  uint32_t max_repack_ms;
+  uint32_t total_repack_ms;
+  uint32_t nvm_size;
+  uint32_t free_bytes_estimate;   // after the most recent write or repack
+  uint32_t min_free_bytes_estimate;
+  uint32_t erase_count;           // as reported by NVM3 at boot
+  uint32_t page_count;
+  uint32_t page_erase_estimate[STORAGE_TELEMETRY_MAX_PAGES];
+} storage_telemetry_t;
+
+void storage_telemetry_init(void);
+Ecode_t storage_write(nvm3_ObjectKey_t key, const void *data, size_t len);
+Ecode_t storage_write_counter(nvm3_ObjectKey_t key, uint32_t value);
+Ecode_t storage_delete(nvm3_ObjectKey_t key);
+void storage_repack_if_needed(void);
+
+void storage_telemetry_get(storage_telemetry_t *telemetry);
+int storage_telemetry_get_key_count(void);
+bool storage_telemetry_get_key(int index, storage_key_stats_t *key_stats);
+
+#endif // STORAGE_TELEMETRY_H
@@ -6,6 +6,20 @@
 #include <stdio.h>
 #include "nvm3.h"
 #include "nvm3_default.h"
+#include "nvm_cache.h"
+#include "save_format.h"
+#include "storage_telemetry.h"
+#include "autosave.h"
+#include "stats.h"
+#include "app_events.h"
+#include "gravity.h"
+#include "profiler.h"
+#include "trace.h"
+#include "latency.h"
+#include "diagnostics.h"
+#include "memory_monitor.h"
+#include "recorder.h"
+#include "rewind.h"
 
 // Game State
 static game_state_t current_game_state;
@@ -23,52 +37,68 @@ static int level;
 static int score;
 static bool last_move_was_rotation = false;
 
+// Piece sequence: xorshift32, seeded per game so a seed reproduces a game
+static uint32_t rng_state = TETRIS_DEFAULT_SEED;
+static uint32_t game_seed = TETRIS_DEFAULT_SEED;
+
+// Practice games keep a rewind ring instead of autosave checkpoints and stay
+// off the high score table
+static bool practice = false;
+
 // Timer
-static sl_sleeptimer_timer_handle_t tetris_timer;
 static sl_sleeptimer_timer_handle_t save_msg_timer;
 
 // NVM3 & Slots
-#define NUM_SLOTS 5
-#define SLOT_META_KEY_BASE 10
-#define SLOT_DATA_KEY_BASE 100
-#define SAVE_COUNTER_KEY 200
-#define HIGH_SCORES_KEY 300
-
-#define BOARD_CHUNK_SIZE (BOARD_WIDTH * BOARD_HEIGHT / 6)
-
-typedef struct {
-    bool is_occupied;
-    uint32_t timestamp;
-    char name[20];
-} game_slot_t;
-
 static game_slot_t slots[NUM_SLOTS];
 static uint32_t high_scores[5];
 
 static bool display_save_message = false;
 static bool display_save_failed_message = false;
 
+// Slot prefetch: one-entry decoded cache of the slot highlighted in the slot menu.
+// Set SLOT_PREFETCH_ENABLE to 0 to measure load latency without it.
+#ifndef SLOT_PREFETCH_ENABLE
+#define SLOT_PREFETCH_ENABLE 1
+#endif
+#define SLOT_PREFETCH_DONE 7 // meta object + 6 board chunks
+
 typedef struct {
-    Tetromino current_tetromino;
-    Tetromino next_tetromino;
-    Point current_position;
-    int lines_cleared;
-    int level;
-    int score;
-} saved_game_meta_t;
+    int slot_index;  // -1 when the cache is empty
+    int next_object; // next NVM3 object to read, SLOT_PREFETCH_DONE when decoded
+    bool failed;
+    saved_game_meta_t meta;
+    int board[BOARD_WIDTH][BOARD_HEIGHT];
+} slot_prefetch_t;
+
+static slot_prefetch_t slot_prefetch = { .slot_index = -1 };
+static uint32_t last_load_ticks;
+static bool last_load_was_prefetched;
+static bool last_load_measured;
 
 // --- Local function prototypes ---
-static void tetris_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
 static void save_msg_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
 static void save_failed_msg_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data);
 static int find_next_slot(void);
 static void tetris_save_to_slot(int slot_index);
+static uint32_t next_random(void);
 static Tetromino get_random_tetromino(void);
 static void spawn_new_tetromino(void);
 static bool check_collision(Point pos, Tetromino tet);
+static bool try_rotate(void);
+static int drop_to_floor(void);
 static void merge_tetromino(void);
-static void clear_lines(bool is_t_spin);
-static void tetris_set_game_speed(void);
+static void lock_tetromino(bool is_t_spin);
+static void lock_current_piece(void);
+static void refresh_gravity(void);
+static int clear_lines(bool is_t_spin);
+static void slot_prefetch_invalidate(int slot_index);
+static void slot_prefetch_step(void);
+static void apply_saved_meta(const saved_game_meta_t *saved_meta);
+static void read_slot_index(int slot_index);
+static void build_slot_silhouette(uint8_t silhouette[SLOT_SILHOUETTE_SIZE]);
+static void rewind_take(rewind_snapshot_t *snap);
+static void rewind_restore(const rewind_snapshot_t *snap);
+static void draw_playfield(void);
 
 static const Tetromino tetrominoes[] = {
     // I
@@ -91,32 +121,44 @@ static const Tetromino tetrominoes[] = {
 
 void tetris_init(void)
 {
+  memory_monitor_account("tetris", sizeof(board) + sizeof(slots) + sizeof(high_scores) + sizeof(slot_prefetch));
   GLIB_contextInit(&glibContext);
   glibContext.backgroundColor = White;
   glibContext.foregroundColor = Black;
   GLIB_setFont(&glibContext, (GLIB_Font_t *) &GLIB_FontNarrow6x8);
-  current_game_state = GAME_STATE_MAIN_MENU;
+  tetris_set_game_state(GAME_STATE_MAIN_MENU);
 
   // Init NVM3 and read data
   Ecode_t err = nvm3_initDefault();
   if (err == ECODE_NVM3_OK) {
     // Read slots
     for (int i = 0; i < NUM_SLOTS; i++) {
-      err = nvm3_readData(nvm3_defaultHandle, SLOT_META_KEY_BASE + i, &slots[i], sizeof(game_slot_t));
-      if (err != ECODE_NVM3_OK) {
-        slots[i].is_occupied = false;
+      read_slot_index(i);
+    }
+    // Init save counter if it doesn't exist. A counter update still sitting in the
+    // write-behind cache is lost on reset, so never hand out a timestamp already in use.
+    storage_telemetry_init();
+    nvm_cache_init();
+    autosave_init();
+    stats_init();
+    recorder_init();
+    rewind_init();
+    uint32_t save_counter = 0;
+    nvm_cache_read(SAVE_COUNTER_KEY, &save_counter, sizeof(save_counter));
+    uint32_t min_counter = save_counter;
+    for (int i = 0; i < NUM_SLOTS; i++) {
+      if (slots[i].is_occupied && slots[i].timestamp >= min_counter) {
+        min_counter = slots[i].timestamp + 1;
       }
     }
-    // Init save counter if it doesn't exist
     uint32_t type;
     size_t len;
     err = nvm3_getObjectInfo(nvm3_defaultHandle, SAVE_COUNTER_KEY, &type, &len);
-    if (err != ECODE_NVM3_OK) {
-        uint32_t counter = 0;
-        nvm3_writeData(nvm3_defaultHandle, SAVE_COUNTER_KEY, &counter, sizeof(counter));
+    if (err != ECODE_NVM3_OK || min_counter != save_counter) {
+        nvm_cache_write(SAVE_COUNTER_KEY, &min_counter, sizeof(min_counter));
     }
     // Read high scores
-    err = nvm3_readData(nvm3_defaultHandle, HIGH_SCORES_KEY, high_scores, sizeof(high_scores));
+    err = nvm_cache_read(HIGH_SCORES_KEY, high_scores, sizeof(high_scores));
     if (err != ECODE_NVM3_OK) {
         memset(high_scores, 0, sizeof(high_scores));
     }
@@ -132,13 +174,33 @@ void tetris_init(void)
 
 void tetris_process_action(void)
 {
-  while (nvm3_repackNeeded(nvm3_defaultHandle)) {
-    nvm3_repack(nvm3_defaultHandle);
+  autosave_process_action();
+  stats_process_action();
+  recorder_process_action();
+
+  // Menus are a safe point to let cached high scores and counters reach flash
+  if (current_game_state == GAME_STATE_MAIN_MENU && nvm_cache_is_dirty()) {
+    nvm_cache_flush();
+  }
+  nvm_cache_process_action();
+
+  storage_repack_if_needed();
+
+  if (current_game_state == GAME_STATE_SLOT_SELECTION) {
+    slot_prefetch_step();
   }
 }
 
+// Seeds from the sleeptimer, i.e. from how long the player took to press start
 void tetris_start_new_game(int starting_level)
 {
+  tetris_start_seeded_game(starting_level, sl_sleeptimer_get_tick_count());
+}
+
+void tetris_start_seeded_game(int starting_level, uint32_t seed)
+{
+  game_seed = seed != 0 ? seed : TETRIS_DEFAULT_SEED; // xorshift never leaves zero
+  rng_state = game_seed;
   memset(board, 0, sizeof(board));
   lines_cleared = 0;
   level = starting_level;
@@ -147,15 +209,64 @@ void tetris_start_new_game(int starting_level)
   next_tetromino = get_random_tetromino();
   spawn_new_tetromino();
 
-  tetris_set_game_speed();
+  gravity_start(level);
 
-  current_game_state = GAME_STATE_IN_GAME;
+  rewind_clear();
+  if (practice) {
+    rewind_take(rewind_push());
+  }
+
+  tetris_set_game_state(GAME_STATE_IN_GAME);
+  stats_on_game_start();
+  recorder_on_game_start(game_seed, starting_level);
+}
+
+// Applies to the games started from here on; loaded games are never practice
+void tetris_set_practice(bool enabled)
+{
+  practice = enabled;
+}
+
+bool tetris_is_practice(void)
+{
+  return practice;
+}
+
+// Takes back the piece in play, back to the state right after the previous
+// one locked; after game over, back to the piece that ended it. Paused games
+// stay paused.
+bool tetris_rewind(void)
+{
+  if (!practice || (current_game_state != GAME_STATE_IN_GAME
+                    && current_game_state != GAME_STATE_PAUSED
+                    && current_game_state != GAME_STATE_GAME_OVER)) {
+    return false;
+  }
+  bool game_over = current_game_state == GAME_STATE_GAME_OVER;
+  const rewind_snapshot_t *snap = rewind_step_back(!game_over);
+  if (snap == NULL) {
+    return false;
+  }
+  recorder_on_input(RECORDER_EVENT_REWIND);
+  rewind_restore(snap);
+  gravity_start(level);
+  if (game_over) {
+    tetris_set_game_state(GAME_STATE_IN_GAME);
+    stats_on_play_start();
+  } else if (current_game_state == GAME_STATE_PAUSED) {
+    gravity_pause();
+  } else {
+    tetris_draw_board();
+  }
+  return true;
 }
 
 void tetris_pause_game(void)
 {
   if (current_game_state == GAME_STATE_IN_GAME) {
-    sl_sleeptimer_stop_timer(&tetris_timer);
+    recorder_on_input(RECORDER_EVENT_PAUSE);
+    gravity_pause();
+    stats_on_play_stop();
     tetris_set_game_state(GAME_STATE_PAUSED);
   }
 }
@@ -163,8 +274,10 @@ void tetris_pause_game(void)
 void tetris_resume_game(void)
 {
   if (current_game_state == GAME_STATE_PAUSED) {
+    recorder_on_input(RECORDER_EVENT_RESUME);
     tetris_set_game_state(GAME_STATE_IN_GAME);
-    tetris_set_game_speed();
+    gravity_resume();
+    stats_on_play_start();
   }
 }
 
@@ -182,32 +295,72 @@ void tetris_load_from_slot(int slot_index)
     return;
   }
 
-  saved_game_meta_t saved_meta;
-  uint32_t type;
-  size_t len;
-  uint32_t base_key = SLOT_DATA_KEY_BASE + (slot_index * 10);
-
-  if (nvm3_getObjectInfo(nvm3_defaultHandle, base_key, &type, &len) == ECODE_NVM3_OK) {
-    if (len == sizeof(saved_meta)) {
-      nvm3_readData(nvm3_defaultHandle, base_key, &saved_meta, len);
+  uint32_t start_ticks = sl_sleeptimer_get_tick_count();
 
-      current_tetromino = saved_meta.current_tetromino;
-      next_tetromino = saved_meta.next_tetromino;
-      current_position = saved_meta.current_position;
-      lines_cleared = saved_meta.lines_cleared;
-      level = saved_meta.level;
-      score = saved_meta.score;
+  if (slot_prefetch.slot_index == slot_index
+      && slot_prefetch.next_object == SLOT_PREFETCH_DONE
+      && !slot_prefetch.failed) {
+    apply_saved_meta(&slot_prefetch.meta);
+    memcpy(board, slot_prefetch.board, sizeof(board));
+    last_load_was_prefetched = true;
+  } else {
+    saved_game_meta_t saved_meta;
+    uint32_t type;
+    size_t len;
+    uint32_t base_key = SLOT_DATA_KEY_BASE + (slot_index * SLOT_DATA_KEY_STRIDE);
 
-      for (int i = 0; i < 6; i++) {
-        nvm3_readData(nvm3_defaultHandle, base_key + 1 + i,
-                      (uint8_t*)board + (i * BOARD_CHUNK_SIZE * sizeof(int)),
-                      BOARD_CHUNK_SIZE * sizeof(int));
-      }
+    if (nvm3_getObjectInfo(nvm3_defaultHandle, base_key, &type, &len) != ECODE_NVM3_OK
+        || len != sizeof(saved_meta)) {
+      return;
+    }
+    PROFILE_BEGIN(PROFILE_ZONE_NVM3_READ);
+    nvm3_readData(nvm3_defaultHandle, base_key, &saved_meta, len);
+    apply_saved_meta(&saved_meta);
 
-      tetris_set_game_speed();
-      current_game_state = GAME_STATE_IN_GAME;
+    for (int i = 0; i < 6; i++) {
+      nvm3_readData(nvm3_defaultHandle, base_key + 1 + i,
+                    (uint8_t*)board + (i * BOARD_CHUNK_SIZE * sizeof(int)),
+                    BOARD_CHUNK_SIZE * sizeof(int));
     }
+    PROFILE_END(PROFILE_ZONE_NVM3_READ);
+    last_load_was_prefetched = false;
+  }
+
+  gravity_start(level);
+  tetris_set_game_state(GAME_STATE_IN_GAME);
+  stats_on_play_start();
+  recorder_on_untracked_game();
+  practice = false;
+  rewind_clear();
+  last_load_ticks = sl_sleeptimer_get_tick_count() - start_ticks;
+  last_load_measured = true;
+}
+
+void tetris_prefetch_slot(int slot_index)
+{
+#if SLOT_PREFETCH_ENABLE
+  if (slot_index < 0 || slot_index >= NUM_SLOTS || !slots[slot_index].is_occupied) {
+    slot_prefetch.slot_index = -1;
+    return;
   }
+  if (slot_prefetch.slot_index != slot_index) {
+    slot_prefetch.slot_index = slot_index;
+    slot_prefetch.next_object = 0;
+    slot_prefetch.failed = false;
+  }
+#else
+  (void)slot_index;
+#endif
+}
+
+// False until a slot has been loaded since boot
+bool tetris_get_last_load_ticks(uint32_t *ticks, bool *was_prefetched)
+{
+  *ticks = last_load_ticks;
+  if (was_prefetched != NULL) {
+    *was_prefetched = last_load_was_prefetched;
+  }
+  return last_load_measured;
 }
 
 void tetris_delete_slot(int slot_index)
@@ -215,11 +368,12 @@ void tetris_delete_slot(int slot_index)
   if (slot_index < 0 || slot_index >= NUM_SLOTS) {
       return;
   }
+  slot_prefetch_invalidate(slot_index);
   slots[slot_index].is_occupied = false;
-  nvm3_deleteObject(nvm3_defaultHandle, SLOT_META_KEY_BASE + slot_index);
-  uint32_t base_key = SLOT_DATA_KEY_BASE + (slot_index * 10);
-  for (int i = 0; i < 7; i++) {
-      nvm3_deleteObject(nvm3_defaultHandle, base_key + i);
+  storage_delete(SLOT_META_KEY_BASE + slot_index);
+  uint32_t base_key = SLOT_DATA_KEY_BASE + (slot_index * SLOT_DATA_KEY_STRIDE);
+  for (int i = 0; i < SLOT_DATA_KEYS; i++) {
+      storage_delete(base_key + i);
   }
 }
 
@@ -228,10 +382,22 @@ void tetris_get_slot_name(int slot_index, char* buffer, size_t buffer_size)
     if (slot_index < 0 || slot_index >= NUM_SLOTS || !slots[slot_index].is_occupied) {
         snprintf(buffer, buffer_size, "Empty");
     } else {
-        strncpy(buffer, slots[slot_index].name, buffer_size);
+        snprintf(buffer, buffer_size, "Slot %d: %ld", slot_index + 1, (long)slots[slot_index].score);
     }
 }
 
+bool tetris_get_slot_silhouette(int slot_index, uint8_t heights[BOARD_WIDTH])
+{
+    if (slot_index < 0 || slot_index >= NUM_SLOTS || !slots[slot_index].is_occupied) {
+        return false;
+    }
+    for (int x = 0; x < BOARD_WIDTH; x++) {
+        uint8_t packed = slots[slot_index].silhouette[x / 2];
+        heights[x] = (x & 1) ? (packed >> 4) : (packed & 0x0F);
+    }
+    return true;
+}
+
 bool tetris_has_saved_game(void)
 {
   for (int i = 0; i < NUM_SLOTS; i++) {
@@ -259,7 +425,7 @@ void tetris_add_high_score(uint32_t score)
             break;
         }
     }
-    nvm3_writeData(nvm3_defaultHandle, HIGH_SCORES_KEY, high_scores, sizeof(high_scores));
+    nvm_cache_write(HIGH_SCORES_KEY, high_scores, sizeof(high_scores));
 }
 
 bool tetris_is_high_score(uint32_t score)
@@ -267,48 +433,45 @@ bool tetris_is_high_score(uint32_t score)
     return score > high_scores[4];
 }
 
+// Gravity event: drop the rows owed since the last wakeup, then lock the
+// piece once it has rested on the stack for the lock delay.
 void tetris_update(void)
 {
     if (current_game_state != GAME_STATE_IN_GAME) {
         return;
     }
 
+    recorder_on_gravity();
+    uint32_t rows = gravity_take_rows();
+    bool changed = false;
     Point next_pos = current_position;
     next_pos.y++;
-
-    if (check_collision(next_pos, current_tetromino)) {
-        bool is_t_spin = false;
-        if (current_tetromino.color == 3 && last_move_was_rotation) {
-            // Check for 3 corners occupied for T-spin
-            int corners = 0;
-            if (current_position.x > 0 && current_position.y > 0 && board[current_position.x - 1][current_position.y - 1]) corners++;
-            if (current_position.x < BOARD_WIDTH - 1 && current_position.y > 0 && board[current_position.x + 1][current_position.y - 1]) corners++;
-            if (current_position.x > 0 && current_position.y < BOARD_HEIGHT - 1 && board[current_position.x - 1][current_position.y + 1]) corners++;
-            if (current_position.x < BOARD_WIDTH - 1 && current_position.y < BOARD_HEIGHT - 1 && board[current_position.x + 1][current_position.y + 1]) corners++;
-            if (corners >= 3) {
-                is_t_spin = true;
-            }
-        }
-
-        merge_tetromino();
-        clear_lines(is_t_spin);
-        spawn_new_tetromino();
-        if (check_collision(current_position, current_tetromino)) {
-            sl_sleeptimer_stop_timer(&tetris_timer);
-            if (tetris_is_high_score(score)) {
-                tetris_add_high_score(score);
-            }
-            current_game_state = GAME_STATE_GAME_OVER;
-        }
-    } else {
+    while (rows > 0 && !check_collision(next_pos, current_tetromino)) {
         current_position = next_pos;
+        next_pos.y++;
+        rows--;
+        changed = true;
+    }
+    if (changed) {
+        last_move_was_rotation = false;
+    }
+    gravity_set_grounded(check_collision(next_pos, current_tetromino));
+
+    if (gravity_lock_due()) {
+        lock_current_piece();
+        last_move_was_rotation = false;
+        changed = true;
+    }
+    refresh_gravity();
+    if (changed) {
+        tetris_draw_board();
     }
-    last_move_was_rotation = false;
-    tetris_draw_board();
 }
 
 void tetris_draw_board(void)
 {
+    PROFILE_BEGIN(PROFILE_ZONE_DRAW_BOARD);
+    uint32_t frame_start = sl_sleeptimer_get_tick_count();
     GLIB_clear(&glibContext);
 
     if (current_game_state == GAME_STATE_GAME_OVER) {
@@ -324,40 +487,15 @@ void tetris_draw_board(void)
         char* restart_text = "Press BTN1";
         text_x = (glibContext.pDisplayGeometry->xSize - (strlen(restart_text) * 6)) / 2;
         GLIB_drawString(&glibContext, restart_text, strlen(restart_text), text_x, 80, 0);
-        DMD_updateDisplay();
+        tetris_update_display();
+        diagnostics_on_frame(frame_start);
+        PROFILE_END(PROFILE_ZONE_DRAW_BOARD);
         return;
     }
-  // Draw board border
-  GLIB_Rectangle_t rect = { .xMin = 0, .yMin = 0, .xMax = BOARD_WIDTH * BLOCK_SIZE + 1, .yMax = BOARD_HEIGHT * BLOCK_SIZE + 1 };
-  GLIB_drawRect(&glibContext, &rect);
-
-  // Draw settled blocks
-  for (int y = 0; y < BOARD_HEIGHT; y++) {
-      for (int x = 0; x < BOARD_WIDTH; x++) {
-          if (board[x][y]) {
-              rect.xMin = x * BLOCK_SIZE + 1;
-              rect.yMin = y * BLOCK_SIZE + 1;
-              rect.xMax = rect.xMin + BLOCK_SIZE - 1;
-              rect.yMax = rect.yMin + BLOCK_SIZE - 1;
-              GLIB_drawRectFilled(&glibContext, &rect);
-          }
-      }
-  }
-
-  // Draw current tetromino
-  for (int i = 0; i < 4; i++) {
-      int x = current_position.x + current_tetromino.blocks[i].x;
-      int y = current_position.y + current_tetromino.blocks[i].y;
-      if (y >= 0) {
-        rect.xMin = x * BLOCK_SIZE + 1;
-        rect.yMin = y * BLOCK_SIZE + 1;
-        rect.xMax = rect.xMin + BLOCK_SIZE - 1;
-        rect.yMax = rect.yMin + BLOCK_SIZE - 1;
-        GLIB_drawRectFilled(&glibContext, &rect);
-      }
-  }
+  draw_playfield();
 
   // --- Draw Side Panel ---
+  GLIB_Rectangle_t rect;
   char text_buffer[10];
   int right_panel_x = (BOARD_WIDTH * BLOCK_SIZE) + 10;
 
@@ -409,7 +547,9 @@ void tetris_draw_board(void)
       GLIB_drawString(&glibContext, saved_text, strlen(saved_text), text_x, 20, 0);
   }
 
-  DMD_updateDisplay();
+  tetris_update_display();
+  diagnostics_on_frame(frame_start);
+  PROFILE_END(PROFILE_ZONE_DRAW_BOARD);
 }
 
 // --- State Management Functions ---
@@ -420,45 +560,252 @@ game_state_t tetris_get_game_state(void)
 
 void tetris_set_game_state(game_state_t new_state)
 {
+  if (new_state != current_game_state) {
+    trace_event(TRACE_STATE, (uint8_t)new_state, (uint16_t)current_game_state);
+  }
+  if (new_state == GAME_STATE_MAIN_MENU
+      && (current_game_state == GAME_STATE_IN_GAME || current_game_state == GAME_STATE_PAUSED)) {
+    recorder_on_game_quit();
+  }
   current_game_state = new_state;
 }
 
+// Every frame goes to the LCD through here
+void tetris_update_display(void)
+{
+  trace_event(TRACE_DISPLAY_BEGIN, 0, 0);
+  PROFILE_CALL(PROFILE_ZONE_DISPLAY_UPDATE, DMD_updateDisplay());
+  trace_event(TRACE_DISPLAY_END, 0, 0);
+  latency_frame_done();
+}
+
 GLIB_Context_t* tetris_get_glib_context(void)
 {
   return &glibContext;
 }
 
+uint32_t tetris_get_game_seed(void)
+{
+  return game_seed;
+}
+
+// FNV-1a over everything that decides how the game continues: board, piece,
+// position, score, lines, level, piece generator and game state
+uint32_t tetris_state_hash(void)
+{
+  uint32_t hash = 2166136261u;
+  const int32_t values[] = {
+    current_position.x, current_position.y, current_tetromino.color, next_tetromino.color,
+    score, lines_cleared, level, (int32_t)rng_state, current_game_state,
+    current_tetromino.blocks[0].x, current_tetromino.blocks[0].y, current_tetromino.blocks[1].x, current_tetromino.blocks[1].y,
+    current_tetromino.blocks[2].x, current_tetromino.blocks[2].y, current_tetromino.blocks[3].x, current_tetromino.blocks[3].y,
+  };
+  for (int x = 0; x < BOARD_WIDTH; x++) {
+    for (int y = 0; y < BOARD_HEIGHT; y++) {
+      hash = (hash ^ (uint8_t)board[x][y]) * 16777619u;
+    }
+  }
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    for (int b = 0; b < 32; b += 8) {
+      hash = (hash ^ (uint8_t)((uint32_t)values[i] >> b)) * 16777619u;
+    }
+  }
+  return hash;
+}
+
+// --- Snapshots ---
+
+// Only valid at piece-lock boundaries: the current piece is taken to be freshly
+// spawned, so its type is enough to rebuild it.
+void tetris_snapshot_take(tetris_snapshot_t *snap)
+{
+  const int *cells = &board[0][0];
+  for (int i = 0; i < TETRIS_SNAPSHOT_BOARD_BYTES; i++) {
+    snap->cells[i] = (uint8_t)((cells[2 * i] & 0x0F) | ((cells[2 * i + 1] & 0x0F) << 4));
+  }
+  snap->score = score;
+  snap->lines_cleared = (uint16_t)lines_cleared;
+  snap->level = (uint8_t)level;
+  snap->current_piece = (uint8_t)current_tetromino.color;
+  snap->next_piece = (uint8_t)next_tetromino.color;
+  snap->rng_state = rng_state;
+  snap->flags = last_move_was_rotation ? TETRIS_SNAPSHOT_ROTATED : 0;
+}
+
+bool tetris_snapshot_restore(const tetris_snapshot_t *snap)
+{
+  int num_types = sizeof(tetrominoes) / sizeof(Tetromino);
+  if (snap->current_piece < 1 || snap->current_piece > num_types
+      || snap->next_piece < 1 || snap->next_piece > num_types
+      || snap->level < 1 || snap->rng_state == 0) {
+    return false;
+  }
+
+  int *cells = &board[0][0];
+  for (int i = 0; i < TETRIS_SNAPSHOT_BOARD_BYTES; i++) {
+    cells[2 * i] = snap->cells[i] & 0x0F;
+    cells[2 * i + 1] = snap->cells[i] >> 4;
+  }
+  score = snap->score;
+  lines_cleared = snap->lines_cleared;
+  level = snap->level;
+  current_tetromino = tetrominoes[snap->current_piece - 1];
+  next_tetromino = tetrominoes[snap->next_piece - 1];
+  current_position.x = BOARD_WIDTH / 2 - 1;
+  current_position.y = 0;
+  rng_state = snap->rng_state;
+  last_move_was_rotation = (snap->flags & TETRIS_SNAPSHOT_ROTATED) != 0;
+  return true;
+}
+
+void tetris_start_from_snapshot(const tetris_snapshot_t *snap)
+{
+  if (!tetris_snapshot_restore(snap)) {
+    return;
+  }
+  gravity_start(level);
+  tetris_set_game_state(GAME_STATE_IN_GAME);
+  stats_on_play_start();
+  recorder_on_untracked_game();
+  practice = false;
+  rewind_clear();
+}
+
+#if TETRIS_BENCH
+// --- Benchmark Hooks ---
+
+// Sets up an in-game position: rows[y] has bit x set for every filled cell
+void tetris_bench_load(const uint16_t rows[BOARD_HEIGHT], int piece, int x, int y)
+{
+  for (int row = 0; row < BOARD_HEIGHT; row++) {
+    for (int col = 0; col < BOARD_WIDTH; col++) {
+      board[col][row] = (rows[row] >> col) & 1u;
+    }
+  }
+  current_tetromino = tetrominoes[piece - 1];
+  next_tetromino = tetrominoes[2];
+  current_position.x = x;
+  current_position.y = y;
+  lines_cleared = 0;
+  level = 1;
+  score = 0;
+  last_move_was_rotation = false;
+  current_game_state = GAME_STATE_IN_GAME;
+  recorder_on_untracked_game();
+  practice = false;
+  rewind_clear();
+}
+
+bool tetris_bench_collides(int dx, int dy)
+{
+  Point pos = { current_position.x + dx, current_position.y + dy };
+  return check_collision(pos, current_tetromino);
+}
+
+bool tetris_bench_rotate(void)
+{
+  return try_rotate();
+}
+
+void tetris_bench_merge(void)
+{
+  merge_tetromino();
+}
+
+int tetris_bench_clear_lines(bool is_t_spin)
+{
+  return clear_lines(is_t_spin);
+}
+
+// Leaves the piece where it started so the drop can be repeated
+int tetris_bench_drop(void)
+{
+  Point start = current_position;
+  int rows = drop_to_floor();
+  current_position = start;
+  return rows;
+}
+
+void tetris_bench_get_piece(Tetromino *piece, Point *position)
+{
+  *piece = current_tetromino;
+  *position = current_position;
+}
+
+// The lock-path cost of a practice game: one rewind point
+void tetris_bench_rewind_take(void)
+{
+  rewind_take(rewind_push());
+}
+
+// Puts back the newest rewind point, i.e. the one the last take left
+void tetris_bench_rewind_restore(void)
+{
+  const rewind_snapshot_t *snap = rewind_step_back(false);
+  if (snap != NULL) {
+    rewind_restore(snap);
+  }
+}
+
+// The playfield part of tetris_draw_board(), drawn but not pushed to the LCD
+void tetris_bench_draw_playfield(void)
+{
+  draw_playfield();
+}
+#endif // TETRIS_BENCH
+
 // --- Game Logic Functions ---
 
 void tetris_move_left(void)
 {
-    if (current_game_state != GAME_STATE_IN_GAME) return;
-    Point next_pos = current_position;
-    next_pos.x--;
-    if (!check_collision(next_pos, current_tetromino)) {
-        current_position = next_pos;
-    }
-    last_move_was_rotation = false;
-    tetris_draw_board();
+    tetris_shift(-1, 1);
 }
 
 void tetris_move_right(void)
 {
-    if (current_game_state != GAME_STATE_IN_GAME) return;
+    tetris_shift(1, 1);
+}
+
+// Moves the piece up to max_cells columns in direction dx (-1 or 1) and draws
+// once if it moved. Returns the number of columns actually moved.
+int tetris_shift(int dx, int max_cells)
+{
+    if (current_game_state != GAME_STATE_IN_GAME) return 0;
+    recorder_on_shift(dx, max_cells);
+    int moved = 0;
     Point next_pos = current_position;
-    next_pos.x++;
-    if (!check_collision(next_pos, current_tetromino)) {
+    while (moved < max_cells) {
+        next_pos.x += dx;
+        if (check_collision(next_pos, current_tetromino)) {
+            break;
+        }
         current_position = next_pos;
+        moved++;
     }
-    last_move_was_rotation = false;
-    tetris_draw_board();
+    if (moved > 0) {
+        last_move_was_rotation = false;
+        gravity_on_piece_moved();
+        refresh_gravity();
+        tetris_draw_board();
+    }
+    return moved;
 }
 
+// Soft drop step: one row down, or lock right away when the piece already rests on the stack
 void tetris_move_down(void)
 {
   if (current_game_state != GAME_STATE_IN_GAME) return;
-  tetris_update();
+  recorder_on_input(RECORDER_EVENT_SOFT_DROP);
+  Point next_pos = current_position;
+  next_pos.y++;
+  if (check_collision(next_pos, current_tetromino)) {
+    lock_current_piece();
+  } else {
+    current_position = next_pos;
+  }
   last_move_was_rotation = false;
+  refresh_gravity();
+  tetris_draw_board();
 }
 
 void tetris_rotate(void)
@@ -466,17 +813,12 @@ void tetris_rotate(void)
     if (current_game_state != GAME_STATE_IN_GAME || current_tetromino.color == 2) { // Do not rotate 'O' piece
       return;
     }
+    recorder_on_input(RECORDER_EVENT_ROTATE);
 
-    Tetromino rotated = current_tetromino;
-    for (int i = 0; i < 4; i++) {
-        int x = rotated.blocks[i].x;
-        rotated.blocks[i].x = -rotated.blocks[i].y;
-        rotated.blocks[i].y = x;
-    }
-
-    if (!check_collision(current_position, rotated)) {
-        current_tetromino = rotated;
+    if (try_rotate()) {
         last_move_was_rotation = true;
+        gravity_on_piece_moved();
+        refresh_gravity();
     }
     tetris_draw_board();
 }
@@ -484,47 +826,28 @@ void tetris_rotate(void)
 void tetris_hard_drop(void)
 {
     if (current_game_state != GAME_STATE_IN_GAME) return;
+    recorder_on_input(RECORDER_EVENT_HARD_DROP);
 
-    Point next_pos = current_position;
-    int lines_dropped = 0;
-    while (!check_collision(next_pos, current_tetromino)) {
-        current_position = next_pos;
-        next_pos.y++;
-        lines_dropped++;
-    }
+    score += drop_to_floor() * 2;
 
-    score += lines_dropped * 2;
-
-    merge_tetromino();
-    clear_lines(false);
-    spawn_new_tetromino();
-    if (check_collision(current_position, current_tetromino)) {
-        sl_sleeptimer_stop_timer(&tetris_timer);
-        if (tetris_is_high_score(score)) {
-            tetris_add_high_score(score);
-        }
-        current_game_state = GAME_STATE_GAME_OVER;
-    }
+    lock_tetromino(false);
+    refresh_gravity();
     tetris_draw_board();
 }
 
-// --- Internal Helper Functions ---
-
-static void tetris_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
+uint32_t tetris_get_gravity_ms(void)
 {
-    (void)handle;
-    (void)data;
-    tetris_update();
+  return gravity_get_row_ms();
 }
 
+// --- Internal Helper Functions ---
+
 static void save_msg_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
 {
     (void)handle;
     (void)data;
     display_save_message = false;
-    if (tetris_get_game_state() == GAME_STATE_IN_GAME) {
-        tetris_draw_board();
-    }
+    app_events_post(APP_EVENT_REDRAW);
 }
 
 static void save_failed_msg_timer_callback(sl_sleeptimer_timer_handle_t *handle, void *data)
@@ -532,9 +855,7 @@ static void save_failed_msg_timer_callback(sl_sleeptimer_timer_handle_t *handle,
     (void)handle;
     (void)data;
     display_save_failed_message = false;
-    if (tetris_get_game_state() == GAME_STATE_IN_GAME) {
-        tetris_draw_board();
-    }
+    app_events_post(APP_EVENT_REDRAW);
 }
 
 static int find_next_slot(void)
@@ -564,6 +885,8 @@ static void tetris_save_to_slot(int slot_index)
         return;
     }
 
+    slot_prefetch_invalidate(slot_index);
+
     saved_game_meta_t saved_meta;
     saved_meta.current_tetromino = current_tetromino;
     saved_meta.next_tetromino = next_tetromino;
@@ -572,8 +895,8 @@ static void tetris_save_to_slot(int slot_index)
     saved_meta.level = level;
     saved_meta.score = score;
 
-    uint32_t base_key = SLOT_DATA_KEY_BASE + (slot_index * 10);
-    Ecode_t err = nvm3_writeData(nvm3_defaultHandle, base_key, &saved_meta, sizeof(saved_meta));
+    uint32_t base_key = SLOT_DATA_KEY_BASE + (slot_index * SLOT_DATA_KEY_STRIDE);
+    Ecode_t err = storage_write(base_key, &saved_meta, sizeof(saved_meta));
     if (err != ECODE_NVM3_OK) {
         display_save_failed_message = true;
         sl_sleeptimer_start_timer_ms(&save_msg_timer, 2000, save_failed_msg_timer_callback, NULL, 0, 0);
@@ -582,9 +905,9 @@ static void tetris_save_to_slot(int slot_index)
     }
 
     for (int i = 0; i < 6; i++) {
-      err = nvm3_writeData(nvm3_defaultHandle, base_key + 1 + i,
-                           (uint8_t*)board + (i * BOARD_CHUNK_SIZE * sizeof(int)),
-                           BOARD_CHUNK_SIZE * sizeof(int));
+      err = storage_write(base_key + 1 + i,
+                          (uint8_t*)board + (i * BOARD_CHUNK_SIZE * sizeof(int)),
+                          BOARD_CHUNK_SIZE * sizeof(int));
       if (err != ECODE_NVM3_OK) {
           display_save_failed_message = true;
           sl_sleeptimer_start_timer_ms(&save_msg_timer, 2000, save_failed_msg_timer_callback, NULL, 0, 0);
@@ -595,21 +918,130 @@ static void tetris_save_to_slot(int slot_index)
 
     // Update slot metadata
     uint32_t save_counter;
-    nvm3_readData(nvm3_defaultHandle, SAVE_COUNTER_KEY, &save_counter, sizeof(save_counter));
+    nvm_cache_read(SAVE_COUNTER_KEY, &save_counter, sizeof(save_counter));
     slots[slot_index].is_occupied = true;
     slots[slot_index].timestamp = save_counter++;
-    nvm3_writeData(nvm3_defaultHandle, SAVE_COUNTER_KEY, &save_counter, sizeof(save_counter));
-    snprintf(slots[slot_index].name, sizeof(slots[slot_index].name), "Slot %d: %d", slot_index + 1, score);
-    nvm3_writeData(nvm3_defaultHandle, SLOT_META_KEY_BASE + slot_index, &slots[slot_index], sizeof(game_slot_t));
+    nvm_cache_write(SAVE_COUNTER_KEY, &save_counter, sizeof(save_counter));
+    slots[slot_index].score = score;
+    build_slot_silhouette(slots[slot_index].silhouette);
+    storage_write(SLOT_META_KEY_BASE + slot_index, &slots[slot_index], sizeof(game_slot_t));
 
     display_save_message = true;
     sl_sleeptimer_start_timer_ms(&save_msg_timer, 2000, save_msg_timer_callback, NULL, 0, 0);
     tetris_draw_board();
 }
 
+static void slot_prefetch_invalidate(int slot_index)
+{
+    if (slot_prefetch.slot_index == slot_index) {
+        slot_prefetch.slot_index = -1;
+    }
+}
+
+// Reads one NVM3 object of the highlighted slot per call so the main loop stays responsive.
+static void slot_prefetch_step(void)
+{
+    if (slot_prefetch.slot_index < 0
+        || slot_prefetch.failed
+        || slot_prefetch.next_object == SLOT_PREFETCH_DONE) {
+        return;
+    }
+
+    uint32_t base_key = SLOT_DATA_KEY_BASE + (slot_prefetch.slot_index * SLOT_DATA_KEY_STRIDE);
+    Ecode_t err;
+
+    PROFILE_BEGIN(PROFILE_ZONE_NVM3_READ);
+    if (slot_prefetch.next_object == 0) {
+        uint32_t type;
+        size_t len;
+        err = nvm3_getObjectInfo(nvm3_defaultHandle, base_key, &type, &len);
+        if (err == ECODE_NVM3_OK && len == sizeof(slot_prefetch.meta)) {
+            err = nvm3_readData(nvm3_defaultHandle, base_key, &slot_prefetch.meta, len);
+        } else if (err == ECODE_NVM3_OK) {
+            err = ECODE_NVM3_ERR_READ_DATA_SIZE;
+        }
+    } else {
+        int chunk = slot_prefetch.next_object - 1;
+        err = nvm3_readData(nvm3_defaultHandle, base_key + slot_prefetch.next_object,
+                            (uint8_t*)slot_prefetch.board + (chunk * BOARD_CHUNK_SIZE * sizeof(int)),
+                            BOARD_CHUNK_SIZE * sizeof(int));
+    }
+    PROFILE_END(PROFILE_ZONE_NVM3_READ);
+
+    if (err != ECODE_NVM3_OK) {
+        slot_prefetch.failed = true;
+        return;
+    }
+    slot_prefetch.next_object++;
+    if (slot_prefetch.next_object < SLOT_PREFETCH_DONE) {
+        app_events_post(APP_EVENT_STORAGE); // keep stepping on the next loop pass
+    }
+}
+
+static void read_slot_index(int slot_index)
+{
+    game_slot_t *slot = &slots[slot_index];
+    uint32_t type;
+    size_t len;
+
+    memset(slot, 0, sizeof(*slot));
+    if (nvm3_getObjectInfo(nvm3_defaultHandle, SLOT_META_KEY_BASE + slot_index, &type, &len) != ECODE_NVM3_OK) {
+        return;
+    }
+
+    if (len == sizeof(game_slot_t)) {
+        if (nvm3_readData(nvm3_defaultHandle, SLOT_META_KEY_BASE + slot_index, slot, len) != ECODE_NVM3_OK) {
+            slot->is_occupied = false;
+        }
+    } else if (len == sizeof(legacy_game_slot_t)) {
+        // Old entries only carry the "Slot N: score" name; keep the score, no silhouette
+        legacy_game_slot_t legacy;
+        if (nvm3_readData(nvm3_defaultHandle, SLOT_META_KEY_BASE + slot_index, &legacy, len) == ECODE_NVM3_OK) {
+            const char *score_text = strchr(legacy.name, ':');
+            slot->is_occupied = legacy.is_occupied;
+            slot->timestamp = legacy.timestamp;
+            slot->score = score_text ? atol(score_text + 1) : 0;
+        }
+    }
+}
+
+static void build_slot_silhouette(uint8_t silhouette[SLOT_SILHOUETTE_SIZE])
+{
+    memset(silhouette, 0, SLOT_SILHOUETTE_SIZE);
+    for (int x = 0; x < BOARD_WIDTH; x++) {
+        int height = 0;
+        for (int y = 0; y < BOARD_HEIGHT; y++) {
+            if (board[x][y]) {
+                height = BOARD_HEIGHT - y;
+                break;
+            }
+        }
+        uint8_t half_rows = (uint8_t)((height + 1) / 2); // 0..11 fits a nibble
+        silhouette[x / 2] |= (x & 1) ? (uint8_t)(half_rows << 4) : half_rows;
+    }
+}
+
+static void apply_saved_meta(const saved_game_meta_t *saved_meta)
+{
+    current_tetromino = saved_meta->current_tetromino;
+    next_tetromino = saved_meta->next_tetromino;
+    current_position = saved_meta->current_position;
+    lines_cleared = saved_meta->lines_cleared;
+    level = saved_meta->level;
+    score = saved_meta->score;
+}
+
+static uint32_t next_random(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
 static Tetromino get_random_tetromino(void)
 {
-    return tetrominoes[rand() % (sizeof(tetrominoes) / sizeof(Tetromino))];
+    return tetrominoes[next_random() % (sizeof(tetrominoes) / sizeof(Tetromino))];
 }
 
 static void spawn_new_tetromino(void)
@@ -618,23 +1050,56 @@ static void spawn_new_tetromino(void)
     next_tetromino = get_random_tetromino();
     current_position.x = BOARD_WIDTH / 2 - 1;
     current_position.y = 0;
+    gravity_on_spawn();
+    trace_event(TRACE_SPAWN, (uint8_t)current_tetromino.color, 0);
 }
 
 static bool check_collision(Point pos, Tetromino tet)
 {
-    for (int i = 0; i < 4; i++) {
+    PROFILE_BEGIN(PROFILE_ZONE_COLLISION);
+    bool collision = false;
+    for (int i = 0; i < 4 && !collision; i++) {
         int x = pos.x + tet.blocks[i].x;
         int y = pos.y + tet.blocks[i].y;
 
         if (x < 0 || x >= BOARD_WIDTH || y >= BOARD_HEIGHT) {
-            return true;
+            collision = true;
+        } else if (y >= 0 && board[x][y]) {
+            collision = true;
         }
+    }
+    PROFILE_END(PROFILE_ZONE_COLLISION);
+    return collision;
+}
 
-        if (y >= 0 && board[x][y]) {
-            return true;
-        }
+// Rotates the current piece clockwise in place unless the result collides
+static bool try_rotate(void)
+{
+    Tetromino rotated = current_tetromino;
+    for (int i = 0; i < 4; i++) {
+        int x = rotated.blocks[i].x;
+        rotated.blocks[i].x = -rotated.blocks[i].y;
+        rotated.blocks[i].y = x;
     }
-    return false;
+
+    if (check_collision(current_position, rotated)) {
+        return false;
+    }
+    current_tetromino = rotated;
+    return true;
+}
+
+// Moves the current piece down until it rests on the stack; returns the step count
+static int drop_to_floor(void)
+{
+    Point next_pos = current_position;
+    int lines_dropped = 0;
+    while (!check_collision(next_pos, current_tetromino)) {
+        current_position = next_pos;
+        next_pos.y++;
+        lines_dropped++;
+    }
+    return lines_dropped;
 }
 
 static void merge_tetromino(void)
@@ -648,23 +1113,68 @@ static void merge_tetromino(void)
     }
 }
 
-static void tetris_set_game_speed(void)
+// Settles the current piece, spawns the next one and checks for game over.
+static void lock_tetromino(bool is_t_spin)
 {
-  int new_speed = 500 - ((level - 1) * 50);
-  if (new_speed < 50) {
-    new_speed = 50;
-  }
-  sl_sleeptimer_stop_timer(&tetris_timer);
-  sl_sleeptimer_start_periodic_timer_ms(&tetris_timer,
-                                        new_speed,
-                                        tetris_timer_callback,
-                                        NULL,
-                                        0,
-                                        0);
+    merge_tetromino();
+    int cleared = clear_lines(is_t_spin);
+    trace_event(TRACE_LOCK, is_t_spin, (uint16_t)cleared);
+    stats_on_lock(cleared, is_t_spin);
+    recorder_on_lock();
+    spawn_new_tetromino();
+    if (check_collision(current_position, current_tetromino)) {
+        gravity_stop();
+        if (!practice && tetris_is_high_score(score)) {
+            tetris_add_high_score(score);
+        }
+        if (!practice) {
+            // A practice run never wrote the checkpoint; it belongs to a quit normal game
+            autosave_discard();
+        }
+        stats_on_play_stop();
+        tetris_set_game_state(GAME_STATE_GAME_OVER);
+        recorder_on_game_over();
+    } else if (practice) {
+        // Practice games are never checkpointed: a resume would leave practice
+        rewind_take(rewind_push());
+    } else {
+        autosave_on_lock();
+    }
+}
+
+// Checks the T-spin corner rule for the piece at rest, then locks it
+static void lock_current_piece(void)
+{
+    bool is_t_spin = false;
+    if (current_tetromino.color == 3 && last_move_was_rotation) {
+        // Check for 3 corners occupied for T-spin
+        int corners = 0;
+        if (current_position.x > 0 && current_position.y > 0 && board[current_position.x - 1][current_position.y - 1]) corners++;
+        if (current_position.x < BOARD_WIDTH - 1 && current_position.y > 0 && board[current_position.x + 1][current_position.y - 1]) corners++;
+        if (current_position.x > 0 && current_position.y < BOARD_HEIGHT - 1 && board[current_position.x - 1][current_position.y + 1]) corners++;
+        if (current_position.x < BOARD_WIDTH - 1 && current_position.y < BOARD_HEIGHT - 1 && board[current_position.x + 1][current_position.y + 1]) corners++;
+        if (corners >= 3) {
+            is_t_spin = true;
+        }
+    }
+    lock_tetromino(is_t_spin);
 }
 
-static void clear_lines(bool is_t_spin)
+// Tells the scheduler whether the piece rests on the stack and re-arms its timer
+static void refresh_gravity(void)
 {
+    if (current_game_state != GAME_STATE_IN_GAME) {
+        return;
+    }
+    Point below = current_position;
+    below.y++;
+    gravity_set_grounded(check_collision(below, current_tetromino));
+    gravity_schedule();
+}
+
+static int clear_lines(bool is_t_spin)
+{
+    PROFILE_BEGIN(PROFILE_ZONE_CLEAR_LINES);
     int num_cleared_lines = 0;
     for (int y = BOARD_HEIGHT - 1; y >= 0; y--) {
         bool line_full = true;
@@ -689,6 +1199,7 @@ static void clear_lines(bool is_t_spin)
         }
     }
     if (num_cleared_lines > 0) {
+        trace_event(TRACE_LINE_CLEAR, (uint8_t)num_cleared_lines, (uint16_t)level);
         lines_cleared += num_cleared_lines;
         if (is_t_spin) {
             switch (num_cleared_lines) {
@@ -707,9 +1218,83 @@ static void clear_lines(bool is_t_spin)
         int new_level = (lines_cleared / 10) + 1;
         if (new_level > level) {
             level = new_level;
-            tetris_set_game_speed();
+            gravity_set_level(level);
         }
     } else if (is_t_spin) {
         score += 400 * level; // T-Spin Mini
     }
+    PROFILE_END(PROFILE_ZONE_CLEAR_LINES);
+    return num_cleared_lines;
+}
+
+// One row mask per line, built in a register; the whole board is in cache on the lock path
+static void rewind_take(rewind_snapshot_t *snap)
+{
+    for (int y = 0; y < BOARD_HEIGHT; y++) {
+        uint32_t mask = 0;
+        for (int x = 0; x < BOARD_WIDTH; x++) {
+            mask |= (uint32_t)(board[x][y] != 0) << x;
+        }
+        snap->rows[y] = (uint16_t)mask;
+    }
+    snap->score = score;
+    snap->rng_state = rng_state;
+    snap->lines_cleared = (uint16_t)lines_cleared;
+    snap->level = (uint8_t)level;
+    snap->current_piece = (uint8_t)current_tetromino.color;
+    snap->next_piece = (uint8_t)next_tetromino.color;
+    snap->flags = last_move_was_rotation ? TETRIS_SNAPSHOT_ROTATED : 0;
+}
+
+// Filled cells come back as color 1; the display draws them all the same
+static void rewind_restore(const rewind_snapshot_t *snap)
+{
+    for (int x = 0; x < BOARD_WIDTH; x++) {
+        for (int y = 0; y < BOARD_HEIGHT; y++) {
+            board[x][y] = (snap->rows[y] >> x) & 1u;
+        }
+    }
+    score = snap->score;
+    rng_state = snap->rng_state;
+    lines_cleared = snap->lines_cleared;
+    level = snap->level;
+    current_tetromino = tetrominoes[snap->current_piece - 1];
+    next_tetromino = tetrominoes[snap->next_piece - 1];
+    current_position.x = BOARD_WIDTH / 2 - 1;
+    current_position.y = 0;
+    last_move_was_rotation = (snap->flags & TETRIS_SNAPSHOT_ROTATED) != 0;
+}
+
+// Border, settled blocks and the falling piece, into the GLIB buffer
+static void draw_playfield(void)
+{
+  // Draw board border
+  GLIB_Rectangle_t rect = { .xMin = 0, .yMin = 0, .xMax = BOARD_WIDTH * BLOCK_SIZE + 1, .yMax = BOARD_HEIGHT * BLOCK_SIZE + 1 };
+  GLIB_drawRect(&glibContext, &rect);
+
+  // Draw settled blocks
+  for (int y = 0; y < BOARD_HEIGHT; y++) {
+      for (int x = 0; x < BOARD_WIDTH; x++) {
+          if (board[x][y]) {
+              rect.xMin = x * BLOCK_SIZE + 1;
+              rect.yMin = y * BLOCK_SIZE + 1;
+              rect.xMax = rect.xMin + BLOCK_SIZE - 1;
+              rect.yMax = rect.yMin + BLOCK_SIZE - 1;
+              GLIB_drawRectFilled(&glibContext, &rect);
+          }
+      }
+  }
+
+  // Draw current tetromino
+  for (int i = 0; i < 4; i++) {
+      int x = current_position.x + current_tetromino.blocks[i].x;
+      int y = current_position.y + current_tetromino.blocks[i].y;
+      if (y >= 0) {
+        rect.xMin = x * BLOCK_SIZE + 1;
+        rect.yMin = y * BLOCK_SIZE + 1;
+        rect.xMax = rect.xMin + BLOCK_SIZE - 1;
+        rect.yMax = rect.yMin + BLOCK_SIZE - 1;
+        GLIB_drawRectFilled(&glibContext, &rect);
+      }
+  }
 }
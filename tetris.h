@@ -9,6 +9,7 @@
 #define BOARD_WIDTH   10
 #define BOARD_HEIGHT  21
 #define BLOCK_SIZE    6
+#define TETRIS_DEFAULT_SEED 0x2545F491u
 
 typedef struct {
     int x, y;
@@ -19,31 +20,85 @@ typedef struct {
     int color;
 } Tetromino;
 
+#define TETRIS_SNAPSHOT_BOARD_BYTES ((BOARD_WIDTH * BOARD_HEIGHT + 1) / 2)
+
+#define TETRIS_SNAPSHOT_ROTATED 0x01 // the last move was a rotation: a T can still score a T-spin
+
+// Compact game state taken at a piece-lock boundary, one nibble per board cell.
+// The piece sequence state is included, so a restored game deals the pieces
+// the original would have.
+typedef struct {
+    int32_t score;
+    uint32_t rng_state;
+    uint16_t lines_cleared;
+    uint8_t level;
+    uint8_t current_piece; // tetromino color, 1..7
+    uint8_t next_piece;
+    uint8_t flags;
+    uint8_t cells[TETRIS_SNAPSHOT_BOARD_BYTES];
+} tetris_snapshot_t;
+
 void tetris_init(void);
 void tetris_update(void);
 void tetris_move_left(void);
 void tetris_move_right(void);
+int tetris_shift(int dx, int max_cells);
 void tetris_move_down(void);
 void tetris_rotate(void);
 void tetris_hard_drop(void);
+uint32_t tetris_get_gravity_ms(void);
 void tetris_draw_board(void);
 
 // New state management functions
 game_state_t tetris_get_game_state(void);
 void tetris_set_game_state(game_state_t new_state);
 void tetris_start_new_game(int starting_level);
+void tetris_start_seeded_game(int starting_level, uint32_t seed);
+void tetris_set_practice(bool enabled);
+bool tetris_is_practice(void);
+bool tetris_rewind(void);
+uint32_t tetris_get_game_seed(void);
+uint32_t tetris_state_hash(void);
 void tetris_pause_game(void);
 void tetris_resume_game(void);
 void tetris_save_game(void);
 void tetris_load_from_slot(int slot_index);
+void tetris_prefetch_slot(int slot_index);
+bool tetris_get_last_load_ticks(uint32_t *ticks, bool *was_prefetched);
 void tetris_delete_slot(int slot_index);
 void tetris_get_slot_name(int slot_index, char* buffer, size_t buffer_size);
+bool tetris_get_slot_silhouette(int slot_index, uint8_t heights[BOARD_WIDTH]);
 bool tetris_has_saved_game(void);
 
+void tetris_snapshot_take(tetris_snapshot_t *snap);
+bool tetris_snapshot_restore(const tetris_snapshot_t *snap);
+void tetris_start_from_snapshot(const tetris_snapshot_t *snap);
+
 void tetris_get_high_scores(uint32_t scores[5]);
 void tetris_add_high_score(uint32_t score);
 bool tetris_is_high_score(uint32_t score);
 void tetris_process_action(void);
+void tetris_update_display(void);
 GLIB_Context_t* tetris_get_glib_context(void);
 
+// Engine kernels exposed to the benchmark suite (benchmark.c) and the
+// differential harness (host/diff_harness.c). Only
+// TETRIS_BENCH builds have them; the game never calls these.
+#ifndef TETRIS_BENCH
+#define TETRIS_BENCH 0
+#endif
+
+#if TETRIS_BENCH
+void tetris_bench_load(const uint16_t rows[BOARD_HEIGHT], int piece, int x, int y);
+bool tetris_bench_collides(int dx, int dy);
+bool tetris_bench_rotate(void);
+void tetris_bench_merge(void);
+int tetris_bench_clear_lines(bool is_t_spin);
+int tetris_bench_drop(void);
+void tetris_bench_get_piece(Tetromino *piece, Point *position);
+void tetris_bench_rewind_take(void);
+void tetris_bench_rewind_restore(void);
+void tetris_bench_draw_playfield(void);
+#endif
+
 #endif // TETRIS_H
@@ -0,0 +1,87 @@
+#include "trace.h"
+#include "em_core.h"
+#include "sl_debug_swo.h"
+#include "sl_sleeptimer.h"
+#include "memory_monitor.h"
+
+static trace_record_t ring[TRACE_RING_SIZE];
+static uint32_t head = 0;       // records ever appended; the next slot is head % TRACE_RING_SIZE
+static bool paused = false;     // set while a dump walks the ring
+
+// --- Local function prototypes ---
+static void swo_write(const void *data, size_t len, void *context);
+
+// --- Public functions ---
+
+void trace_init(void)
+{
+  memory_monitor_account("trace", sizeof(ring));
+  // sl_debug_swo_init() only enables stimulus port 0
+  sl_debug_swo_enable_itm(TRACE_SWO_CHANNEL);
+  head = 0;
+  paused = false;
+}
+
+void trace_event(trace_type_t type, uint8_t arg8, uint16_t arg16)
+{
+  uint32_t tick = sl_sleeptimer_get_tick_count();
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  if (!paused) {
+    trace_record_t *record = &ring[head & (TRACE_RING_SIZE - 1)];
+    record->tick = tick;
+    record->type = (uint8_t)type;
+    record->arg8 = arg8;
+    record->arg16 = arg16;
+    head++;
+  }
+  CORE_EXIT_ATOMIC();
+}
+
+// Events that happen during the dump are dropped rather than torn into it
+void trace_dump(trace_write_fn write, void *context)
+{
+  trace_event(TRACE_DUMP, 0, 0);
+
+  CORE_DECLARE_IRQ_STATE;
+  CORE_ENTER_ATOMIC();
+  paused = true;
+  uint32_t end = head;
+  CORE_EXIT_ATOMIC();
+
+  uint32_t count = end < TRACE_RING_SIZE ? end : TRACE_RING_SIZE;
+  trace_dump_header_t header = {
+    .magic = TRACE_DUMP_MAGIC,
+    .version = TRACE_DUMP_VERSION,
+    .record_size = sizeof(trace_record_t),
+    .tick_hz = sl_sleeptimer_get_timer_frequency(),
+    .count = count,
+    .overwritten = end - count,
+  };
+  write(&header, sizeof(header), context);
+
+  for (uint32_t i = end - count; i != end; i++) {
+    write(&ring[i & (TRACE_RING_SIZE - 1)], sizeof(trace_record_t), context);
+  }
+
+  CORE_ENTER_ATOMIC();
+  paused = false;
+  CORE_EXIT_ATOMIC();
+}
+
+void trace_dump_swo(void)
+{
+  trace_dump(swo_write, NULL);
+}
+
+// --- Internal Helper Functions ---
+
+static void swo_write(const void *data, size_t len, void *context)
+{
+  (void)context;
+  const uint8_t *bytes = data;
+  for (size_t i = 0; i < len; i++) {
+    sl_debug_swo_write_u8(TRACE_SWO_CHANNEL, bytes[i]);
+  }
+}
@@ -0,0 +1,61 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary event trace. Records are 8 bytes, timestamped with the sleeptimer
+// tick (it keeps counting in EM2, unlike the cycle counter) and appended to a
+// RAM ring that overwrites the oldest record when full. Appending is safe from
+// interrupts. A dump is a trace_dump_header_t followed by the records, oldest
+// first; host/trace_decode.c turns it into a Chrome trace / Perfetto timeline.
+//
+// Dumps go to ITM stimulus port TRACE_SWO_CHANNEL, away from the text on
+// port 0, or through any writer on the host build.
+#define TRACE_RING_SIZE      256   // records, power of two
+#define TRACE_SWO_CHANNEL    1
+#define TRACE_DUMP_MAGIC     0x31435254u // "TRC1"
+#define TRACE_DUMP_VERSION   1
+
+// Record types are part of the dump format: append new ones, never renumber
+typedef enum {
+  TRACE_STATE = 1,           // arg8: new game_state_t, arg16: previous state
+  TRACE_JOYSTICK = 2,        // arg8: joystick_input_event_type_t, arg16: position
+  TRACE_BUTTON = 3,          // arg8: button number
+  TRACE_SPAWN = 4,           // arg8: piece color
+  TRACE_LOCK = 5,            // arg8: 1 for a T-spin, arg16: lines cleared
+  TRACE_LINE_CLEAR = 6,      // arg8: lines, arg16: new level
+  TRACE_NVM3_WRITE_BEGIN = 7, // arg16: NVM3 key
+  TRACE_NVM3_WRITE_END = 8,   // arg8: 1 on error, arg16: NVM3 key
+  TRACE_NVM3_REPACK_BEGIN = 9,
+  TRACE_NVM3_REPACK_END = 10,
+  TRACE_DISPLAY_BEGIN = 11,
+  TRACE_DISPLAY_END = 12,
+  TRACE_DUMP = 13            // last record of a dump
+} trace_type_t;
+
+typedef struct {
+  uint32_t tick;
+  uint8_t type;
+  uint8_t arg8;
+  uint16_t arg16;
+} trace_record_t;
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t record_size;
+  uint32_t tick_hz;
+  uint32_t count;     // records that follow
+  uint32_t overwritten; // older records lost to the ring wrapping
+} trace_dump_header_t;
+
+typedef void (*trace_write_fn)(const void *data, size_t len, void *context);
+
+void trace_init(void);
+void trace_event(trace_type_t type, uint8_t arg8, uint16_t arg16);
+void trace_dump(trace_write_fn write, void *context);
+void trace_dump_swo(void);
+
+#endif // TRACE_H